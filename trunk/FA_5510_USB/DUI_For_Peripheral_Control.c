@@ -52,6 +52,10 @@
 //==============================================================================
 // Private typedef
 //==============================================================================
+typedef struct{
+    t_uint16 Min;
+    t_uint16 Max;
+}Limit_Range;
 //==============================================================================
 // Private define
 //==============================================================================
@@ -66,11 +70,86 @@
 //==============================================================================
 // Private Enum
 //==============================================================================
+typedef enum{
+    Job_State_Idle,
+    Job_State_Settling,
+    Job_State_Converting
+}MeasurementJobStates;
+typedef enum{
+    Seq_State_Idle,
+    Seq_State_Executing,
+    Seq_State_Waiting,
+    Seq_State_Converting
+}TestSequenceStates;
 
 //==============================================================================
 // Private variables
 //==============================================================================
-
+// ADC channel of each MeasuredFunctions in Sequence of Channels mode
+static const MeasuredADCChannels Measured_Function_ADC_Channel[] = {
+    Empty1,             //Measured_Empty
+    ADC_Chger_Vol_ch,   //Measured_24V_Chger
+    ADC_Chger_Vol_ch,   //Measured_36V_Chger
+    ADC_Chger_Vol_ch,   //Measured_48V_Chger
+    ADC_Pack_Dsg_ch,    //Measured_Pack_DSG_Vol
+    ADC_Pack_Chg_ch,    //Measured_Pack_CHG_Vol
+    ADC_CHG_ch,         //Measured_Charging_Current
+    ADC_DSG_ch          //Measured_Discharging_Current
+};
+// flash offset of mV(mA)_To_ADC_Factor of each MeasuredFunctions
+static const t_uint8 Measured_Function_Factor_Offset[] = {
+    0,                                          //Measured_Empty
+    FA_24V_mV_To_ADC_Factor_offset,             //Measured_24V_Chger
+    FA_36V_mV_To_ADC_Factor_offset,             //Measured_36V_Chger
+    FA_48V_mV_To_ADC_Factor_offset,             //Measured_48V_Chger
+    FA_Pack_DSG_mV_To_ADC_Factor_offset,        //Measured_Pack_DSG_Vol
+    FA_Pack_CHG_mV_To_ADC_Factor_offset,        //Measured_Pack_CHG_Vol
+    FA_CHG_Current_mA_To_ADC_Factor_offset,     //Measured_Charging_Current
+    FA_DSG_Current_mA_To_ADC_Factor_offset      //Measured_Discharging_Current
+};
+// 1/factor in Q16.16 of each MeasuredFunctions, real value = (ADC * multiplier) >> 16
+t_uint32 Real_Value_Multiplier_Q16[Measured_Discharging_Current + 1];
+// calibration table uploaded by cmds, written to flash only when it is activated
+Cal_Table_Record Cal_Table_Uploaded;
+t_uint8 Cal_Table_Uploaded_Points_Bits;
+// slopes of the stored tables in Q16.16, bit (1 << MeasuredFunctions) is set if the table is used
+t_int32 Cal_Table_Slope_Q16[Measured_Discharging_Current][Cal_Table_Max_Points - 1];
+t_uint8 Cal_Table_Active_Bits;
+// pass/fail limits uploaded by cmds, bit (1 << Chger_ID_Steps) is set if the limit is used
+Limit_Range Limit_Table[Measured_Discharging_Current][Chger_ID_2nd_Step + 1];
+t_uint8 Limit_Table_Set_Bits[Measured_Discharging_Current];
+// measurement job queue, the head job is done by _DUI_Measurement_Job_Process()
+MeasurementJob Measurement_Job_Queue[Measurement_Job_Queue_Size];
+t_uint8 Measurement_Job_Head;
+t_uint8 Measurement_Job_Count;
+t_uint8 Measurement_Job_State = Job_State_Idle;
+t_uint16 Measurement_Job_Step;
+t_uint16 Measurement_Job_Result[All_Measured_Result_Size + 1 + (Time_Stamp_Trailer_Size >> 1)];     //+1 word of verdict, + time stamps
+t_uint8 Measurement_Job_Fail_Bits;
+t_uint8 Measurement_Job_Checked_Bits;
+t_uint32 Measurement_Job_Start_Time_Stamp;
+t_uint32 Measurement_Job_Done_Time_Stamp;
+// exact sums of Job_Post_Statistics, at most 65535 x 0xFFFF and 65535 x 0xFFFF^2
+t_uint32 Measurement_Job_Sum;
+t_uint64 Measurement_Job_Sum_Squares;
+t_uint16 Measurement_Job_Min;
+t_uint16 Measurement_Job_Max;
+// test sequence, bytecode is executed by _DUI_Test_Sequence_Process()
+// Result = {status, pc(Lo), pc(Hi), results, fail bits(4 bytes, Lo-byte first), results x {ADC, Real Values}}
+t_uint8 Test_Sequence_Code[Test_Sequence_Max_Length];
+t_uint16 Test_Sequence_Length;
+t_uint16 Test_Sequence_PC;
+t_uint16 Test_Sequence_Executed_Ops;
+t_uint8 Test_Sequence_State = Seq_State_Idle;
+t_uint8 Test_Sequence_Abort_Flag;
+t_uint8 Test_Sequence_Measured_Function;
+t_uint8 Test_Sequence_ID_Step;                  //Chger_ID_Steps of the last Seq_Op_Charger, for limits
+t_uint8 Test_Sequence_Response_Cmd;
+t_uint16 Test_Sequence_Response_Tag;
+t_uint8 Test_Sequence_Time_Stamp;               //1: time stamp trailer after the result
+t_uint32 Test_Sequence_Start_Time_Stamp;
+t_uint32 Test_Sequence_Done_Time_Stamp;
+t_uint8 Test_Sequence_Result[Test_Sequence_Result_Max_Size + Time_Stamp_Trailer_Size];
 //==============================================================================
 // Private function prototypes
 //==============================================================================
@@ -152,6 +231,31 @@ void _DUI_Remove_Detection_Calling_Function(t_uint8 fun_index){
     _Device_Remove_TimerB_Interrupt_Timer_Calling_Function(fun_index);
 }
 
+/////////////////////////////////////////////////////////////////////
+// Charger ID settle time, one shot on Timer B instead of busy waiting
+/////////////////////////////////////////////////////////////////////
+__IO t_uint8 Charger_ID_Settling_Flag = 0;
+
+static void Charger_ID_Settle_Time_Up(void){
+    Charger_ID_Settling_Flag = 0;
+}
+
+// ms_Delay = 0 cancels the settle time
+void _DUI_Start_Charger_ID_Settle_Time(t_uint16 ms_Delay){
+    if(ms_Delay == 0){
+        _DUI_Remove_Detection_Calling_Function(Charger_ID_Settle_Fun_Index);
+        Charger_ID_Settling_Flag = 0;
+        return;
+    }
+    Charger_ID_Settling_Flag = 1;
+    //+1 period, the first period after setting is not a whole one
+    _Device_Set_TimerB_Interrupt_Timer_Calling_Function_With_Delay_And_Exec(Charger_ID_Settle_Fun_Index, Charger_ID_Settle_Time_Up,
+                                                                            ((ms_Delay + Timer_B_Polling_Base_MS - 1) / Timer_B_Polling_Base_MS) + 1);
+}
+t_uint8 _DUI_Is_Charger_ID_Settling(){
+    return Charger_ID_Settling_Flag;
+}
+
 /////////////////////////////////////////////////////////////////////
 // I/O Ports config
 /////////////////////////////////////////////////////////////////////
@@ -316,12 +420,44 @@ void _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(MeasuredADCChannels ch
     _Device_Set_Measured_RepeatedSingle_ADC_Chasnnel((MeasuredSingleADCChannels)channel);
 }
 
+// samples 8 ~ 1024 (multiple of 8) and reducer of the following conversions
+t_uint8 _DUI_Set_ADC_Oversampling_for_RepeatedSingleCh(t_uint16 samples, ADCOversampleReducers reducer){
+    return _Device_Set_RepeatedSingle_ADC_Oversampling(samples, (ADC_Oversample_Reducer)reducer);
+}
+
 void _DUI_Start_ADC_Conversion_for_RepeatedSingleCh(){
     G_Module_Function_Status |= ADC_Start_Conversion;
     G_Module_Function_Status &= ~ADC_Done_Conversion;
     _Device_Measured_RepeatedSingle_ADC_Conversion_Start();
 }
 
+// 1 : ADC keeps converting the same channel after each result, the next
+//     _DUI_Start_ADC_Conversion_for_RepeatedSingleCh() takes the result in progress
+// 0 : stop the conversions, each start converts a new result
+void _DUI_Set_ADC_Continuous_for_RepeatedSingleCh(t_uint8 enable){
+    _Device_Set_RepeatedSingle_ADC_Continuous(enable);
+}
+// blocks and results lost since continuous mode is set
+t_uint16 _DUI_Get_ADC_Overrun_Count_for_RepeatedSingleCh(){
+    return _Device_Get_RepeatedSingle_ADC_Overrun_Count();
+}
+// Timer A time stamps of the last result, ADC start and DMA done
+void _DUI_Get_ADC_Time_Stamps(t_uint32 *start_time_stamp, t_uint32 *done_time_stamp){
+    _Device_Get_ADC_Time_Stamps(start_time_stamp, done_time_stamp);
+}
+// Time_Stamp_Trailer_Size bytes, Lo-byte first
+static t_uint16 Put_Time_Stamp_Trailer(t_uint8 *buffer, t_uint32 start_time_stamp, t_uint32 done_time_stamp){
+    buffer[0] = start_time_stamp;
+    buffer[1] = start_time_stamp >> 8;
+    buffer[2] = start_time_stamp >> 16;
+    buffer[3] = start_time_stamp >> 24;
+    buffer[4] = done_time_stamp;
+    buffer[5] = done_time_stamp >> 8;
+    buffer[6] = done_time_stamp >> 16;
+    buffer[7] = done_time_stamp >> 24;
+    return Time_Stamp_Trailer_Size;
+}
+
 
 void _DUI_Set_Function_For_ADC_Conversion_Done_Calling(void (*calling_fun)()){
     _Device_Set_Interrupt_For_ADC_Conversion_Done_Calling_Function(calling_fun);
@@ -331,14 +467,106 @@ void _DUI_Remove_ADC_Conversion_Done_Function(){
 }
 
 
+t_uint8 _DUI_ADC_Stream_Start(MeasuredADCChannels channel, t_uint8 sequence, t_uint16 sample_rate){
+    if(_Device_ADC_Stream_Start((t_uint8)channel, sequence, sample_rate) == Func_Failure){
+        return Func_Failure;
+    }
+    G_Module_Function_Status &= ~ADC_Start_Conversion;
+    G_Module_Function_Status &= ~ADC_Done_Conversion;
+    G_1st_Module_Function_Status |= ADC_Stream_Processing;
+    return Func_Success;
+}
+void _DUI_ADC_Stream_Stop(){
+    _Device_ADC_Stream_Stop();
+    G_1st_Module_Function_Status &= ~ADC_Stream_Processing;
+    //back to measurement mode, ADC and DMA are set again
+    _DUI_ADC_Function_Init_for_RepeatedSingleCh();
+}
+t_uint8 _DUI_ADC_Stream_Is_Block_Ready(){
+    return _Device_ADC_Stream_Is_Block_Ready();
+}
+t_uint16* _DUI_ADC_Stream_Get_Ready_Block(t_uint32 *block_number){
+    return _Device_ADC_Stream_Get_Ready_Block(block_number);
+}
+t_uint8 _DUI_ADC_Stream_Release_Block(t_uint32 block_number){
+    return _Device_ADC_Stream_Release_Block(block_number);
+}
+t_uint16 _DUI_ADC_Stream_Get_Dropped_Blocks(){
+    return _Device_ADC_Stream_Get_Dropped_Blocks();
+}
+
+t_uint8 _DUI_ADC_Watch_Start(MeasuredADCChannels channel, t_uint16 sample_rate, t_uint16 low_threshold, t_uint16 high_threshold){
+    if(_Device_ADC_Watch_Start((t_uint8)channel, sample_rate, low_threshold, high_threshold) == Func_Failure){
+        return Func_Failure;
+    }
+    G_Module_Function_Status &= ~ADC_Start_Conversion;
+    G_Module_Function_Status &= ~ADC_Done_Conversion;
+    G_1st_Module_Function_Status |= ADC_Watch_Processing;
+    return Func_Success;
+}
+void _DUI_ADC_Watch_Stop(){
+    _Device_ADC_Watch_Stop();
+    G_1st_Module_Function_Status &= ~ADC_Watch_Processing;
+    //back to measurement mode, ADC and DMA are set again
+    _DUI_ADC_Function_Init_for_RepeatedSingleCh();
+}
+t_uint8 _DUI_ADC_Watch_Is_Event_Ready(){
+    return _Device_ADC_Watch_Is_Event_Ready();
+}
+// return Func_Failure if there is no event, state 1:below, 2:inside, 3:above the window
+t_uint8 _DUI_ADC_Watch_Get_Event(t_uint32 *sample_number, t_uint32 *time_stamp, t_uint16 *adc, t_uint8 *state){
+    ADC_Watch_Event event;
+    if(_Device_ADC_Watch_Get_Event(&event) == Func_Failure){
+        return Func_Failure;
+    }
+    *sample_number = event.Sample_Number;
+    *time_stamp = event.Time_Stamp;
+    *adc = event.ADC;
+    *state = event.State;
+    return Func_Success;
+}
+t_uint16 _DUI_ADC_Watch_Get_Lost_Events(){
+    return _Device_ADC_Watch_Get_Lost_Events();
+}
+
+
 t_uint16 _DUI_Get_Raw_ADC_SingleChannle_Result(){
     return _Device_Get_RepeatedSingle_ADC_Result();
 }
+// 12 bits with Oversample_Decimate, otherwise same as _DUI_Get_Raw_ADC_SingleChannle_Result()
+t_uint16 _DUI_Get_Reduced_ADC_SingleChannle_Result(){
+    return _Device_Get_RepeatedSingle_ADC_Reduced_Result();
+}
 
 t_uint16 _DUI_Get_Calibrated_ADC_SingleChannle_Result(MeasuredFunctions mf){
+    return _DUI_Get_Calibrated_ADC_By_Raw_ADC(mf, _DUI_Get_Raw_ADC_SingleChannle_Result());
+}
+
+t_uint16 _DUI_Get_Calibrated_ADC_Sequence_Result(MeasuredFunctions mf){
+    return _DUI_Get_Calibrated_ADC_By_Raw_ADC(mf, _Device_Get_Sequence_ADC_Result(Measured_Function_ADC_Channel[mf]));
+}
+
+// result[] = {ADC, Real Values} of Measured_24V_Chger ~ Measured_Discharging_Current,
+// all from one Sequence of Channels conversion, size is All_Measured_Result_Size
+MeasuredADCChannels _DUI_Get_Measured_Function_ADC_Channel(MeasuredFunctions mf){
+    if(mf > Measured_Discharging_Current){
+        return Empty1;
+    }
+    return Measured_Function_ADC_Channel[mf];
+}
+void _DUI_Get_All_Measured_Result_For_SequenceSampling(t_uint16 *result){
+    t_uint8 mf;
+    for(mf = Measured_24V_Chger; mf <= Measured_Discharging_Current; mf++){
+        *result = _DUI_Get_Calibrated_ADC_Sequence_Result((MeasuredFunctions)mf);
+        *(result + 1) = _DUI_Get_RealMeasuredDate_By_ADC((MeasuredFunctions)mf, *result);
+        result += 2;
+    }
+}
+
+t_uint16 _DUI_Get_Calibrated_ADC_By_Raw_ADC(MeasuredFunctions mf, t_uint16 RawAdc){
     t_int16 temp;
     t_int8 temp_c;
-    temp = _DUI_Get_Raw_ADC_SingleChannle_Result();
+    temp = (t_int16)RawAdc;
     switch(mf){
         case Measured_24V_Chger:
             temp_c = FA_24V_CAL_OFFSET_ADC;
@@ -377,48 +605,949 @@ t_uint16 _DUI_Get_Calibrated_ADC_SingleChannle_Result(MeasuredFunctions mf){
     }
     return temp;
 }
+// (Adc * multiplier + 0.5) with Q16.16 multiplier, by two 16x16 bits products of MPY32
+static t_uint16 Multiply_Q16_Round(t_uint16 Adc, t_uint32 multiplier){
+    t_uint32 result;
+
+    result = (t_uint32)Adc * (t_uint16)(multiplier >> 16);
+    result += (((t_uint32)Adc * (t_uint16)multiplier) + 0x8000) >> 16;    //round off |ˤJ
+    if(result > 0xFFFF){
+        result = 0xFFFF;
+    }
+    return (t_uint16)result;
+}
+/////////////////////////////////////////////////////////////////////
+// piecewise linear calibration tables, ADC (after offset) to real value
+// 3 records in each of Cal_Table_Segment_1st ~ 3rd, for Measured_24V_Chger ~ Measured_Discharging_Current
+/////////////////////////////////////////////////////////////////////
+static unsigned long Get_Cal_Table_Segment(MeasuredFunctions mf){
+    if(mf <= Measured_48V_Chger){
+        return Cal_Table_Segment_1st;
+    }else if(mf <= Measured_Charging_Current){
+        return Cal_Table_Segment_2nd;
+    }
+    return Cal_Table_Segment_3rd;
+}
+static t_uint16 Get_Cal_Table_Offset(MeasuredFunctions mf){
+    return ((mf - Measured_24V_Chger) % 3) * Cal_Table_Record_Size;
+}
+static const Cal_Table_Record* Get_Stored_Cal_Table(MeasuredFunctions mf){
+    return (const Cal_Table_Record *)(Get_Cal_Table_Segment(mf) + Get_Cal_Table_Offset(mf));
+}
+// points are 2 ~ Cal_Table_Max_Points, ADC is increasing and |slope| < 32768
+static t_uint8 Check_Cal_Table_Points(const Cal_Table_Record *table){
+    t_uint8 i;
+    t_uint16 dx;
+    t_uint16 dy;
+
+    if((table->Points < 2) || (table->Points > Cal_Table_Max_Points)){
+        return Func_Failure;
+    }
+    for(i = 0; i < (table->Points - 1); i++){
+        if(table->Point[i + 1].ADC <= table->Point[i].ADC){
+            return Func_Failure;
+        }
+        dx = table->Point[i + 1].ADC - table->Point[i].ADC;
+        if(table->Point[i + 1].Value >= table->Point[i].Value){
+            dy = table->Point[i + 1].Value - table->Point[i].Value;
+        }else{
+            dy = table->Point[i].Value - table->Point[i + 1].Value;
+        }
+        if((dy / dx) >= 32768){
+            return Func_Failure;
+        }
+    }
+    return Func_Success;
+}
+// check CRC and points of the stored table, then precompute the slope of each segment
+static void Load_Cal_Table(MeasuredFunctions mf){
+    const Cal_Table_Record *table;
+    t_uint8 i;
+    t_uint16 dx;
+    t_uint16 dy;
+    t_uint32 slope;
+
+    Cal_Table_Active_Bits &= ~(1 << mf);
+    table = Get_Stored_Cal_Table(mf);
+    if((table->MeasuredFunction != mf) || (Check_Cal_Table_Points(table) != Func_Success)){
+        return;
+    }
+    //records written by older firmware have ModBus CRC16, they are still used
+    if((usCRC16CCITT((unsigned char *)table, Cal_Table_Record_Size - 2) != table->CRC) &&
+       (usMBCRC16((unsigned char *)table, Cal_Table_Record_Size - 2) != table->CRC)){
+        return;
+    }
+    for(i = 0; i < (table->Points - 1); i++){
+        dx = table->Point[i + 1].ADC - table->Point[i].ADC;
+        if(table->Point[i + 1].Value >= table->Point[i].Value){
+            dy = table->Point[i + 1].Value - table->Point[i].Value;
+        }else{
+            dy = table->Point[i].Value - table->Point[i + 1].Value;
+        }
+        //dy * 65536 / dx without 64 bits division, (dy % dx) * 65536 < 2^32
+        slope = ((t_uint32)(dy / dx) << 16) + ((((t_uint32)(dy % dx) << 16) + (dx >> 1)) / dx);
+        if(table->Point[i + 1].Value >= table->Point[i].Value){
+            Cal_Table_Slope_Q16[mf - 1][i] = (t_int32)slope;
+        }else{
+            Cal_Table_Slope_Q16[mf - 1][i] = -(t_int32)slope;
+        }
+    }
+    Cal_Table_Active_Bits |= (1 << mf);
+}
+// the first and the last segments are extended beyond the table
+static t_uint16 Get_Value_By_Cal_Table(MeasuredFunctions mf, t_uint16 Adc){
+    const Cal_Table_Record *table;
+    t_int32 slope;
+    t_uint8 i;
+    t_uint8 negative;
+    t_uint16 dx;
+    t_uint16 dy;
+
+    table = Get_Stored_Cal_Table(mf);
+    i = 0;
+    while((i < (table->Points - 2)) && (Adc >= table->Point[i + 1].ADC)){
+        i++;
+    }
+    if(Adc >= table->Point[i].ADC){
+        dx = Adc - table->Point[i].ADC;
+        negative = 0;
+    }else{
+        dx = table->Point[i].ADC - Adc;
+        negative = 1;
+    }
+    slope = Cal_Table_Slope_Q16[mf - 1][i];
+    if(slope < 0){
+        dy = Multiply_Q16_Round(dx, (t_uint32)(-slope));
+        negative ^= 1;
+    }else{
+        dy = Multiply_Q16_Round(dx, (t_uint32)slope);
+    }
+    if(negative){
+        if(dy >= table->Point[i].Value){
+            return 0;
+        }
+        return table->Point[i].Value - dy;
+    }
+    if(dy >= (0xFFFF - table->Point[i].Value)){
+        return 0xFFFF;
+    }
+    return table->Point[i].Value + dy;
+}
+// a table can be uploaded by several cmds, index is the first point in data
+// data : count x {ADC(Lo-byte), ADC(Hi-byte), Value(Lo-byte), Value(Hi-byte)}
+t_uint8 _DUI_Cal_Table_Upload(MeasuredFunctions mf, t_uint8 points, t_uint8 index, t_uint8 count, t_uint8 *data){
+    t_uint8 i;
+
+    if((mf < Measured_24V_Chger) || (mf > Measured_Discharging_Current) ||
+       (points < 2) || (points > Cal_Table_Max_Points) || ((index + count) > points)){
+        return Func_Failure;
+    }
+    if(index == 0){
+        //start a new table, unused points are kept as erased flash
+        Cal_Table_Uploaded.MeasuredFunction = mf;
+        Cal_Table_Uploaded.Points = points;
+        for(i = 0; i < Cal_Table_Max_Points; i++){
+            Cal_Table_Uploaded.Point[i].ADC = 0xFFFF;
+            Cal_Table_Uploaded.Point[i].Value = 0xFFFF;
+        }
+        Cal_Table_Uploaded_Points_Bits = 0;
+    }else if((Cal_Table_Uploaded.MeasuredFunction != mf) || (Cal_Table_Uploaded.Points != points)){
+        return Func_Failure;
+    }
+    for(i = index; i < (index + count); i++){
+        Cal_Table_Uploaded.Point[i].ADC = data[1];
+        Cal_Table_Uploaded.Point[i].ADC = (Cal_Table_Uploaded.Point[i].ADC << 8) + data[0];
+        Cal_Table_Uploaded.Point[i].Value = data[3];
+        Cal_Table_Uploaded.Point[i].Value = (Cal_Table_Uploaded.Point[i].Value << 8) + data[2];
+        Cal_Table_Uploaded_Points_Bits |= (1 << i);
+        data += 4;
+    }
+    Cal_Table_Uploaded.CRC = usCRC16CCITT((unsigned char *)&Cal_Table_Uploaded, Cal_Table_Record_Size - 2);
+    return Func_Success;
+}
+// activate = 1 : write the whole uploaded table to flash and use it
+// activate = 0 : back to offset and mV(mA)_To_ADC_Factor
+// the table in use is only changed after the record in flash is written and checked
+t_uint8 _DUI_Cal_Table_Activate(MeasuredFunctions mf, t_uint8 activate){
+    t_uint8 erased[2];
+
+    if((mf < Measured_24V_Chger) || (mf > Measured_Discharging_Current)){
+        return Func_Failure;
+    }
+    if(activate){
+        if((Cal_Table_Uploaded.MeasuredFunction != mf) ||
+           (Cal_Table_Uploaded_Points_Bits != (t_uint8)((1 << Cal_Table_Uploaded.Points) - 1)) ||
+           (Check_Cal_Table_Points(&Cal_Table_Uploaded) != Func_Success)){
+            return Func_Failure;
+        }
+        WriteDataToInfoSegment(Get_Cal_Table_Segment(mf), Get_Cal_Table_Offset(mf), (t_uint8 *)&Cal_Table_Uploaded, Cal_Table_Record_Size);
+    }else{
+        //MeasuredFunction and Points as erased flash, the CRC does not match any more
+        erased[0] = 0xFF;
+        erased[1] = 0xFF;
+        WriteDataToInfoSegment(Get_Cal_Table_Segment(mf), Get_Cal_Table_Offset(mf), erased, 2);
+    }
+    Load_Cal_Table(mf);
+    if(_DUI_Cal_Table_Is_Active(mf) != activate){
+        return Func_Failure;
+    }
+    return Func_Success;
+}
+// stored = 0 : the uploaded table, stored = 1 : the record in flash
+const Cal_Table_Record* _DUI_Cal_Table_Get(MeasuredFunctions mf, t_uint8 stored){
+    if(stored){
+        return Get_Stored_Cal_Table(mf);
+    }
+    return &Cal_Table_Uploaded;
+}
+t_uint8 _DUI_Cal_Table_Is_Active(MeasuredFunctions mf){
+    if(Cal_Table_Active_Bits & (1 << mf)){
+        return 1;
+    }
+    return 0;
+}
+t_uint8 _DUI_Cal_Table_Is_Uploaded(){
+    if((Cal_Table_Uploaded_Points_Bits != 0) &&
+       (Cal_Table_Uploaded_Points_Bits == (t_uint8)((1 << Cal_Table_Uploaded.Points) - 1))){
+        return 1;
+    }
+    return 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+// 1/mV(mA)_To_ADC_Factor of flash in Q16.16 and calibration tables,
+// only done at boot and after calibration data are written
+void _DUI_Update_Real_Value_Multipliers(){
+    t_uint8 mf;
+    float factor;
+
+    Real_Value_Multiplier_Q16[Measured_Empty] = 0;
+    for(mf = Measured_24V_Chger; mf <= Measured_Discharging_Current; mf++){
+        factor = *((float *)(Config_Segment + Measured_Function_Factor_Offset[mf]));
+        //erased flash (NaN) or a factor out of range gives 0
+        if((factor >= 0.0001f) && (factor <= 1000.0f)){
+            Real_Value_Multiplier_Q16[mf] = (t_uint32)((65536.0f / factor) + 0.5f);
+        }else{
+            Real_Value_Multiplier_Q16[mf] = 0;
+        }
+        Load_Cal_Table((MeasuredFunctions)mf);
+    }
+}
 t_uint16 _DUI_Get_RealMeasuredDate_By_ADC(MeasuredFunctions mf, t_uint16 Adc){
-    float temp_float;
+    if(mf > Measured_Discharging_Current){
+        return 0;
+    }
+    if(Cal_Table_Active_Bits & (1 << mf)){
+        return Get_Value_By_Cal_Table(mf, Adc);
+    }
+    return Multiply_Q16_Round(Adc, Real_Value_Multiplier_Q16[mf]);
+}
 
-    switch(mf){
-        case Measured_24V_Chger:
-            //24V
-            temp_float = FA_24V_mV_To_ADC_Factor;
-            temp_float = (Adc/temp_float) + 0.5f; //round off |ˤJ
+/////////////////////////////////////////////////////////////////////
+// Pass/fail limits
+// the limit of Chger_ID_OFF is used by all ID steps if the step has no own limit
+/////////////////////////////////////////////////////////////////////
+t_uint8 _DUI_Limit_Table_Set(MeasuredFunctions mf, Chger_ID_Steps idStep, t_uint16 min, t_uint16 max){
+    if((mf < Measured_24V_Chger) || (mf > Measured_Discharging_Current) || (idStep > Chger_ID_2nd_Step) || (min > max)){
+        return Func_Failure;
+    }
+    if((idStep != Chger_ID_OFF) && (mf > Measured_48V_Chger)){
+        return Func_Failure;
+    }
+    Limit_Table[mf - 1][idStep].Min = min;
+    Limit_Table[mf - 1][idStep].Max = max;
+    Limit_Table_Set_Bits[mf - 1] |= (1 << idStep);
+    return Func_Success;
+}
+// mf = Measured_Empty clears all
+void _DUI_Limit_Table_Clear(MeasuredFunctions mf){
+    t_uint8 i;
+    for(i = Measured_24V_Chger; i <= Measured_Discharging_Current; i++){
+        if((mf == Measured_Empty) || (mf == i)){
+            Limit_Table_Set_Bits[i - 1] = 0;
+        }
+    }
+}
+// return Func_Failure if the step has no own limit
+t_uint8 _DUI_Limit_Table_Get(MeasuredFunctions mf, Chger_ID_Steps idStep, t_uint16 *min, t_uint16 *max){
+    if((mf < Measured_24V_Chger) || (mf > Measured_Discharging_Current) || (idStep > Chger_ID_2nd_Step) ||
+       ((Limit_Table_Set_Bits[mf - 1] & (1 << idStep)) == 0)){
+        return Func_Failure;
+    }
+    *min = Limit_Table[mf - 1][idStep].Min;
+    *max = Limit_Table[mf - 1][idStep].Max;
+    return Func_Success;
+}
+LimitVerdicts _DUI_Limit_Check(MeasuredFunctions mf, Chger_ID_Steps idStep, t_uint16 value){
+    const Limit_Range *limit;
+
+    if((mf < Measured_24V_Chger) || (mf > Measured_Discharging_Current) || (idStep > Chger_ID_2nd_Step)){
+        return Limit_Not_Set;
+    }
+    if((Limit_Table_Set_Bits[mf - 1] & (1 << idStep)) == 0){
+        idStep = Chger_ID_OFF;
+        if((Limit_Table_Set_Bits[mf - 1] & (1 << idStep)) == 0){
+            return Limit_Not_Set;
+        }
+    }
+    limit = &Limit_Table[mf - 1][idStep];
+    if((value < limit->Min) || (value > limit->Max)){
+        return Limit_Fail;
+    }
+    return Limit_Pass;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Measurement job queue
+// jobs are done in order by _DUI_Measurement_Job_Process() of main(), one
+// step on each call, and each result is sent by its Response_Cmd when done.
+// cmds are still serviced while a job is settling or converting.
+/////////////////////////////////////////////////////////////////////
+static void Set_Measurement_Job_Gate(const MeasurementJob *job, t_uint8 step){
+    switch(job->Gate){
+        case Job_Gate_Pack_DSG:
+            _DUI_SetPackDSGInputPortForMeasurement(Turn_On);
             break;
-        case Measured_36V_Chger:
-            //36V
-            temp_float = FA_36V_mV_To_ADC_Factor;
-            temp_float = (Adc/temp_float) + 0.5f; //round off |ˤJ
+        case Job_Gate_Pack_CHG:
+            _DUI_SetPackCHGInputPortForMeasurement(Turn_On);
             break;
-        case Measured_48V_Chger:
-            //48V
-            temp_float = FA_48V_mV_To_ADC_Factor;
-            temp_float = (Adc/temp_float) + 0.5f; //round off |ˤJ
+        case Job_Gate_Charger_24V:
+        case Job_Gate_Charger_36V:
+        case Job_Gate_Charger_48V:
+            _DUI_SwitchChargerInputAndIDStep((Switch_Channnel)(job->Gate - Job_Gate_Charger_24V + Switch_To_24V_Ch), (Chger_ID_Steps)step);
             break;
-        case Measured_Pack_DSG_Vol:
-            //Pack_DSG
-            temp_float = FA_Pack_DSG_mV_To_ADC_Factor;
-            temp_float = (Adc/temp_float) + 0.5f; //round off |ˤJ
+        default:
             break;
-        case Measured_Pack_CHG_Vol:
-            //Pack_CHG
-            temp_float = FA_Pack_CHG_mV_To_ADC_Factor;
-            temp_float = (Adc/temp_float) + 0.5f; //round off |ˤJ
+    }
+}
+static void Release_Measurement_Job_Gate(const MeasurementJob *job){
+    switch(job->Gate){
+        case Job_Gate_Pack_DSG:
+            _DUI_SetPackDSGInputPortForMeasurement(Turn_Off);
             break;
-        case Measured_Charging_Current:
-            temp_float = FA_CHG_Current_mA_To_ADC_Factor;
-            temp_float = (Adc/temp_float) + 0.5f; //round off |ˤJ
+        case Job_Gate_Pack_CHG:
+            _DUI_SetPackCHGInputPortForMeasurement(Turn_Off);
             break;
-        case Measured_Discharging_Current:
-            temp_float = FA_DSG_Current_mA_To_ADC_Factor;
-            temp_float = (Adc/temp_float) + 0.5f; //round off |ˤJ
+        case Job_Gate_Charger_24V:
+        case Job_Gate_Charger_36V:
+        case Job_Gate_Charger_48V:
+            _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
+            break;
+        default:
+            break;
+    }
+}
+static void Start_Measurement_Job_Conversion(const MeasurementJob *job){
+    if(job->Post == Job_Post_All_Sequence){
+        _DUI_Start_ADC_Conversion_for_SequenceSampling();
+    }else{
+        _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
+    }
+}
+static void Check_Measurement_Job_Limit(MeasuredFunctions mf, Chger_ID_Steps idStep, t_uint16 value, t_uint8 bit){
+    switch(_DUI_Limit_Check(mf, idStep, value)){
+        case Limit_Fail:
+            Measurement_Job_Fail_Bits |= bit;
+            Measurement_Job_Checked_Bits |= bit;
+            break;
+        case Limit_Pass:
+            Measurement_Job_Checked_Bits |= bit;
             break;
         default:
-            temp_float = 0.0f;
             break;
     }
-    return (unsigned int)temp_float;
+}
+// the value is added as the (step + 1)-th sample, one 16x16 bits product of MPY32, no division
+static void Update_Measurement_Job_Statistics(t_uint16 value, t_uint16 step){
+    if(step == 0){
+        Measurement_Job_Sum = 0;
+        Measurement_Job_Sum_Squares = 0;
+        Measurement_Job_Min = value;
+        Measurement_Job_Max = value;
+    }
+    if(value < Measurement_Job_Min){
+        Measurement_Job_Min = value;
+    }
+    if(value > Measurement_Job_Max){
+        Measurement_Job_Max = value;
+    }
+    Measurement_Job_Sum += value;
+    Measurement_Job_Sum_Squares += (t_uint32)value * value;
+}
+// mean in Q16.16 and sample variance in Q32.16 of count samples, by the divisions of the last step only
+// n x sum of squares - sum^2 is exact in 64 bits, the variance of 16 bits values is below 2^31 and never saturates
+static void Finish_Measurement_Job_Statistics(t_uint16 count){
+    t_uint64 numerator;
+    t_uint32 denominator;
+    t_uint32 mean;
+    t_uint32 variance;
+    t_uint16 fraction;
+
+    mean = (t_uint32)((((t_uint64)Measurement_Job_Sum) << 16) / count);
+    variance = 0;
+    fraction = 0;
+    if(count > 1){
+        numerator = (t_uint64)count * Measurement_Job_Sum_Squares - (t_uint64)Measurement_Job_Sum * Measurement_Job_Sum;
+        denominator = (t_uint32)count * (count - 1);
+        variance = (t_uint32)(numerator / denominator);
+        fraction = (t_uint16)((((t_uint64)(numerator % denominator)) << 16) / denominator);
+    }
+    Measurement_Job_Result[0] = count;
+    Measurement_Job_Result[1] = Measurement_Job_Min;
+    Measurement_Job_Result[2] = Measurement_Job_Max;
+    Measurement_Job_Result[3] = (t_uint16)mean;
+    Measurement_Job_Result[4] = (t_uint16)(mean >> 16);
+    Measurement_Job_Result[5] = fraction;
+    Measurement_Job_Result[6] = (t_uint16)variance;
+    Measurement_Job_Result[7] = (t_uint16)(variance >> 16);
+    Measurement_Job_Result[8] = _DUI_Get_ADC_Overrun_Count_for_RepeatedSingleCh();
+}
+static void Save_Measurement_Job_Result(const MeasurementJob *job, t_uint16 step){
+    t_uint8 mf;
+    t_uint16 value;
+    switch(job->Post){
+        case Job_Post_Raw_ADC:
+            Measurement_Job_Result[0] = _DUI_Get_Reduced_ADC_SingleChannle_Result();
+            break;
+        case Job_Post_Calibrated:
+            Measurement_Job_Result[step * 2] = _DUI_Get_Calibrated_ADC_SingleChannle_Result((MeasuredFunctions)job->Measured_Function);
+            Measurement_Job_Result[step * 2 + 1] = _DUI_Get_RealMeasuredDate_By_ADC((MeasuredFunctions)job->Measured_Function, Measurement_Job_Result[step * 2]);
+            //step is the charger ID step of charger jobs, others have one step only
+            Check_Measurement_Job_Limit((MeasuredFunctions)job->Measured_Function, (Chger_ID_Steps)step, Measurement_Job_Result[step * 2 + 1], 1 << step);
+            break;
+        case Job_Post_Statistics:
+            if(job->Measured_Function == Measured_Empty){
+                value = _DUI_Get_Reduced_ADC_SingleChannle_Result();
+            }else{
+                value = _DUI_Get_RealMeasuredDate_By_ADC((MeasuredFunctions)job->Measured_Function,
+                                                         _DUI_Get_Calibrated_ADC_SingleChannle_Result((MeasuredFunctions)job->Measured_Function));
+            }
+            Update_Measurement_Job_Statistics(value, step);
+            if((step + 1) == job->Steps){
+                Finish_Measurement_Job_Statistics(job->Steps);
+            }
+            break;
+        default:
+            _DUI_Get_All_Measured_Result_For_SequenceSampling(Measurement_Job_Result);
+            for(mf = Measured_24V_Chger; mf <= Measured_Discharging_Current; mf++){
+                Check_Measurement_Job_Limit((MeasuredFunctions)mf, Chger_ID_OFF, Measurement_Job_Result[(mf - 1) * 2 + 1], 1 << (mf - 1));
+            }
+            break;
+    }
+}
+static t_uint16 Get_Measurement_Job_Result_Length(const MeasurementJob *job){
+    switch(job->Post){
+        case Job_Post_Raw_ADC:
+            return 2;
+        case Job_Post_Calibrated:
+            return job->Steps * 4;
+        case Job_Post_Statistics:
+            return Measurement_Job_Statistics_Size;
+        default:
+            return All_Measured_Result_Size * 2;
+    }
+}
+static void Send_Measurement_Job_Result(const MeasurementJob *job){
+    t_uint16 length;
+    t_uint8 *result;
+    t_uint8 *verdict;
+
+    length = Get_Measurement_Job_Result_Length(job);
+    result = (t_uint8 *)Measurement_Job_Result;
+    verdict = &result[length];
+    verdict[0] = Measurement_Job_Fail_Bits;
+    verdict[1] = Measurement_Job_Checked_Bits;
+    switch(job->Verdict){
+        case Job_Verdict_Append:
+            length += 2;
+            break;
+        case Job_Verdict_Only:
+            result = verdict;
+            length = 2;
+            break;
+        default:
+            break;
+    }
+    if(job->Time_Stamp){
+        length += Put_Time_Stamp_Trailer(&result[length], Measurement_Job_Start_Time_Stamp, Measurement_Job_Done_Time_Stamp);
+    }
+    _DUI_CDC_Transmitting_Async_Response(job->Response_Cmd, job->Response_Tag, result, length);
+}
+
+// return Func_Failure if queue is full, ADC is streaming or watching, test sequence is running or job is not valid
+t_uint8 _DUI_Measurement_Job_Enqueue(const MeasurementJob *job){
+    if((Measurement_Job_Count >= Measurement_Job_Queue_Size) || (G_1st_Module_Function_Status & (ADC_Stream_Processing + ADC_Watch_Processing)) ||
+       _DUI_Test_Sequence_Is_Running()){
+        return Func_Failure;
+    }
+    if((job->Gate > Job_Gate_Charger_48V) || (job->ADC_Channel > Empty3) || (job->Post > Job_Post_Statistics)){
+        return Func_Failure;
+    }
+    if(job->Post == Job_Post_Statistics){
+        //any number of conversions without gate
+        if((job->Steps == 0) || (job->Gate != Job_Gate_None) || (job->Measured_Function > Measured_Discharging_Current)){
+            return Func_Failure;
+        }
+    }else if((job->Steps == 0) || (job->Steps > ((job->Gate >= Job_Gate_Charger_24V) ? (Chger_ID_2nd_Step + 1) : 1)) ||
+       ((job->Post != Job_Post_Calibrated) && (job->Steps != 1)) ||
+       ((job->Post == Job_Post_Calibrated) && ((job->Measured_Function < Measured_24V_Chger) || (job->Measured_Function > Measured_Discharging_Current)))){
+        return Func_Failure;
+    }
+    if((job->Samples < ADC_Oversample_Min_Samples) || (job->Samples > ADC_Oversample_Max_Samples) ||
+       (job->Samples % ADC_Oversample_Block_Samples) || (job->Reducer > Oversample_Decimate)){
+        return Func_Failure;
+    }
+    if((job->Verdict > Job_Verdict_Only) || (job->Time_Stamp > 1) ||
+       (((job->Post == Job_Post_Raw_ADC) || (job->Post == Job_Post_Statistics)) && (job->Verdict != Job_Verdict_None))){
+        return Func_Failure;
+    }
+    Measurement_Job_Queue[(Measurement_Job_Head + Measurement_Job_Count) % Measurement_Job_Queue_Size] = *job;
+    Measurement_Job_Queue[(Measurement_Job_Head + Measurement_Job_Count) % Measurement_Job_Queue_Size].Response_Tag = _DUI_CDC_Get_Response_Tag();
+    Measurement_Job_Count++;
+    return Func_Success;
+}
+
+void _DUI_Measurement_Job_Process(){
+    const MeasurementJob *job;
+    t_uint32 start_time_stamp;
+
+    if(Measurement_Job_Count == 0){
+        return;
+    }
+    job = &Measurement_Job_Queue[Measurement_Job_Head];
+    switch(Measurement_Job_State){
+        case Job_State_Idle:
+            //setup of the job
+            Measurement_Job_Step = 0;
+            Measurement_Job_Fail_Bits = 0;
+            Measurement_Job_Checked_Bits = 0;
+            if(job->Post != Job_Post_All_Sequence){
+                _DUI_Set_ADC_Oversampling_for_RepeatedSingleCh(job->Samples, (ADCOversampleReducers)job->Reducer);
+                _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh((MeasuredADCChannels)job->ADC_Channel);
+                //statistics converts one channel without gates, next conversion overlaps the result handling
+                _DUI_Set_ADC_Continuous_for_RepeatedSingleCh(job->Post == Job_Post_Statistics);
+            }
+            Set_Measurement_Job_Gate(job, 0);
+            Start_Measurement_Job_Conversion(job);
+            Measurement_Job_State = Job_State_Converting;
+            break;
+        case Job_State_Settling:
+            if(_DUI_Is_Charger_ID_Settling()){
+                break;
+            }
+            Start_Measurement_Job_Conversion(job);
+            Measurement_Job_State = Job_State_Converting;
+            break;
+        case Job_State_Converting:
+            if((G_Module_Function_Status & ADC_Done_Conversion) == 0){
+                break;
+            }
+            G_Module_Function_Status &= ~ADC_Done_Conversion;
+            G_Module_Function_Status &= ~ADC_Start_Conversion;
+            _DUI_Get_ADC_Time_Stamps(&start_time_stamp, &Measurement_Job_Done_Time_Stamp);
+            if(Measurement_Job_Step == 0){
+                Measurement_Job_Start_Time_Stamp = start_time_stamp;
+            }
+            Save_Measurement_Job_Result(job, Measurement_Job_Step);
+            Measurement_Job_Step++;
+            if(Measurement_Job_Step < job->Steps){
+                //next step after the settle time
+                Set_Measurement_Job_Gate(job, Measurement_Job_Step);
+                _DUI_Start_Charger_ID_Settle_Time(job->Settle_ms);
+                Measurement_Job_State = Job_State_Settling;
+                break;
+            }
+            Release_Measurement_Job_Gate(job);
+            if(job->Post == Job_Post_Statistics){
+                _DUI_Set_ADC_Continuous_for_RepeatedSingleCh(0);
+            }
+            //send data out via usb
+            Send_Measurement_Job_Result(job);
+            Measurement_Job_Head = (Measurement_Job_Head + 1) % Measurement_Job_Queue_Size;
+            Measurement_Job_Count--;
+            Measurement_Job_State = Job_State_Idle;
+            break;
+        default:
+            Measurement_Job_State = Job_State_Idle;
+            break;
+    }
+}
+// 1 if _DUI_Measurement_Job_Process() has something to do, main() does not sleep
+t_uint8 _DUI_Measurement_Job_Is_Ready(){
+    if(Measurement_Job_Count == 0){
+        return 0;
+    }
+    switch(Measurement_Job_State){
+        case Job_State_Settling:
+            return (_DUI_Is_Charger_ID_Settling() == 0);
+        case Job_State_Converting:
+            return ((G_Module_Function_Status & ADC_Done_Conversion) != 0);
+        default:
+            return 1;
+    }
+}
+t_uint8 _DUI_Measurement_Job_Is_Busy(){
+    return (Measurement_Job_Count != 0);
+}
+// charger input and ID are switched by queued jobs
+t_uint8 _DUI_Measurement_Job_Is_Using_Charger(){
+    t_uint8 i;
+    for(i = 0; i < Measurement_Job_Count; i++){
+        if(Measurement_Job_Queue[(Measurement_Job_Head + i) % Measurement_Job_Queue_Size].Gate >= Job_Gate_Charger_24V){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Test sequence
+// a recipe of gate, mux, wait and measure steps is uploaded as bytecode
+// once and executed by _DUI_Test_Sequence_Process() of main(). Ops are
+// executed until a wait or a measurement, cmds are still serviced while
+// waiting or converting. The result is sent by response_cmd of
+// _DUI_Test_Sequence_Run() when the sequence stops.
+// measurement jobs and the sequence exclude each other, so the charger ID
+// settle time of Timer B is used by Seq_Op_Wait.
+/////////////////////////////////////////////////////////////////////
+static const t_uint8 Test_Sequence_Op_Size[] = {
+    1,      //Seq_Op_End
+    3,      //Seq_Op_Gate
+    3,      //Seq_Op_Charger
+    2,      //Seq_Op_Comm_Mux
+    3,      //Seq_Op_Wait
+    6,      //Seq_Op_Measure
+    7,      //Seq_Op_Branch_Outside
+    3       //Seq_Op_Jump
+};
+static t_uint16 Get_Test_Sequence_Word(t_uint16 offset){
+    t_uint16 word;
+    word = Test_Sequence_Code[offset + 1];
+    return (word << 8) + Test_Sequence_Code[offset];
+}
+static void Set_Test_Sequence_Gate(t_uint8 gate, t_uint8 status){
+    switch(gate){
+        case Seq_Gate_VPD:
+            _DUI_SetPackDSGInputPortForMeasurement(status ? Turn_On : Turn_Off);
+            break;
+        case Seq_Gate_VPC:
+            _DUI_SetPackCHGInputPortForMeasurement(status ? Turn_On : Turn_Off);
+            break;
+        case Seq_Gate_Loading:
+            _DUI_SetKitLoading(status ? Turn_On : Turn_Off);
+            break;
+        case Seq_Gate_Charging_Via_Pack_D:
+        default:
+            _DUI_SetChargingViaDSGPort(status ? Turn_On : Turn_Off);
+            break;
+    }
+}
+// operands of each op and the targets of branches are checked before running
+static t_uint8 Check_Test_Sequence_Code(t_uint16 length){
+    t_uint8 op_start_bits[Test_Sequence_Max_Length / 8];
+    t_uint16 pc;
+    t_uint16 target;
+    t_uint16 samples;
+    t_uint8 *op;
+
+    for(pc = 0; pc < (Test_Sequence_Max_Length / 8); pc++){
+        op_start_bits[pc] = 0;
+    }
+    pc = 0;
+    while(pc < length){
+        op = &Test_Sequence_Code[pc];
+        if((op[0] > Seq_Op_Jump) || ((pc + Test_Sequence_Op_Size[op[0]]) > length)){
+            return Func_Failure;
+        }
+        switch(op[0]){
+            case Seq_Op_Gate:
+                if((op[1] > Seq_Gate_Charging_Via_Pack_D) || (op[2] > 1)){
+                    return Func_Failure;
+                }
+                break;
+            case Seq_Op_Charger:
+                if((op[1] > Switch_To_48V_Ch) || (op[2] > Chger_ID_2nd_Step)){
+                    return Func_Failure;
+                }
+                break;
+            case Seq_Op_Comm_Mux:
+                if(op[1] > UART_Channel){
+                    return Func_Failure;
+                }
+                break;
+            case Seq_Op_Wait:
+                if(Get_Test_Sequence_Word(pc + 1) > Test_Sequence_Max_Wait_MS){
+                    return Func_Failure;
+                }
+                break;
+            case Seq_Op_Measure:
+                samples = Get_Test_Sequence_Word(pc + 3);
+                if((op[1] > Empty3) || (op[2] > Measured_Discharging_Current) ||
+                   (samples < ADC_Oversample_Min_Samples) || (samples > ADC_Oversample_Max_Samples) ||
+                   (samples % ADC_Oversample_Block_Samples) || (op[5] > Oversample_Decimate)){
+                    return Func_Failure;
+                }
+                break;
+            case Seq_Op_Branch_Outside:
+                if(Get_Test_Sequence_Word(pc + 1) > Get_Test_Sequence_Word(pc + 3)){
+                    return Func_Failure;
+                }
+                break;
+            default:
+                break;
+        }
+        op_start_bits[pc >> 3] |= (1 << (pc & 0x07));
+        pc += Test_Sequence_Op_Size[op[0]];
+    }
+    //targets are ops or the end of bytecode
+    for(pc = 0; pc < length; pc += Test_Sequence_Op_Size[Test_Sequence_Code[pc]]){
+        if(Test_Sequence_Code[pc] == Seq_Op_Branch_Outside){
+            target = Get_Test_Sequence_Word(pc + 5);
+        }else if(Test_Sequence_Code[pc] == Seq_Op_Jump){
+            target = Get_Test_Sequence_Word(pc + 1);
+        }else{
+            continue;
+        }
+        if((target > length) || ((target < length) && ((op_start_bits[target >> 3] & (1 << (target & 0x07))) == 0))){
+            return Func_Failure;
+        }
+    }
+    return Func_Success;
+}
+// result with the time stamp trailer
+static t_uint16 Get_Test_Sequence_Result_Length(){
+    t_uint16 length;
+
+    length = Test_Sequence_Result_Header_Size + Test_Sequence_Result[3] * 4;
+    if(Test_Sequence_Time_Stamp){
+        length += Put_Time_Stamp_Trailer(&Test_Sequence_Result[length], Test_Sequence_Start_Time_Stamp, Test_Sequence_Done_Time_Stamp);
+    }
+    return length;
+}
+static void Finish_Test_Sequence(TestSequenceStatus status){
+    if(status != Seq_Status_Done){
+        //loading and charger are turned off if the recipe does not end itself
+        _DUI_SetKitLoading(Turn_Off);
+        _DUI_SetChargingViaDSGPort(Turn_Off);
+        _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
+    }
+    Test_Sequence_Result[0] = status;
+    Test_Sequence_Result[1] = Test_Sequence_PC;
+    Test_Sequence_Result[2] = Test_Sequence_PC >> 8;
+    Test_Sequence_State = Seq_State_Idle;
+    //send data out via usb
+    _DUI_CDC_Transmitting_Async_Response(Test_Sequence_Response_Cmd, Test_Sequence_Response_Tag, Test_Sequence_Result, Get_Test_Sequence_Result_Length());
+}
+static void Save_Test_Sequence_Result(){
+    t_uint8 *result;
+    t_uint16 adc;
+    t_uint16 value;
+    t_uint32 start_time_stamp;
+
+    _DUI_Get_ADC_Time_Stamps(&start_time_stamp, &Test_Sequence_Done_Time_Stamp);
+    if(Test_Sequence_Result[3] == 0){
+        Test_Sequence_Start_Time_Stamp = start_time_stamp;
+    }
+    if(Test_Sequence_Measured_Function == Measured_Empty){
+        //raw channel, the value is the reduced ADC
+        adc = _DUI_Get_Reduced_ADC_SingleChannle_Result();
+        value = adc;
+    }else{
+        adc = _DUI_Get_Calibrated_ADC_SingleChannle_Result((MeasuredFunctions)Test_Sequence_Measured_Function);
+        value = _DUI_Get_RealMeasuredDate_By_ADC((MeasuredFunctions)Test_Sequence_Measured_Function, adc);
+    }
+    if(_DUI_Limit_Check((MeasuredFunctions)Test_Sequence_Measured_Function, (Chger_ID_Steps)Test_Sequence_ID_Step, value) == Limit_Fail){
+        Test_Sequence_Result[4 + (Test_Sequence_Result[3] >> 3)] |= (1 << (Test_Sequence_Result[3] & 0x07));
+    }
+    result = &Test_Sequence_Result[Test_Sequence_Result_Header_Size + Test_Sequence_Result[3] * 4];
+    result[0] = adc;
+    result[1] = adc >> 8;
+    result[2] = value;
+    result[3] = value >> 8;
+    Test_Sequence_Result[3]++;
+}
+// execute ops until the sequence waits, converts or stops
+static void Execute_Test_Sequence_Ops(){
+    t_uint8 *op;
+    t_uint8 *result;
+    t_uint16 value;
+    t_uint8 index;
+
+    while(1){
+        if(Test_Sequence_Abort_Flag){
+            Finish_Test_Sequence(Seq_Status_Aborted);
+            return;
+        }
+        if((Test_Sequence_PC >= Test_Sequence_Length) || (Test_Sequence_Code[Test_Sequence_PC] == Seq_Op_End)){
+            Finish_Test_Sequence(Seq_Status_Done);
+            return;
+        }
+        if(Test_Sequence_Executed_Ops >= Test_Sequence_Max_Executed_Ops){
+            Finish_Test_Sequence(Seq_Status_Op_Limit);
+            return;
+        }
+        Test_Sequence_Executed_Ops++;
+        op = &Test_Sequence_Code[Test_Sequence_PC];
+        switch(op[0]){
+            case Seq_Op_Gate:
+                Set_Test_Sequence_Gate(op[1], op[2]);
+                break;
+            case Seq_Op_Charger:
+                _DUI_SwitchChargerInputAndIDStep((Switch_Channnel)op[1], (Chger_ID_Steps)op[2]);
+                Test_Sequence_ID_Step = op[2];
+                break;
+            case Seq_Op_Comm_Mux:
+                _DUI_Switch_To_Communication_Port((Commun_Peripheral_ch)op[1]);
+                break;
+            case Seq_Op_Wait:
+                Test_Sequence_PC += Test_Sequence_Op_Size[Seq_Op_Wait];
+                _DUI_Start_Charger_ID_Settle_Time(Get_Test_Sequence_Word(Test_Sequence_PC - 2));
+                Test_Sequence_State = Seq_State_Waiting;
+                return;
+            case Seq_Op_Measure:
+                if(Test_Sequence_Result[3] >= Test_Sequence_Max_Results){
+                    Finish_Test_Sequence(Seq_Status_Result_Full);
+                    return;
+                }
+                Test_Sequence_Measured_Function = op[2];
+                _DUI_Set_ADC_Oversampling_for_RepeatedSingleCh(Get_Test_Sequence_Word(Test_Sequence_PC + 3), (ADCOversampleReducers)op[5]);
+                _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh((MeasuredADCChannels)op[1]);
+                _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
+                Test_Sequence_PC += Test_Sequence_Op_Size[Seq_Op_Measure];
+                Test_Sequence_State = Seq_State_Converting;
+                return;
+            case Seq_Op_Branch_Outside:
+                if(Test_Sequence_Result[3] == 0){
+                    Finish_Test_Sequence(Seq_Status_No_Measurement);
+                    return;
+                }
+                //real value of the last measurement
+                index = Test_Sequence_Result[3] - 1;
+                result = &Test_Sequence_Result[Test_Sequence_Result_Header_Size + index * 4];
+                value = result[3];
+                value = (value << 8) + result[2];
+                if((value < Get_Test_Sequence_Word(Test_Sequence_PC + 1)) || (value > Get_Test_Sequence_Word(Test_Sequence_PC + 3))){
+                    Test_Sequence_Result[4 + (index >> 3)] |= (1 << (index & 0x07));
+                    Test_Sequence_PC = Get_Test_Sequence_Word(Test_Sequence_PC + 5);
+                    continue;
+                }
+                break;
+            case Seq_Op_Jump:
+                Test_Sequence_PC = Get_Test_Sequence_Word(Test_Sequence_PC + 1);
+                continue;
+            default:
+                break;
+        }
+        Test_Sequence_PC += Test_Sequence_Op_Size[op[0]];
+    }
+}
+
+// data : count bytes of bytecode at offset, refused while running
+t_uint8 _DUI_Test_Sequence_Upload(t_uint16 offset, t_uint8 count, t_uint8 *data){
+    t_uint8 i;
+
+    if(_DUI_Test_Sequence_Is_Running() || ((offset + count) > Test_Sequence_Max_Length)){
+        return Func_Failure;
+    }
+    for(i = 0; i < count; i++){
+        Test_Sequence_Code[offset + i] = data[i];
+    }
+    return Func_Success;
+}
+// crc : ModBus CRC16 of length bytes of bytecode
+// time_stamp : 1 = time stamps of the first and the last Seq_Op_Measure after the result
+// return Func_Failure if ADC or measurement jobs are busy, or bytecode is not valid
+t_uint8 _DUI_Test_Sequence_Run(t_uint16 length, t_uint16 crc, t_uint8 response_cmd, t_uint8 time_stamp){
+    t_uint8 i;
+
+    if(_DUI_Test_Sequence_Is_Running() || _DUI_Measurement_Job_Is_Busy() ||
+       (G_1st_Module_Function_Status & (ADC_Stream_Processing + ADC_Watch_Processing))){
+        return Func_Failure;
+    }
+    if((length == 0) || (length > Test_Sequence_Max_Length) || (usMBCRC16(Test_Sequence_Code, length) != crc) ||
+       (Check_Test_Sequence_Code(length) == Func_Failure)){
+        return Func_Failure;
+    }
+    for(i = 0; i < Test_Sequence_Result_Header_Size; i++){
+        Test_Sequence_Result[i] = 0;
+    }
+    Test_Sequence_Result[0] = Seq_Status_Running;
+    Test_Sequence_Length = length;
+    Test_Sequence_PC = 0;
+    Test_Sequence_Executed_Ops = 0;
+    Test_Sequence_Abort_Flag = 0;
+    Test_Sequence_ID_Step = Chger_ID_OFF;
+    Test_Sequence_Response_Cmd = response_cmd;
+    Test_Sequence_Response_Tag = _DUI_CDC_Get_Response_Tag();
+    Test_Sequence_Time_Stamp = time_stamp;
+    Test_Sequence_Start_Time_Stamp = 0;
+    Test_Sequence_Done_Time_Stamp = 0;
+    Test_Sequence_State = Seq_State_Executing;
+    return Func_Success;
+}
+// the sequence stops after the conversion in progress, the result is still sent
+void _DUI_Test_Sequence_Abort(){
+    if(_DUI_Test_Sequence_Is_Running()){
+        Test_Sequence_Abort_Flag = 1;
+    }
+}
+void _DUI_Test_Sequence_Process(){
+    switch(Test_Sequence_State){
+        case Seq_State_Executing:
+            Execute_Test_Sequence_Ops();
+            break;
+        case Seq_State_Waiting:
+            if(_DUI_Is_Charger_ID_Settling()){
+                if(Test_Sequence_Abort_Flag == 0){
+                    break;
+                }
+                _DUI_Start_Charger_ID_Settle_Time(0);
+            }
+            Test_Sequence_State = Seq_State_Executing;
+            Execute_Test_Sequence_Ops();
+            break;
+        case Seq_State_Converting:
+            if((G_Module_Function_Status & ADC_Done_Conversion) == 0){
+                break;
+            }
+            G_Module_Function_Status &= ~ADC_Done_Conversion;
+            G_Module_Function_Status &= ~ADC_Start_Conversion;
+            Save_Test_Sequence_Result();
+            Test_Sequence_State = Seq_State_Executing;
+            Execute_Test_Sequence_Ops();
+            break;
+        default:
+            break;
+    }
+}
+// 1 if _DUI_Test_Sequence_Process() has something to do, main() does not sleep
+t_uint8 _DUI_Test_Sequence_Is_Ready(){
+    switch(Test_Sequence_State){
+        case Seq_State_Executing:
+            return 1;
+        case Seq_State_Waiting:
+            return ((_DUI_Is_Charger_ID_Settling() == 0) || Test_Sequence_Abort_Flag);
+        case Seq_State_Converting:
+            return ((G_Module_Function_Status & ADC_Done_Conversion) != 0);
+        default:
+            return 0;
+    }
+}
+t_uint8 _DUI_Test_Sequence_Is_Running(){
+    return (Test_Sequence_State != Seq_State_Idle);
+}
+// result of the running or the last sequence, return length of buffer
+t_uint16 _DUI_Test_Sequence_Get_Result(t_uint8 *buffer){
+    t_uint16 i;
+    t_uint16 length;
+
+    Test_Sequence_Result[1] = Test_Sequence_PC;
+    Test_Sequence_Result[2] = Test_Sequence_PC >> 8;
+    length = Get_Test_Sequence_Result_Length();
+    for(i = 0; i < length; i++){
+        buffer[i] = Test_Sequence_Result[i];
+    }
+    return length;
 }
 //t_uint16 _DUI_Get_Voltage_By_ADC(t_uint8 ADCchannel, t_uint16 Vadc){
 //
@@ -83,6 +83,10 @@ void _DUI_Remove_Function_Out_Of_Polling(void (*polling_fun)());
 void _DUI_Init_Comm_Packet_Form_Detection_Timer();
 void _DUI_Set_Calling_Function_While_Form_Detection(t_uint8 fun_index, void (*calling_fun)(), t_uint16 ms_Dealy );
 void _DUI_Remove_Detection_Calling_Function(t_uint8 fun_index);
+
+#define Charger_ID_Settle_Fun_Index     2   //0, 1 are used by UART receiving frame detection
+void _DUI_Start_Charger_ID_Settle_Time(t_uint16 ms_Delay);
+t_uint8 _DUI_Is_Charger_ID_Settling();
 /////////////////////////////////////////////////////////////////////
 // I/O Ports config
 /////////////////////////////////////////////////////////////////////
@@ -155,13 +159,41 @@ typedef enum{
     Measured_Charging_Current,
     Measured_Discharging_Current
 }MeasuredFunctions;
+//same order as ADC_Oversample_Reducer of MCU_Devices
+typedef enum{
+    Oversample_Mean = 0,
+    Oversample_Median,
+    Oversample_Trimmed_Mean,
+    Oversample_Decimate
+}ADCOversampleReducers;
+#define Default_Oversample_Samples      8
+//{ADC, Real Values} words of Measured_24V_Chger ~ Measured_Discharging_Current
+#define All_Measured_Result_Size        (Measured_Discharging_Current * 2)
+
+//piecewise linear calibration table of a MeasuredFunctions, ADC (after offset) to real value
+#define Cal_Table_Max_Points            8
+typedef struct{
+    t_uint16 ADC;
+    t_uint16 Value;
+}Cal_Table_Point;
+typedef struct{
+    t_uint8 MeasuredFunction;
+    t_uint8 Points;
+    Cal_Table_Point Point[Cal_Table_Max_Points];
+    t_uint16 CRC;               //CRC-CCITT (usCRC16CCITT) of all bytes above, ModBus CRC16 in records of older firmware
+}Cal_Table_Record;
+#define Cal_Table_Record_Size           (2 + Cal_Table_Max_Points * 4 + 2)
 
 void _DUI_ADC_Function_Init_for_SequenceSampling();
 void _DUI_Start_ADC_Conversion_for_SequenceSampling();
 
 void _DUI_ADC_Function_Init_for_RepeatedSingleCh();
 void _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(MeasuredADCChannels channel);
+t_uint8 _DUI_Set_ADC_Oversampling_for_RepeatedSingleCh(t_uint16 samples, ADCOversampleReducers reducer);
 void _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
+void _DUI_Set_ADC_Continuous_for_RepeatedSingleCh(t_uint8 enable);
+t_uint16 _DUI_Get_ADC_Overrun_Count_for_RepeatedSingleCh();
+void _DUI_Get_ADC_Time_Stamps(t_uint32 *start_time_stamp, t_uint32 *done_time_stamp);
 
 
 void _DUI_Set_Function_For_ADC_Conversion_Done_Calling(void (*calling_fun)());
@@ -170,8 +202,138 @@ void _DUI_Remove_ADC_Conversion_Done_Function();
 //t_uint16 _DUI_Channle_ADC_Result(t_uint8 ADCchannel);
 //t_uint16 _DUI_Get_Voltage_By_ADC(t_uint8 ADCchannel, t_uint16 Vadc);
 
+t_uint8 _DUI_ADC_Stream_Start(MeasuredADCChannels channel, t_uint8 sequence, t_uint16 sample_rate);
+void _DUI_ADC_Stream_Stop();
+t_uint8 _DUI_ADC_Stream_Is_Block_Ready();
+t_uint16* _DUI_ADC_Stream_Get_Ready_Block(t_uint32 *block_number);
+t_uint8 _DUI_ADC_Stream_Release_Block(t_uint32 block_number);
+t_uint16 _DUI_ADC_Stream_Get_Dropped_Blocks();
+t_uint8 _DUI_ADC_Watch_Start(MeasuredADCChannels channel, t_uint16 sample_rate, t_uint16 low_threshold, t_uint16 high_threshold);
+void _DUI_ADC_Watch_Stop();
+t_uint8 _DUI_ADC_Watch_Is_Event_Ready();
+t_uint8 _DUI_ADC_Watch_Get_Event(t_uint32 *sample_number, t_uint32 *time_stamp, t_uint16 *adc, t_uint8 *state);
+t_uint16 _DUI_ADC_Watch_Get_Lost_Events();
+
 t_uint16 _DUI_Get_Raw_ADC_SingleChannle_Result();
+t_uint16 _DUI_Get_Reduced_ADC_SingleChannle_Result();
 t_uint16 _DUI_Get_Calibrated_ADC_SingleChannle_Result(MeasuredFunctions mf);
+t_uint16 _DUI_Get_Calibrated_ADC_Sequence_Result(MeasuredFunctions mf);
+t_uint16 _DUI_Get_Calibrated_ADC_By_Raw_ADC(MeasuredFunctions mf, t_uint16 RawAdc);
+void _DUI_Get_All_Measured_Result_For_SequenceSampling(t_uint16 *result);
+MeasuredADCChannels _DUI_Get_Measured_Function_ADC_Channel(MeasuredFunctions mf);
+void _DUI_Update_Real_Value_Multipliers();
 t_uint16 _DUI_Get_RealMeasuredDate_By_ADC(MeasuredFunctions mf, t_uint16 Adc);
 
+t_uint8 _DUI_Cal_Table_Upload(MeasuredFunctions mf, t_uint8 points, t_uint8 index, t_uint8 count, t_uint8 *data);
+t_uint8 _DUI_Cal_Table_Activate(MeasuredFunctions mf, t_uint8 activate);
+const Cal_Table_Record* _DUI_Cal_Table_Get(MeasuredFunctions mf, t_uint8 stored);
+t_uint8 _DUI_Cal_Table_Is_Active(MeasuredFunctions mf);
+t_uint8 _DUI_Cal_Table_Is_Uploaded();
+
+//pass/fail limits of real values, charger functions may have a limit of each Chger_ID_Steps
+typedef enum{
+    Limit_Not_Set,
+    Limit_Pass,
+    Limit_Fail
+}LimitVerdicts;
+t_uint8 _DUI_Limit_Table_Set(MeasuredFunctions mf, Chger_ID_Steps idStep, t_uint16 min, t_uint16 max);
+void _DUI_Limit_Table_Clear(MeasuredFunctions mf);
+t_uint8 _DUI_Limit_Table_Get(MeasuredFunctions mf, Chger_ID_Steps idStep, t_uint16 *min, t_uint16 *max);
+LimitVerdicts _DUI_Limit_Check(MeasuredFunctions mf, Chger_ID_Steps idStep, t_uint16 value);
+
+/////////////////////////////////////////////////////////////////////
+// Measurement job queue
+/////////////////////////////////////////////////////////////////////
+#define Measurement_Job_Queue_Size      8
+typedef enum{
+    Job_Gate_None,              //direct measurement, peripheral is not set
+    Job_Gate_Pack_DSG,          //Pack DSG input port is turned on while measuring
+    Job_Gate_Pack_CHG,          //Pack CHG input port is turned on while measuring
+    Job_Gate_Charger_24V,       //charger input is switched, ID is switched at each step
+    Job_Gate_Charger_36V,
+    Job_Gate_Charger_48V
+}MeasurementJobGates;
+typedef enum{
+    Job_Post_Raw_ADC,           //2 bytes, reduced ADC
+    Job_Post_Calibrated,        //4 bytes of each step, {ADC, Real Values}
+    Job_Post_All_Sequence,      //All_Measured_Result_Size words by one Sequence of Channels conversion
+    Job_Post_Statistics         //Measurement_Job_Statistics_Size bytes over Steps conversions
+}MeasurementJobPosts;
+//{count, min, max, mean(Q16.16), sample variance(Q32.16, 6 bytes), ADC overrun count} of Real Values (reduced ADC of Measured_Empty)
+#define Measurement_Job_Statistics_Size 18
+//verdict of Job_Post_Calibrated and Job_Post_All_Sequence, 2 bytes {fail bits, checked bits}
+//bit n is step n, or (MeasuredFunctions - 1) of Job_Post_All_Sequence
+typedef enum{
+    Job_Verdict_None,           //values only
+    Job_Verdict_Append,         //values, then verdict
+    Job_Verdict_Only            //verdict only
+}MeasurementJobVerdicts;
+//time stamp trailer of the results, {start(4 bytes), done(4 bytes)}, Lo-byte first, Timer_A_Counts_Per_MS counts per ms
+//start : ADC start of the first conversion, done : DMA done of the last conversion
+#define Time_Stamp_Trailer_Size         8
+typedef struct{
+    t_uint8 Response_Cmd;       //result is sent by this cmd
+    t_uint8 Gate;               //MeasurementJobGates
+    t_uint8 ADC_Channel;        //MeasuredADCChannels
+    t_uint8 Measured_Function;  //MeasuredFunctions of Job_Post_Calibrated
+    t_uint16 Steps;             //conversions, charger ID step = step number
+    t_uint8 Post;               //MeasurementJobPosts
+    t_uint16 Settle_ms;         //settle time before each step after the first one
+    t_uint16 Samples;           //oversampling of repeated single channel
+    t_uint8 Reducer;            //ADCOversampleReducers
+    t_uint8 Verdict;            //MeasurementJobVerdicts
+    t_uint8 Time_Stamp;         //1: Time_Stamp_Trailer_Size bytes after the result
+    t_uint16 Response_Tag;      //set by _DUI_Measurement_Job_Enqueue(), response tag of the cmd
+}MeasurementJob;
+
+t_uint8 _DUI_Measurement_Job_Enqueue(const MeasurementJob *job);
+void _DUI_Measurement_Job_Process();
+t_uint8 _DUI_Measurement_Job_Is_Ready();
+t_uint8 _DUI_Measurement_Job_Is_Busy();
+t_uint8 _DUI_Measurement_Job_Is_Using_Charger();
+
+/////////////////////////////////////////////////////////////////////
+// Test sequence
+/////////////////////////////////////////////////////////////////////
+#define Test_Sequence_Max_Length            128     //bytes of bytecode
+#define Test_Sequence_Max_Results           16      //{ADC, Real Values} of Seq_Op_Measure, fail bits of the header have room for 32
+#define Test_Sequence_Max_Executed_Ops      1024    //guard of loops made by jumps
+#define Test_Sequence_Max_Wait_MS           60000
+#define Test_Sequence_Result_Header_Size    8
+#define Test_Sequence_Result_Max_Size       (Test_Sequence_Result_Header_Size + Test_Sequence_Max_Results * 4)
+//opcodes and operands (Lo-byte first), target is the byte offset of an op
+typedef enum{
+    Seq_Op_End,                 //0x00
+    Seq_Op_Gate,                //0x01 <TestSequenceGates> <0:turn off, 1:turn on>
+    Seq_Op_Charger,             //0x02 <Switch_Channnel> <Chger_ID_Steps>
+    Seq_Op_Comm_Mux,            //0x03 <Commun_Peripheral_ch>
+    Seq_Op_Wait,                //0x04 <ms(Lo)> <ms(Hi)>
+    Seq_Op_Measure,             //0x05 <MeasuredADCChannels> <MeasuredFunctions> <samples(Lo)> <samples(Hi)> <ADCOversampleReducers>
+    Seq_Op_Branch_Outside,      //0x06 <min(Lo)> <min(Hi)> <max(Lo)> <max(Hi)> <target(Lo)> <target(Hi)>
+    Seq_Op_Jump                 //0x07 <target(Lo)> <target(Hi)>
+}TestSequenceOps;
+typedef enum{
+    Seq_Gate_VPD,               //_DUI_SetPackDSGInputPortForMeasurement
+    Seq_Gate_VPC,               //_DUI_SetPackCHGInputPortForMeasurement
+    Seq_Gate_Loading,           //_DUI_SetKitLoading
+    Seq_Gate_Charging_Via_Pack_D    //_DUI_SetChargingViaDSGPort
+}TestSequenceGates;
+typedef enum{
+    Seq_Status_Idle,            //not run yet
+    Seq_Status_Running,
+    Seq_Status_Done,            //Seq_Op_End or end of bytecode
+    Seq_Status_Aborted,
+    Seq_Status_Result_Full,     //more than Test_Sequence_Max_Results measurements
+    Seq_Status_Op_Limit,        //more than Test_Sequence_Max_Executed_Ops ops
+    Seq_Status_No_Measurement   //Seq_Op_Branch_Outside before any Seq_Op_Measure
+}TestSequenceStatus;
+
+t_uint8 _DUI_Test_Sequence_Upload(t_uint16 offset, t_uint8 count, t_uint8 *data);
+t_uint8 _DUI_Test_Sequence_Run(t_uint16 length, t_uint16 crc, t_uint8 response_cmd, t_uint8 time_stamp);
+void _DUI_Test_Sequence_Abort();
+void _DUI_Test_Sequence_Process();
+t_uint8 _DUI_Test_Sequence_Is_Ready();
+t_uint8 _DUI_Test_Sequence_Is_Running();
+t_uint16 _DUI_Test_Sequence_Get_Result(t_uint8 *buffer);
+
 //void _DUI_Auto_check_Charger_for_Pollong();
@@ -50,6 +50,15 @@
 //==============================================================================
 // Private typedef
 //==============================================================================
+//single producer(RX interrupt) / single consumer(main loop) ring, indexes are free running and masked
+//Head is only written by set_Value_To_Receive_Buffer(), Tail only by _DUI_Get_Receiving_Data_To_Array() and _DUI_Get_Comm_Module_Bridge_Data()
+typedef struct{
+    t_uint8 Data[UART_Receiving_Ring_Size];
+    __IO t_uint16 Head;
+    __IO t_uint16 Tail;
+    __IO t_uint16 Frame_End;        //Head at the last frame end, set by Timer interrupt
+    __IO t_uint16 Overrun_Count;    //bytes dropped by full ring
+}UART_Receiving_Ring;
 //==============================================================================
 // Private define
 //==============================================================================
@@ -166,15 +175,57 @@ unsigned int g_UART_Module_Status_Flag;
 t_uint32 UART_Module_Setting_BAUD_RATE = 0;
 
 
-__IO unsigned int UART_Module_1_Receiving_Data_Index;
-unsigned char UART_Module_1_Receiving_Data[UART_Receiving_Max_Data_Length ];
-unsigned char UART_Module_1_Transmitting_Data[UART_Transmitting_Max_Data_Length ];
+//index : Uart_RS485_Module, One_Wire_Module
+static UART_Receiving_Ring UART_Module_Receiving_Ring[2];
+static t_uint8 UART_Module_Frame_End_Mode[2];
+static t_uint16 UART_Module_Frame_End_Gap_MS[2];        //0 : t3.5 of the baud rate
+static t_uint16 UART_Module_Frame_End_Gap_Ticks[2];     //Timer B periods, set by _DUI_Communication_Enable()
+static __IO t_uint8 Comm_Bridge_Module = Comm_Bridge_Off;
+
+//transmit-and-await-reply transaction, one at a time, done by _DUI_Comm_Transaction_Process() of main()
+enum Comm_Transaction_State{
+    Comm_Transaction_Idle,
+    Comm_Transaction_Waiting_Reply
+};
+static __IO t_uint8 Comm_Transaction_State;
+static t_uint8 Comm_Transaction_Module;
+static t_uint8 Comm_Transaction_Response_Cmd;
+static t_uint16 Comm_Transaction_Response_Tag;
+static void (*Comm_Transaction_Done_ptr_fuc)(t_uint8 status);   //calling when the transaction is finished
+static t_uint8 Comm_Transaction_Frame_End_Mode;
+static t_uint16 Comm_Transaction_Expected_Length;       //0 : by frame end of the module
+static t_uint16 Comm_Transaction_Timeout_MS;
+static t_uint8 Comm_Transaction_Retries;
+static t_uint8 Comm_Transaction_Attempts;
+static __IO t_uint8 Comm_Transaction_Timeout_Flag;
+static __IO t_uint8 Comm_Transaction_Transmitting;      //1 : payload of the attempt is not sent out yet
+static t_uint32 Comm_Transaction_Start_Time_Stamp;
+static t_uint8 Comm_Transaction_Payload[Comm_Transaction_Max_Payload_Length];
+static t_uint16 Comm_Transaction_Payload_Length;
+
+//Modbus RTU master on the transaction of RS485 module, read plan is a list of register ranges
+typedef struct {
+    t_uint8 Function;
+    t_uint8 Quantity;
+    t_uint16 Start_Address;
+} Modbus_Read_Plan_Entry;
+
+static t_uint8 Modbus_Slave_Address;
+static t_uint8 Modbus_Response_Cmd;
+static t_uint16 Modbus_Response_Tag;
+static t_uint16 Modbus_Timeout_MS;
+static t_uint8 Modbus_Retries;
+static Modbus_Read_Plan_Entry Modbus_Read_Plan[Modbus_Max_Read_Plan_Entries];
+static t_uint8 Modbus_Read_Plan_Entries;    //0 : write request
+static t_uint8 Modbus_Read_Plan_Index;
+static t_uint8 Modbus_Attempts;
+static t_uint32 Modbus_Start_Time_Stamp;
+static t_uint16 Modbus_Response_Length;
+static t_uint8 Modbus_Response[Modbus_Response_Header_Length + (Modbus_Max_Read_Plan_Registers * 2)];
+static t_uint8 Modbus_Reply[Modbus_Max_Reply_Length];
 //unsigned int UART_Module_1_Receiving_TempData_Index;
 //unsigned char UART_Module_1_Receiving_TempData[UART_Receiving_Max_Data_Length ];
 
-__IO unsigned int UART_Module_2_Receiving_Data_Index;
-unsigned char UART_Module_2_Receiving_Data[UART_Receiving_Max_Data_Length ];
-unsigned char UART_Module_2_Transmitting_Data[UART_Transmitting_Max_Data_Length ];
 //unsigned int UART_Module_2_Receiving_TempData_Index;
 //unsigned char UART_Module_2_Receiving_TempData[UART_Receiving_Max_Data_Length ];
 
@@ -187,49 +238,104 @@ unsigned char UART_Module_2_Transmitting_Data[UART_Transmitting_Max_Data_Length
 //==============================================================================
 // Private functions
 //==============================================================================
-static void clear_Comm_Receive_Buffer(t_uint8 uart_module){
-    t_uint16 i;
-    switch(uart_module){
-        case Uart_RS485_Module:
-            for(i = 0; i < UART_Receiving_Max_Data_Length; i++){
-                UART_Module_1_Receiving_Data[i] = 0;
-            }
-            UART_Module_1_Receiving_Data_Index = 0;
-            break;
-        case One_Wire_Module:
-            for(i = 0; i < UART_Receiving_Max_Data_Length; i++){
-                UART_Module_2_Receiving_Data[i] = 0;
-            }
-            UART_Module_2_Receiving_Data_Index = 0;
-            break;
-        default:
-            break;
+static void reset_Comm_Receive_Ring(t_uint8 uart_module){
+    UART_Receiving_Ring *ring;
+    ring = &UART_Module_Receiving_Ring[uart_module];
+    ring->Tail = ring->Head;
+    ring->Frame_End = ring->Head;
+}
+
+//producer, only called by UART RX interrupt, byte is dropped and counted if ring is full
+static void set_Value_To_Receive_Buffer(t_uint8 uart_module, __IO t_uint8 value){
+    UART_Receiving_Ring *ring;
+    t_uint16 head;
+    ring = &UART_Module_Receiving_Ring[uart_module];
+    head = ring->Head;
+    if((t_uint16)(head - ring->Tail) >= UART_Receiving_Ring_Size){
+        ring->Overrun_Count++;
+        return;
     }
+    ring->Data[head & UART_Receiving_Ring_Mask] = value;
+    ring->Head = head + 1;
 }
 
+//called by Timer interrupt, bytes up to Head are one frame
+static void set_Frame_End_Of_Receive_Buffer(t_uint8 uart_module){
+    UART_Receiving_Ring *ring;
+    ring = &UART_Module_Receiving_Ring[uart_module];
+    ring->Frame_End = ring->Head;
+}
 
-static void set_Value_To_Receive_Buffer(t_uint8 uart_module, __IO t_uint8 value){
-    t_uint8 temp;
-    switch(uart_module){
-        case Uart_RS485_Module:
-            if(UART_Module_1_Receiving_Data_Index >= UART_Receiving_Max_Data_Length){
-                UART_Module_1_Receiving_Data_Index = 0;
+//called by UART RX interrupt after the byte is put, return 1 if the byte ends the frame by UART_Module_Frame_End_Mode
+//the gap of silence still ends a frame which does not match
+//a transaction waiting for the reply takes its own length and mode
+static t_uint8 is_Frame_End_By_Protocol(t_uint8 uart_module){
+    UART_Receiving_Ring *ring;
+    t_uint16 count;
+    t_uint16 end_code;
+    t_uint8 mode;
+
+    ring = &UART_Module_Receiving_Ring[uart_module];
+    count = ring->Head - ring->Frame_End;
+    if(Comm_Bridge_Module == uart_module){
+        //bytes of one USB packet are ready for host
+        return (count >= UART_Bridge_Chunk_Length);
+    }
+    mode = UART_Module_Frame_End_Mode[uart_module];
+    if((Comm_Transaction_State == Comm_Transaction_Waiting_Reply) && (Comm_Transaction_Module == uart_module)){
+        if(Comm_Transaction_Expected_Length && (count >= Comm_Transaction_Expected_Length)){
+            return 1;
+        }
+        if(Comm_Transaction_Frame_End_Mode != Frame_End_Mode_Of_Module){
+            mode = Comm_Transaction_Frame_End_Mode;
+        }
+    }
+    if(count < 2){
+        return 0;
+    }
+    end_code = ring->Data[(t_uint16)(ring->Head - 2) & UART_Receiving_Ring_Mask];
+    end_code = (end_code << 8) | ring->Data[(t_uint16)(ring->Head - 1) & UART_Receiving_Ring_Mask];
+    switch(mode){
+        case Frame_End_By_LEV_Length:
+            //leading, addr, cmd, length, data[length], 2bytes checksum, 2bytes end code
+            if((count < MIN_Receive_Packet_Num) || (ring->Data[ring->Frame_End & UART_Receiving_Ring_Mask] != LeadingCode)){
+                return 0;
+            }
+            if(count == (ring->Data[(t_uint16)(ring->Frame_End + 3) & UART_Receiving_Ring_Mask] + (MIN_Receive_Packet_Num - 1))){
+                return 1;
             }
-            temp = value;
-            UART_Module_1_Receiving_Data[UART_Module_1_Receiving_Data_Index] = temp;
-            UART_Module_1_Receiving_Data_Index++;
             break;
-        case One_Wire_Module:
-            if(UART_Module_2_Receiving_Data_Index >= UART_Receiving_Max_Data_Length){
-                UART_Module_2_Receiving_Data_Index = 0;
+        case Frame_End_By_End_Code:
+            if(end_code == ((EndCode1 << 8) | EndCode2)){
+                return 1;
+            }
+            break;
+        case Frame_End_By_One_Wire_End_Code:
+            //preceding code and end check code at least
+            if((count >= 4) && (end_code == ONE_WIRE_EndCheckCode)){
+                return 1;
             }
-            temp = value;
-            UART_Module_2_Receiving_Data[UART_Module_2_Receiving_Data_Index] = temp;
-            UART_Module_2_Receiving_Data_Index++;
             break;
         default:
             break;
     }
+    return 0;
+}
+
+static t_uint16 get_Frame_End_Gap_Ticks(t_uint8 uart_module){
+    t_uint32 gap_us;
+
+    if(Comm_Bridge_Module == uart_module){
+        gap_us = UART_Bridge_Gap_MS * 1000UL;
+    }else if(UART_Module_Frame_End_Gap_MS[uart_module]){
+        gap_us = (t_uint32)UART_Module_Frame_End_Gap_MS[uart_module] * 1000;
+    }else if(UART_Module_Setting_BAUD_RATE > UART_Frame_End_Gap_Fixed_Baud_Rate){
+        gap_us = UART_Frame_End_Gap_Fixed_US;
+    }else{
+        gap_us = (UART_Frame_End_Gap_Char_Bits * 100000UL + UART_Module_Setting_BAUD_RATE - 1) / UART_Module_Setting_BAUD_RATE;
+    }
+    //+1 period, the first period after setting is not a whole one
+    return ((gap_us + (Timer_B_Polling_Base_MS * 1000UL) - 1) / (Timer_B_Polling_Base_MS * 1000UL)) + 1;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -244,9 +350,9 @@ static void Communication_Module_1_Receive_Frame_Detection_By_Timer(){
 //    }else{
 //        g_UART_Module_Status_Flag |= Detect_UART_M1_End_Frame;
 //    }
-    g_UART_Module_Status_Flag |= Detect_UART_M1_End_Frame;
+    set_Frame_End_Of_Receive_Buffer(Uart_RS485_Module);
 }
-static void Communication_Module_1_Calling_By_Receive_Interrupt_With_Timer(__IO unsigned char receivedByte){
+static t_uint8 Communication_Module_1_Calling_By_Receive_Interrupt_With_Timer(__IO unsigned char receivedByte){
 //    t_uint8 temp = 0;
 //    if(g_UART_Module_Status_Flag & Detect_UART_M1_End_Frame){
 //        temp = receivedByte;
@@ -254,10 +360,16 @@ static void Communication_Module_1_Calling_By_Receive_Interrupt_With_Timer(__IO
 //    }
     //g_UART_Module_Status_Flag &= ~Detect_UART_M1_End_Frame;
     set_Value_To_Receive_Buffer(Uart_RS485_Module, receivedByte);
-    _Device_Set_TimerB_Interrupt_Timer_Calling_Function_With_Delay_And_Exec(Uart_RS485_Module_Receiving_Frame_Fun_Index, Communication_Module_1_Receive_Frame_Detection_By_Timer, UratRXFrameEndGapTime);
+    if(is_Frame_End_By_Protocol(Uart_RS485_Module)){
+        _Device_Remove_TimerB_Interrupt_Timer_Calling_Function(Uart_RS485_Module_Receiving_Frame_Fun_Index);
+        set_Frame_End_Of_Receive_Buffer(Uart_RS485_Module);
+        return Uart_Receive_Exit_LPM;
+    }
+    _Device_Set_TimerB_Interrupt_Timer_Calling_Function_With_Delay_And_Exec(Uart_RS485_Module_Receiving_Frame_Fun_Index, Communication_Module_1_Receive_Frame_Detection_By_Timer, UART_Module_Frame_End_Gap_Ticks[Uart_RS485_Module]);
+    return Uart_Receive_Keep_LPM;
 }
 static t_uint8 Check_Communication_Module_1_Receive_Data(){
-    if((g_UART_Module_Status_Flag & Detect_UART_M1_End_Frame) == 0){
+    if(UART_Module_Receiving_Ring[Uart_RS485_Module].Frame_End == UART_Module_Receiving_Ring[Uart_RS485_Module].Tail){
         return UART_RECEIVING_DATA_NOT_READY;
     }
     return UART_RECEIVING_DATA_READY;
@@ -272,9 +384,9 @@ static void Communication_Module_2_Receive_Frame_Detection_By_Timer(){
 //    }else{
 //        g_UART_Module_Status_Flag |= Detect_UART_M2_End_Frame;
 //    }
-    g_UART_Module_Status_Flag |= Detect_UART_M2_End_Frame;
+    set_Frame_End_Of_Receive_Buffer(One_Wire_Module);
 }
-static void Communication_Module_2_Calling_By_Receive_Interrupt_With_Timer(__IO unsigned char receivedByte){
+static t_uint8 Communication_Module_2_Calling_By_Receive_Interrupt_With_Timer(__IO unsigned char receivedByte){
 //    t_uint8 temp = 0;
 //    if(g_UART_Module_Status_Flag & Detect_UART_M2_End_Frame){
 //        temp = receivedByte;
@@ -282,10 +394,16 @@ static void Communication_Module_2_Calling_By_Receive_Interrupt_With_Timer(__IO
 //    }
     //g_UART_Module_Status_Flag &= ~Detect_UART_M2_End_Frame;
     set_Value_To_Receive_Buffer(One_Wire_Module, receivedByte);
-    _Device_Set_TimerB_Interrupt_Timer_Calling_Function_With_Delay_And_Exec(One_Wire_Module_Receiving_Frame_Fun_Index, Communication_Module_2_Receive_Frame_Detection_By_Timer, UratRXFrameEndGapTime);
+    if(is_Frame_End_By_Protocol(One_Wire_Module)){
+        _Device_Remove_TimerB_Interrupt_Timer_Calling_Function(One_Wire_Module_Receiving_Frame_Fun_Index);
+        set_Frame_End_Of_Receive_Buffer(One_Wire_Module);
+        return Uart_Receive_Exit_LPM;
+    }
+    _Device_Set_TimerB_Interrupt_Timer_Calling_Function_With_Delay_And_Exec(One_Wire_Module_Receiving_Frame_Fun_Index, Communication_Module_2_Receive_Frame_Detection_By_Timer, UART_Module_Frame_End_Gap_Ticks[One_Wire_Module]);
+    return Uart_Receive_Keep_LPM;
 }
 static t_uint8 Check_Communication_Module_2_Receive_Data(){
-    if((g_UART_Module_Status_Flag & Detect_UART_M2_End_Frame) == 0){
+    if(UART_Module_Receiving_Ring[One_Wire_Module].Frame_End == UART_Module_Receiving_Ring[One_Wire_Module].Tail){
         return UART_RECEIVING_DATA_NOT_READY;
     }
     return UART_RECEIVING_DATA_READY;
@@ -307,10 +425,14 @@ void _DUI_Communication_Enable(t_uint8 uart_module){
     switch(uart_module){
         case Uart_RS485_Module:
             _Device_Uart_Module_1_Enable(UART_Module_Setting_BAUD_RATE);
+            reset_Comm_Receive_Ring(Uart_RS485_Module);
+            UART_Module_Frame_End_Gap_Ticks[Uart_RS485_Module] = get_Frame_End_Gap_Ticks(Uart_RS485_Module);
             _Device_Uart_Module_1_Set_Calling_Function_By_Uart_Receive_Interrupt(Communication_Module_1_Calling_By_Receive_Interrupt_With_Timer);
             break;
         case One_Wire_Module:
             _Device_Uart_Module_2_Enable(UART_Module_Setting_BAUD_RATE);
+            reset_Comm_Receive_Ring(One_Wire_Module);
+            UART_Module_Frame_End_Gap_Ticks[One_Wire_Module] = get_Frame_End_Gap_Ticks(One_Wire_Module);
             _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Receive_Interrupt(Communication_Module_2_Calling_By_Receive_Interrupt_With_Timer);
             break;
         default:
@@ -331,33 +453,41 @@ void _DUI_Communication_Disable(t_uint8 uart_module){
     }
 }
 
-void _DUI_Communication_Send_Bytes(t_uint8 uart_module, unsigned char *sendData, unsigned int length){
-	//unsigned int commLength;
-    int i;
-    if(length > UART_Transmitting_Max_Data_Length){
-        return;
+// sendData is copied into the TX ring of the module, so it can be reused after return
+// return Func_Failure if the TX ring has no room for length bytes
+t_uint8 _DUI_Communication_Send_Bytes(t_uint8 uart_module, unsigned char *sendData, unsigned int length){
+    switch(uart_module){
+        case Uart_RS485_Module:
+            return _Device_Uart_Module_1_Send_Bytes(sendData, length); // send high byte first, send low byte second
+        case One_Wire_Module:
+            return _Device_Uart_Module_2_Send_Bytes(sendData, length); // send high byte first, send low byte second
+        default:
+            break;
     }
+    return Func_Failure;
+}
+
+// transmit_done_fun is called in the UART interrupt when all bytes are moved to the shift register
+void _DUI_Set_Communication_Transmit_Done_Function(t_uint8 uart_module, void (*transmit_done_fun)(void)){
     switch(uart_module){
         case Uart_RS485_Module:
-            for(i = 0; i < length; i++){
-                UART_Module_1_Transmitting_Data[i] = sendData[i];
-            }
-            _Device_Uart_Module_1_Send_Bytes( UART_Module_1_Transmitting_Data, length); // send high byte first, send low byte second
+            _Device_Uart_Module_1_Set_Calling_Function_By_Uart_Transmit_Done(transmit_done_fun);
             break;
         case One_Wire_Module:
-            for(i = 0; i < length; i++){
-                UART_Module_2_Transmitting_Data[i] = sendData[i];
-            }
-            _Device_Uart_Module_2_Send_Bytes( UART_Module_2_Transmitting_Data, length); // send high byte first, send low byte second
+            _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Transmit_Done(transmit_done_fun);
             break;
         default:
             break;
     }
 }
 
+//frame of the module in transaction is the reply, it is not sent out by itself
 t_uint8 _DUI_Is_Comm_Module_Receiving_Data_Ready(t_uint8 uart_module){
     t_uint8 status;
     status = UART_RECEIVING_DATA_NOT_READY;
+    if((Comm_Transaction_State != Comm_Transaction_Idle) && (Comm_Transaction_Module == uart_module)){
+        return status;
+    }
     switch(uart_module){
         case Uart_RS485_Module:
             if(Check_Communication_Module_1_Receive_Data() == UART_RECEIVING_DATA_READY){
@@ -375,41 +505,505 @@ t_uint8 _DUI_Is_Comm_Module_Receiving_Data_Ready(t_uint8 uart_module){
     return status;
 }
 
+//consumer, the frame is copied from ring to out_Array_ptr directly, e.g. data field of CDC transmitting packet
+//bytes over max_Length are dropped, bytes received after frame end are kept for next frame
 void _DUI_Get_Receiving_Data_To_Array(t_uint8 uart_module, t_uint8 *out_Array_ptr, t_uint16 *out_Array_length, t_uint16 max_Length){
+    UART_Receiving_Ring *ring;
     t_uint16 i;
     t_uint16 length;
+    t_uint16 tail;
+    t_uint16 frame_end;
+
+    *out_Array_length = 0;
+    if(uart_module > One_Wire_Module){
+        return;
+    }
+    ring = &UART_Module_Receiving_Ring[uart_module];
+    tail = ring->Tail;
+    frame_end = ring->Frame_End;
+    length = frame_end - tail;
+    if(length > max_Length){
+        length = max_Length;
+    }
+    for(i = 0; i < length; i++){
+        out_Array_ptr[i] = ring->Data[tail & UART_Receiving_Ring_Mask];
+        tail++;
+    }
+    *out_Array_length = length;
+    ring->Tail = frame_end;
+}
+
+t_uint16 _DUI_Get_Comm_Module_Receiving_Overrun_Count(t_uint8 uart_module){
+    if(uart_module > One_Wire_Module){
+        return 0;
+    }
+    return UART_Module_Receiving_Ring[uart_module].Overrun_Count;
+}
+
+//a received frame of any module is waiting for main() to send out
+//bytes of the bridge are pending by _DUI_USB_CDC_Is_Receiving_Data_Pending(), frames of the other module wait until the bridge is left
+t_uint8 _DUI_Is_Comm_Module_Receiving_Data_Pending(void){
+    if(Comm_Bridge_Module != Comm_Bridge_Off){
+        return 0;
+    }
+    if((Check_Communication_Module_1_Receive_Data() == UART_RECEIVING_DATA_READY) ||
+       (Check_Communication_Module_2_Receive_Data() == UART_RECEIVING_DATA_READY)){
+        return 1;
+    }
+    return 0;
+}
 
+//gap_ms = 0 : gap is t3.5 of the baud rate, gap takes effect by the next _DUI_Communication_Enable() as the baud rate
+//mode takes effect at once
+t_uint8 _DUI_Set_Comm_Module_Frame_End_Mode(t_uint8 uart_module, t_uint8 mode, t_uint16 gap_ms){
+    if((uart_module > One_Wire_Module) || (mode >= Frame_End_Mode_Number)){
+        return Func_Failure;
+    }
+    UART_Module_Frame_End_Mode[uart_module] = mode;
+    UART_Module_Frame_End_Gap_MS[uart_module] = gap_ms;
+    return Func_Success;
+}
+
+//bytes can be sent by _DUI_Communication_Send_Bytes() now
+t_uint16 _DUI_Get_Comm_Module_Transmit_Free_Size(t_uint8 uart_module){
     switch(uart_module){
         case Uart_RS485_Module:
-            if(UART_Module_1_Receiving_Data_Index > max_Length){
-                length = max_Length;
-            }else{
-                 length = UART_Module_1_Receiving_Data_Index;
-           }
-            for(i = 0; i < length; i++){
-                out_Array_ptr[i] = UART_Module_1_Receiving_Data[i];
-            }
-            *out_Array_length = length;
-            g_UART_Module_Status_Flag &= ~Detect_UART_M1_End_Frame;
-            clear_Comm_Receive_Buffer(Uart_RS485_Module);
-            break;
+            return _Device_Uart_Module_1_Get_Transmit_Free_Size();
         case One_Wire_Module:
-            if(UART_Module_2_Receiving_Data_Index > max_Length){
-                length = max_Length;
-            }else{
-                 length = UART_Module_2_Receiving_Data_Index;
-           }
-            for(i = 0; i < length; i++){
-                out_Array_ptr[i] = UART_Module_2_Receiving_Data[i];
-                UART_Module_2_Receiving_Data[i] = 0;
-            }
-            *out_Array_length = length;
-            UART_Module_2_Receiving_Data_Index = 0;
-            g_UART_Module_Status_Flag &= ~Detect_UART_M2_End_Frame;
-            clear_Comm_Receive_Buffer(One_Wire_Module);
-            break;
+            return _Device_Uart_Module_2_Get_Transmit_Free_Size();
         default:
             break;
     }
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// transparent bridge between CDC and one module
+////////////////////////////////////////////////////////////////////////////////
+//received bytes are ended by UART_Bridge_Chunk_Length or UART_Bridge_Gap_MS instead of UART_Module_Frame_End_Mode,
+//the module is enabled before, no transaction can be running
+t_uint8 _DUI_Set_Comm_Module_Bridge(t_uint8 uart_module, t_uint8 enable){
+    if(uart_module > One_Wire_Module){
+        return Func_Failure;
+    }
+    if(enable == 0){
+        if(Comm_Bridge_Module == uart_module){
+            Comm_Bridge_Module = Comm_Bridge_Off;
+            UART_Module_Frame_End_Gap_Ticks[uart_module] = get_Frame_End_Gap_Ticks(uart_module);
+        }
+        return Func_Success;
+    }
+    if((Comm_Transaction_State != Comm_Transaction_Idle) || ((Comm_Bridge_Module != Comm_Bridge_Off) && (Comm_Bridge_Module != uart_module))){
+        return Func_Failure;
+    }
+    Comm_Bridge_Module = uart_module;
+    UART_Module_Frame_End_Gap_Ticks[uart_module] = get_Frame_End_Gap_Ticks(uart_module);
+    return Func_Success;
+}
+
+//return the bridged module or Comm_Bridge_Off
+t_uint8 _DUI_Get_Comm_Module_Bridge(void){
+    return Comm_Bridge_Module;
+}
+
+//consumer of the bridge, bytes are sent from the receiving ring without copying,
+//return the first byte and length of the received bytes up to max_Length and the end of ring,
+//the bytes are kept until _DUI_Release_Comm_Module_Bridge_Data()
+t_uint8 *_DUI_Get_Comm_Module_Bridge_Data(t_uint8 uart_module, t_uint16 *out_Array_length, t_uint16 max_Length){
+    UART_Receiving_Ring *ring;
+    t_uint16 length;
+    t_uint16 tail;
+
+    *out_Array_length = 0;
+    if(uart_module > One_Wire_Module){
+        return 0;
+    }
+    ring = &UART_Module_Receiving_Ring[uart_module];
+    tail = ring->Tail & UART_Receiving_Ring_Mask;
+    length = ring->Frame_End - ring->Tail;
+    if(length > max_Length){
+        length = max_Length;
+    }
+    if(length > (UART_Receiving_Ring_Size - tail)){
+        length = UART_Receiving_Ring_Size - tail;
+    }
+    *out_Array_length = length;
+    return &(ring->Data[tail]);
+}
+//the bytes are sent, the receiving interrupt may write them again
+void _DUI_Release_Comm_Module_Bridge_Data(t_uint8 uart_module, t_uint16 length){
+    if(uart_module > One_Wire_Module){
+        return;
+    }
+    UART_Module_Receiving_Ring[uart_module].Tail += length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// transmit-and-await-reply transaction
+////////////////////////////////////////////////////////////////////////////////
+//calling by Timer B when the attempt is timeout
+static void Comm_Transaction_Timeout_By_Timer(){
+    Comm_Transaction_Timeout_Flag = 1;
+}
+//calling in the UART interrupt when the payload is sent, timeout of the attempt starts from here
+static void Comm_Transaction_Transmit_Done(){
+    if(Comm_Transaction_Transmitting == 0){
+        return;
+    }
+    Comm_Transaction_Transmitting = 0;
+    //+1 period, the first period after setting is not a whole one
+    _Device_Set_TimerB_Interrupt_Timer_Calling_Function_With_Delay_And_Exec(Uart_Transaction_Timeout_Fun_Index, Comm_Transaction_Timeout_By_Timer,
+                                                                            ((Comm_Transaction_Timeout_MS + Timer_B_Polling_Base_MS - 1) / Timer_B_Polling_Base_MS) + 1);
+}
+
+//bytes received before are dropped, they are not the reply
+static t_uint8 Start_Comm_Transaction_Attempt(){
+    UART_Receiving_Ring *ring;
+    t_uint16 head;
+
+    ring = &UART_Module_Receiving_Ring[Comm_Transaction_Module];
+    //no frame gap timer writes Frame_End after this, Receiving_Frame_Fun_Index is the same as the module
+    _Device_Remove_TimerB_Interrupt_Timer_Calling_Function(Comm_Transaction_Module);
+    head = ring->Head;
+    ring->Frame_End = head;
+    ring->Tail = head;
+    Comm_Transaction_Timeout_Flag = 0;
+    Comm_Transaction_Attempts++;
+    //timeout is armed by Comm_Transaction_Transmit_Done(), time on the wire is not counted
+    Comm_Transaction_Transmitting = 1;
+    _DUI_Set_Communication_Transmit_Done_Function(Comm_Transaction_Module, Comm_Transaction_Transmit_Done);
+    if(_DUI_Communication_Send_Bytes(Comm_Transaction_Module, Comm_Transaction_Payload, Comm_Transaction_Payload_Length) == Func_Failure){
+        Comm_Transaction_Transmitting = 0;
+        return Func_Failure;
+    }
+    return Func_Success;
+}
+
+//the reply is still in the receiving ring when the done function is called, it may start the next transaction
+static void Finish_Comm_Transaction(t_uint8 status){
+    Comm_Transaction_Transmitting = 0;
+    _Device_Remove_TimerB_Interrupt_Timer_Calling_Function(Uart_Transaction_Timeout_Fun_Index);
+    Comm_Transaction_State = Comm_Transaction_Idle;
+    Comm_Transaction_Done_ptr_fuc(status);
+}
+
+//for the reply rejected by the done function, return Func_Failure if no attempt is left or TX ring is full
+static t_uint8 Retry_Comm_Transaction(){
+    if(Comm_Transaction_Attempts > Comm_Transaction_Retries){
+        return Func_Failure;
+    }
+    Comm_Transaction_State = Comm_Transaction_Waiting_Reply;
+    if(Start_Comm_Transaction_Attempt() == Func_Failure){
+        Comm_Transaction_State = Comm_Transaction_Idle;
+        return Func_Failure;
+    }
+    return Func_Success;
+}
+
+static t_uint8 Start_Comm_Transaction(t_uint8 uart_module, t_uint16 timeout_ms, t_uint8 retries, t_uint16 expected_length, t_uint8 frame_end_mode,
+                                      t_uint8 *payload, t_uint16 length, void (*done_fun)(t_uint8 status)){
+    t_uint16 i;
+
+    if((Comm_Transaction_State != Comm_Transaction_Idle) || (uart_module > One_Wire_Module) || (timeout_ms == 0) ||
+       (Comm_Bridge_Module != Comm_Bridge_Off) || (length == 0) || (length > Comm_Transaction_Max_Payload_Length) ||
+       ((frame_end_mode >= Frame_End_Mode_Number) && (frame_end_mode != Frame_End_Mode_Of_Module))){
+        return Func_Failure;
+    }
+    for(i = 0; i < length; i++){
+        Comm_Transaction_Payload[i] = payload[i];
+    }
+    Comm_Transaction_Payload_Length = length;
+    Comm_Transaction_Module = uart_module;
+    Comm_Transaction_Timeout_MS = timeout_ms;
+    Comm_Transaction_Retries = retries;
+    Comm_Transaction_Expected_Length = expected_length;
+    Comm_Transaction_Frame_End_Mode = frame_end_mode;
+    Comm_Transaction_Done_ptr_fuc = done_fun;
+    Comm_Transaction_Attempts = 0;
+    Comm_Transaction_Start_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+    Comm_Transaction_State = Comm_Transaction_Waiting_Reply;
+    if(Start_Comm_Transaction_Attempt() == Func_Failure){
+        Comm_Transaction_State = Comm_Transaction_Idle;
+        return Func_Failure;
+    }
+    return Func_Success;
+}
+
+//response is status, attempts, elapsed time and the reply drained from the receiving ring
+static void Send_Comm_Transaction_Response(t_uint8 status){
+    t_uint8 header[6];
+    t_uint32 elapsed;
+
+    elapsed = _Device_Get_TimerA_Time_Stamp() - Comm_Transaction_Start_Time_Stamp;
+    header[0] = status;
+    header[1] = Comm_Transaction_Attempts;
+    header[2] = elapsed;
+    header[3] = elapsed >> 8;
+    header[4] = elapsed >> 16;
+    header[5] = elapsed >> 24;
+    if((status == Comm_Transaction_OK) || (status == Comm_Transaction_Short_Reply)){
+        _DUI_CDC_Transmitting_Async_UART_Frame_Response(Comm_Transaction_Response_Cmd, Comm_Transaction_Response_Tag, header, 6, Comm_Transaction_Module);
+    }else{
+        _DUI_CDC_Transmitting_Async_Response(Comm_Transaction_Response_Cmd, Comm_Transaction_Response_Tag, header, 6);
+    }
+}
+
+// timeout_ms : for each attempt, from the end of transmitting (transmit done) to the end of the reply
+// retries : attempts after the first one, for timeout or short reply
+// expected_length : reply ends at this length, 0 = by frame end of the module
+// frame_end_mode : Receiving_Frame_End_Mode for the reply, Frame_End_Mode_Of_Module = setting of the module
+// return Func_Failure if a transaction is running, parameters are not valid or TX ring is full
+t_uint8 _DUI_Comm_Transaction_Start(t_uint8 uart_module, t_uint16 timeout_ms, t_uint8 retries, t_uint16 expected_length, t_uint8 frame_end_mode,
+                                    t_uint8 *payload, t_uint16 length, t_uint8 response_cmd){
+    if(Start_Comm_Transaction(uart_module, timeout_ms, retries, expected_length, frame_end_mode,
+                              payload, length, Send_Comm_Transaction_Response) == Func_Failure){
+        return Func_Failure;
+    }
+    Comm_Transaction_Response_Cmd = response_cmd;
+    Comm_Transaction_Response_Tag = _DUI_CDC_Get_Response_Tag();
+    return Func_Success;
+}
+
+void _DUI_Comm_Transaction_Process(void){
+    UART_Receiving_Ring *ring;
+    t_uint8 status;
+
+    if(Comm_Transaction_State != Comm_Transaction_Waiting_Reply){
+        return;
+    }
+    ring = &UART_Module_Receiving_Ring[Comm_Transaction_Module];
+    if(ring->Frame_End != ring->Tail){
+        if((Comm_Transaction_Expected_Length == 0) || ((t_uint16)(ring->Frame_End - ring->Tail) >= Comm_Transaction_Expected_Length)){
+            Finish_Comm_Transaction(Comm_Transaction_OK);
+            return;
+        }
+        status = Comm_Transaction_Short_Reply;
+    }else if(Comm_Transaction_Timeout_Flag){
+        status = Comm_Transaction_Timeout;
+    }else{
+        return;
+    }
+    if(Comm_Transaction_Attempts > Comm_Transaction_Retries){
+        Finish_Comm_Transaction(status);
+        return;
+    }
+    if(Start_Comm_Transaction_Attempt() == Func_Failure){
+        Finish_Comm_Transaction(Comm_Transaction_Transmit_Failure);
+    }
+}
+
+// 1 if _DUI_Comm_Transaction_Process() has something to do, main() does not sleep
+t_uint8 _DUI_Comm_Transaction_Is_Ready(void){
+    UART_Receiving_Ring *ring;
+
+    if(Comm_Transaction_State != Comm_Transaction_Waiting_Reply){
+        return 0;
+    }
+    ring = &UART_Module_Receiving_Ring[Comm_Transaction_Module];
+    return ((ring->Frame_End != ring->Tail) || Comm_Transaction_Timeout_Flag);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Modbus RTU master, on the transaction of RS485 module
+////////////////////////////////////////////////////////////////////////////////
+//slave address, function, address and quantity (or value), Hi-byte first as Modbus
+static t_uint16 Put_Modbus_Request_Header(t_uint8 *frame, t_uint8 function, t_uint16 address, t_uint16 quantity){
+    frame[0] = Modbus_Slave_Address;
+    frame[1] = function;
+    frame[2] = address >> 8;
+    frame[3] = address & 0x00ff;
+    frame[4] = quantity >> 8;
+    frame[5] = quantity & 0x00ff;
+    return 6;
+}
+
+//CRC is Lo-byte first
+static t_uint16 Put_Modbus_CRC(t_uint8 *frame, t_uint16 length){
+    t_uint16 crc;
+
+    crc = usMBCRC16(frame, length);
+    frame[length] = crc & 0x00ff;
+    frame[length + 1] = crc >> 8;
+    return length + 2;
+}
+
+//request is still in Comm_Transaction_Payload, CRC of the whole reply with its CRC is 0
+static t_uint8 check_Modbus_Reply(t_uint16 length){
+    t_uint8 i;
+
+    if((length < 5) || (usMBCRC16(Modbus_Reply, length) != 0)){
+        return Comm_Transaction_CRC_Error;
+    }
+    if((Modbus_Reply[0] != Modbus_Slave_Address) ||
+       ((Modbus_Reply[1] & ~Modbus_Exception_Function_Flag) != Comm_Transaction_Payload[1])){
+        return Comm_Transaction_Bad_Reply;
+    }
+    if(Modbus_Reply[1] & Modbus_Exception_Function_Flag){
+        return (length == 5) ? Comm_Transaction_Exception : Comm_Transaction_Bad_Reply;
+    }
+    if(Modbus_Read_Plan_Entries){
+        //byte count and registers
+        if((Modbus_Reply[2] != (Comm_Transaction_Payload[5] * 2)) || (length != (Modbus_Reply[2] + 5))){
+            return Comm_Transaction_Bad_Reply;
+        }
+        return Comm_Transaction_OK;
+    }
+    //write reply echoes address and value (or quantity)
+    if(length != 8){
+        return Comm_Transaction_Bad_Reply;
+    }
+    for(i = 2; i < 6; i++){
+        if(Modbus_Reply[i] != Comm_Transaction_Payload[i]){
+            return Comm_Transaction_Bad_Reply;
+        }
+    }
+    return Comm_Transaction_OK;
 }
 
+//response is status, requests done, exception code, attempts, elapsed time and registers read
+static void Send_Modbus_Response(t_uint8 status, t_uint8 exception_code){
+    t_uint32 elapsed;
+
+    elapsed = _Device_Get_TimerA_Time_Stamp() - Modbus_Start_Time_Stamp;
+    Modbus_Response[0] = status;
+    Modbus_Response[1] = Modbus_Read_Plan_Index;
+    Modbus_Response[2] = exception_code;
+    Modbus_Response[3] = Modbus_Attempts;
+    Modbus_Response[4] = elapsed;
+    Modbus_Response[5] = elapsed >> 8;
+    Modbus_Response[6] = elapsed >> 16;
+    Modbus_Response[7] = elapsed >> 24;
+    _DUI_CDC_Transmitting_Async_Response(Modbus_Response_Cmd, Modbus_Response_Tag, Modbus_Response, Modbus_Response_Length);
+}
+
+static void Modbus_Transaction_Done(t_uint8 status);
+
+static t_uint8 Start_Modbus_Read_Request(){
+    Modbus_Read_Plan_Entry *entry;
+    t_uint8 frame[8];
+    t_uint16 length;
+
+    entry = &Modbus_Read_Plan[Modbus_Read_Plan_Index];
+    length = Put_Modbus_Request_Header(frame, entry->Function, entry->Start_Address, entry->Quantity);
+    length = Put_Modbus_CRC(frame, length);
+    return Start_Comm_Transaction(Uart_RS485_Module, Modbus_Timeout_MS, Modbus_Retries, 0, Frame_End_By_Gap,
+                                  frame, length, Modbus_Transaction_Done);
+}
+
+//calling by Finish_Comm_Transaction(), reply with CRC error or not for the request is retried as timeout
+static void Modbus_Transaction_Done(t_uint8 status){
+    t_uint16 length;
+    t_uint16 i;
+
+    if(status == Comm_Transaction_OK){
+        _DUI_Get_Receiving_Data_To_Array(Uart_RS485_Module, Modbus_Reply, &length, Modbus_Max_Reply_Length);
+        status = check_Modbus_Reply(length);
+        if((status == Comm_Transaction_CRC_Error) || (status == Comm_Transaction_Bad_Reply)){
+            if(Retry_Comm_Transaction() == Func_Success){
+                return;
+            }
+        }
+    }
+    Modbus_Attempts += Comm_Transaction_Attempts;
+    if(status != Comm_Transaction_OK){
+        Send_Modbus_Response(status, (status == Comm_Transaction_Exception) ? Modbus_Reply[2] : 0);
+        return;
+    }
+    //registers are Lo-byte first as the other responses
+    if(Modbus_Read_Plan_Entries){
+        for(i = 3; i < (Modbus_Reply[2] + 3); i += 2){
+            Modbus_Response[Modbus_Response_Length++] = Modbus_Reply[i + 1];
+            Modbus_Response[Modbus_Response_Length++] = Modbus_Reply[i];
+        }
+    }
+    Modbus_Read_Plan_Index++;
+    if(Modbus_Read_Plan_Index >= Modbus_Read_Plan_Entries){
+        Send_Modbus_Response(Comm_Transaction_OK, 0);
+        return;
+    }
+    if(Start_Modbus_Read_Request() == Func_Failure){
+        Send_Modbus_Response(Comm_Transaction_Transmit_Failure, 0);
+    }
+}
+
+static t_uint8 Start_Modbus(t_uint8 slave_address, t_uint16 timeout_ms, t_uint8 retries, t_uint8 response_cmd){
+    if((Comm_Transaction_State != Comm_Transaction_Idle) || (slave_address == 0) || (slave_address > Modbus_Max_Slave_Address)){
+        return Func_Failure;
+    }
+    Modbus_Slave_Address = slave_address;
+    Modbus_Timeout_MS = timeout_ms;
+    Modbus_Retries = retries;
+    Modbus_Response_Cmd = response_cmd;
+    Modbus_Response_Tag = _DUI_CDC_Get_Response_Tag();
+    Modbus_Read_Plan_Index = 0;
+    Modbus_Attempts = 0;
+    Modbus_Response_Length = Modbus_Response_Header_Length;
+    Modbus_Start_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+    return Func_Success;
+}
+
+// read plan : requests of function 03 / 04 to the slave one by one in the device, registers are sent back in one response
+// plan : entries of Modbus_Read_Plan_Entry_Size bytes, function, start address(Lo-byte), (Hi-byte), quantity
+// timeout_ms, retries : for each request, as _DUI_Comm_Transaction_Start()
+// return Func_Failure if a transaction is running, parameters are not valid or TX ring is full
+t_uint8 _DUI_Modbus_Read_Plan_Start(t_uint8 slave_address, t_uint16 timeout_ms, t_uint8 retries, t_uint8 *plan, t_uint8 entries, t_uint8 response_cmd){
+    t_uint8 i;
+    t_uint16 registers;
+
+    if((entries == 0) || (entries > Modbus_Max_Read_Plan_Entries) ||
+       (Start_Modbus(slave_address, timeout_ms, retries, response_cmd) == Func_Failure)){
+        return Func_Failure;
+    }
+    registers = 0;
+    for(i = 0; i < entries; i++, plan += Modbus_Read_Plan_Entry_Size){
+        if(((plan[0] != Modbus_Function_Read_Holding_Registers) && (plan[0] != Modbus_Function_Read_Input_Registers)) ||
+           (plan[3] == 0) || (plan[3] > Modbus_Max_Read_Quantity)){
+            return Func_Failure;
+        }
+        Modbus_Read_Plan[i].Function = plan[0];
+        Modbus_Read_Plan[i].Start_Address = plan[2];
+        Modbus_Read_Plan[i].Start_Address = (Modbus_Read_Plan[i].Start_Address << 8) + plan[1];
+        Modbus_Read_Plan[i].Quantity = plan[3];
+        registers += plan[3];
+    }
+    if(registers > Modbus_Max_Read_Plan_Registers){
+        return Func_Failure;
+    }
+    Modbus_Read_Plan_Entries = entries;
+    return Start_Modbus_Read_Request();
+}
+
+// function : 06 with 1 register or 16 with 1 ~ Modbus_Max_Write_Quantity registers
+// values : registers to write, Lo-byte first
+// return Func_Failure if a transaction is running, parameters are not valid or TX ring is full
+t_uint8 _DUI_Modbus_Write_Start(t_uint8 slave_address, t_uint16 timeout_ms, t_uint8 retries, t_uint8 function, t_uint16 start_address,
+                                t_uint8 *values, t_uint8 quantity, t_uint8 response_cmd){
+    t_uint8 frame[Comm_Transaction_Max_Payload_Length];
+    t_uint16 length;
+    t_uint16 value;
+    t_uint8 i;
+
+    if((quantity == 0) ||
+       ((function == Modbus_Function_Write_Single_Register) && (quantity != 1)) ||
+       ((function == Modbus_Function_Write_Multiple_Registers) && (quantity > Modbus_Max_Write_Quantity)) ||
+       ((function != Modbus_Function_Write_Single_Register) && (function != Modbus_Function_Write_Multiple_Registers)) ||
+       (Start_Modbus(slave_address, timeout_ms, retries, response_cmd) == Func_Failure)){
+        return Func_Failure;
+    }
+    Modbus_Read_Plan_Entries = 0;
+    if(function == Modbus_Function_Write_Single_Register){
+        value = values[1];
+        value = (value << 8) + values[0];
+        length = Put_Modbus_Request_Header(frame, function, start_address, value);
+    }else{
+        length = Put_Modbus_Request_Header(frame, function, start_address, quantity);
+        frame[length++] = quantity * 2;
+        for(i = 0; i < quantity; i++){
+            frame[length++] = values[(i * 2) + 1];
+            frame[length++] = values[i * 2];
+        }
+    }
+    length = Put_Modbus_CRC(frame, length);
+    return Start_Comm_Transaction(Uart_RS485_Module, timeout_ms, retries, 0, Frame_End_By_Gap,
+                                  frame, length, Modbus_Transaction_Done);
+}
@@ -47,15 +47,61 @@ enum Receiving_Fun_Index_For_Detect_Timer{
     Uart_RS485_Module_Receiving_Frame_Fun_Index,     // 0
     One_Wire_Module_Receiving_Frame_Fun_Index        // 1
 };
+
+//frame is also ended by the gap of silence in every mode
+enum Receiving_Frame_End_Mode{
+    Frame_End_By_Gap,                   // 0 : gap only (default)
+    Frame_End_By_LEV_Length,            // 1 : LEV packet, 0x3A leading code and length field
+    Frame_End_By_End_Code,              // 2 : 0x0D 0x0A end code
+    Frame_End_By_One_Wire_End_Code,     // 3 : ONE_WIRE_EndCheckCode 0x70F7
+    Frame_End_Mode_Number
+};
+#define Frame_End_Mode_Of_Module                (0xFF)  //transaction keeps the mode of Cmd_UART_Set_Frame_End_Mode
+
+//status of transmit-and-await-reply transaction
+enum Comm_Transaction_Status{
+    Comm_Transaction_OK,                // 0 : reply is received
+    Comm_Transaction_Timeout,           // 1 : no reply in the last attempt
+    Comm_Transaction_Short_Reply,       // 2 : frame ended by gap before the expected length in the last attempt
+    Comm_Transaction_Transmit_Failure,  // 3 : TX ring is full
+    Comm_Transaction_CRC_Error,         // 4 : Modbus reply with CRC error in the last attempt
+    Comm_Transaction_Bad_Reply,         // 5 : Modbus reply not for the request in the last attempt
+    Comm_Transaction_Exception          // 6 : Modbus exception reply
+};
+#define Uart_Transaction_Timeout_Fun_Index      3   //Timer B calling function, 0, 1 receiving frame detection, 2 charger ID settle
+#define Comm_Transaction_Max_Payload_Length     32
+
+//Modbus RTU master on RS485 module, frames end by the gap of the module (t3.5 by default)
+#define Modbus_Function_Read_Holding_Registers      (0x03)
+#define Modbus_Function_Read_Input_Registers        (0x04)
+#define Modbus_Function_Write_Single_Register       (0x06)
+#define Modbus_Function_Write_Multiple_Registers    (0x10)
+#define Modbus_Exception_Function_Flag              (0x80)
+#define Modbus_Max_Slave_Address                247     //0 broadcast is not supported, no reply
+#define Modbus_Max_Read_Plan_Entries            6
+#define Modbus_Read_Plan_Entry_Size             4       //function, start address(Lo, Hi), quantity
+#define Modbus_Max_Read_Quantity                32      //registers of a read request
+#define Modbus_Max_Read_Plan_Registers          64      //registers of a read plan
+#define Modbus_Max_Write_Quantity               11      //registers of function 16 in Comm_Transaction_Max_Payload_Length
+#define Modbus_Max_Reply_Length                 (5 + (Modbus_Max_Read_Quantity * 2))
+#define Modbus_Response_Header_Length           8
+
+//transparent bridge between CDC and one module, received bytes are sent to host in chunks of one USB packet
+#define Comm_Bridge_Off                         (0xFF)
+#define UART_Bridge_Chunk_Length                64      //USB_Receive_Max_Bytes_Per_Packet
+#define UART_Bridge_Gap_MS                      1       //silence to send a short chunk
 //==============================================================================
 // Global variables define
 //==============================================================================
 #define UART_RECEIVING_DATA_NOT_READY       0
 #define UART_RECEIVING_DATA_READY           1
 
-#define UratRXFrameEndGapTime	                50  // unit: 1ms
-#define UART_Receiving_Max_Data_Length          550 //(0xef)  //whole structure Length
-#define UART_Transmitting_Max_Data_Length       (0x1f)  //whole structure Length
+//gap of silence for frame end, Modbus t3.5 : 3.5 characters of 11 bits, fixed 1750us over 19200 baud
+#define UART_Frame_End_Gap_Char_Bits            (35UL * 11)     //x 0.1 bit
+#define UART_Frame_End_Gap_Fixed_Baud_Rate      19200
+#define UART_Frame_End_Gap_Fixed_US             1750
+#define UART_Receiving_Ring_Size                512 //bytes, power of 2
+#define UART_Receiving_Ring_Mask                (UART_Receiving_Ring_Size - 1)
 
 #define Default_BAUD_RATE                       9600
 
@@ -63,8 +109,8 @@ enum Receiving_Fun_Index_For_Detect_Timer{
 /* Driver g_UART_Module_Status_Flag Control Bits */
 /* For g_UART_Module_Status_Flag ; unsigned int */
 //Low byte
-#define Detect_UART_M1_End_Frame            (0x0001)    //
-#define Detect_UART_M2_End_Frame            (0x0002)    //
+//#define Detect_UART_M1_End_Frame            (0x0001)    //
+//#define Detect_UART_M2_End_Frame            (0x0002)    //
 #define Detect_UART_M1_End_Code             (0x0004)    //
 #define Detect_UART_M2_End_Code             (0x0008)    //
 //#define UART_RX_PrecedingCode_Find      (0x0010)    //
@@ -91,9 +137,27 @@ enum Receiving_Fun_Index_For_Detect_Timer{
 void _DUI_Set_Communication_BAUD_RATE(t_uint32 baud_rate);
 void _DUI_Communication_Enable(t_uint8 uart_module);
 void _DUI_Communication_Disable(t_uint8 uart_module);
-void _DUI_Communication_Send_Bytes(t_uint8 uart_module, unsigned char *sendData, unsigned int length);
+t_uint8 _DUI_Communication_Send_Bytes(t_uint8 uart_module, unsigned char *sendData, unsigned int length);
+void _DUI_Set_Communication_Transmit_Done_Function(t_uint8 uart_module, void (*transmit_done_fun)(void));
 t_uint8 _DUI_Is_Comm_Module_Receiving_Data_Ready(t_uint8 uart_module);
 void _DUI_Get_Receiving_Data_To_Array(t_uint8 uart_module, t_uint8 *out_Array_ptr, t_uint16 *out_Array_length, t_uint16 max_Length);
+t_uint16 _DUI_Get_Comm_Module_Receiving_Overrun_Count(t_uint8 uart_module);
+t_uint8 _DUI_Is_Comm_Module_Receiving_Data_Pending(void);
+t_uint8 _DUI_Set_Comm_Module_Frame_End_Mode(t_uint8 uart_module, t_uint8 mode, t_uint16 gap_ms);
+t_uint16 _DUI_Get_Comm_Module_Transmit_Free_Size(t_uint8 uart_module);
+t_uint8 _DUI_Set_Comm_Module_Bridge(t_uint8 uart_module, t_uint8 enable);
+t_uint8 _DUI_Get_Comm_Module_Bridge(void);
+t_uint8 *_DUI_Get_Comm_Module_Bridge_Data(t_uint8 uart_module, t_uint16 *out_Array_length, t_uint16 max_Length);
+void _DUI_Release_Comm_Module_Bridge_Data(t_uint8 uart_module, t_uint16 length);
+
+t_uint8 _DUI_Comm_Transaction_Start(t_uint8 uart_module, t_uint16 timeout_ms, t_uint8 retries, t_uint16 expected_length, t_uint8 frame_end_mode,
+                                    t_uint8 *payload, t_uint16 length, t_uint8 response_cmd);
+void _DUI_Comm_Transaction_Process(void);
+t_uint8 _DUI_Comm_Transaction_Is_Ready(void);
+
+t_uint8 _DUI_Modbus_Read_Plan_Start(t_uint8 slave_address, t_uint16 timeout_ms, t_uint8 retries, t_uint8 *plan, t_uint8 entries, t_uint8 response_cmd);
+t_uint8 _DUI_Modbus_Write_Start(t_uint8 slave_address, t_uint16 timeout_ms, t_uint8 retries, t_uint8 function, t_uint16 start_address,
+                                t_uint8 *values, t_uint8 quantity, t_uint8 response_cmd);
 
 
 // For DUI UART Setup  : (section stop)
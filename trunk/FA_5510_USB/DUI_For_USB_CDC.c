@@ -63,20 +63,37 @@
 //#define SlaveAddressCode            (0xA6)
 #define LeadingCode                 (0x3A)
 #define SlaveAddressCode            (0xA6)
+#define SequenceSlaveAddressCode    (0xA7)  //first data byte is sequence ID, echoed by response
 #define EndingCode1                 (0x0D)
 #define EndingCode2                 (0x0A)
 
 #define Respond_Error_Check_Code    (0xF3)
 #define Respond_Accept_Check_Code   (0xF0)
 
-#define Comm_Receive_Buffer_Size        (CDC_Receiving_Max_Data_Length * 2)
+#define Comm_Receive_Buffer_Size        (128)   //ring buffer, must be power of 2 and >= 2 USB packets(64 bytes)
+#define Comm_Receive_Buffer_Mask        (Comm_Receive_Buffer_Size - 1)
+#define Comm_Receive_Packet_Queue_Size  (8)     //parsed commands waiting for exec, must be power of 2, the others wait in ring buffer
+                                                //7 are pipelined, the empty slot tells full from empty
+#define Comm_Receive_Packet_Queue_Mask  (Comm_Receive_Packet_Queue_Size - 1)
 #define Comm_Transmitting_Buffer_Size   (CDC_Transmitting_Max_Data_Length + 15)
+#define CDC_Bridge_Send_Max_Length      (2 * USB_Receive_Max_Bytes_Per_Packet)
+#define CDC_Bridge_Exit_Hold_MS         (2)     //bytes of a partial Cmd_UART_Bridge_Exit are held at most for 2 USB frames
+#define CDC_Bridge_Exit_Hold_Fun_Index  (4)     //Timer B calling function, 0 ~ 3 are used by DUI_For_UART and charger ID settle
+
+#define CDC_Command_Opcode_Base         (0x70)  //CDC_Command_Index covers cmd 0x70 ~ 0xEF
+#define CDC_Command_Opcode_Range        (0x80)
+#define CDC_Command_Not_Found           (0x00)  //in CDC_Command_Index, others are CDC_Command_Table index + 1
+/* CDC_Command_Entry Attribute */
+#define CDC_Cmd_Attr_Accept_Respond     (0x00)  //Respond_Accept_Check_Code is sent after handler
+#define CDC_Cmd_Attr_Data_Respond       (0x01)  //handler sends data response itself
+#define CDC_Cmd_Attr_Async              (0x02)  //measurement, main() sends data response when done
 
 /* Driver g_Usb_Cdc_Status_FLAG Control Bits */
 /* For g_Usb_Cdc_Status_FLAG ; unsigned int */
 //Low byte
 #define CDC_RX_Packet_Found                     (0x0001)    //
 #define CDC_RX_Packet_Check_True                 (0x0002)    //
+#define CDC_TX_With_Sequence                    (0x0004)    //response with SequenceSlaveAddressCode and sequence ID
 //#define CDC_RX_Packet_Check_True            (0x0004)    //for CRC or checkSum Flag
 //#define UART_RX_FRAME_DONE              (0x0008)    //
 //#define UART_RX_PrecedingCode_Find      (0x0010)    //
@@ -99,6 +116,21 @@
 //==============================================================================
 // Private Enum
 //==============================================================================
+//=======USB Receiving Frame Parsing States================================
+typedef enum{
+    CDC_Parse_Wait_LeadingCode = 0,
+    CDC_Parse_Wait_SlaveAddress,
+    CDC_Parse_Command,
+    CDC_Parse_Length_Low,
+    CDC_Parse_Length_High,
+    CDC_Parse_Sequence,
+    CDC_Parse_Data,
+    CDC_Parse_CheckSum_Low,
+    CDC_Parse_CheckSum_High,
+    CDC_Parse_EndingCode1,
+    CDC_Parse_EndingCode2
+}CDC_Parsing_State;
+
 //=======USB Receiving From PC Data Structure===============================
 typedef struct{
     //static char cStart = 0X3A;	    //_lr
@@ -111,6 +143,7 @@ typedef struct{
     unsigned char LRCDataHigh;	        //checkSum16 High byte, included slave address, command, length and data.
     //static char cEND1= 0X0D;	        //r 1
     //static char cEND1= 0X0A;	        //r 2
+    unsigned char SequenceID;           //only for SequenceSlaveAddressCode, not included in DataBuf and DataLenExpected
 }USB_Receiving_Protocol_Packet;
 
 //========USB Transmitting To PC  Data Structure===========================
@@ -128,6 +161,25 @@ typedef struct{
 }USB_Transmitting_Protocol_Packet;
 //
 
+//========USB Command Table Structure=====================================
+// handler returns Func_Success or Func_Failure
+typedef t_uint8 (*CDC_Command_Handler)(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter);
+
+typedef struct{
+    t_uint8 Command;
+    t_uint8 Min_Data_Length;            //payload length, sequence ID is not included
+    t_uint8 Max_Data_Length;
+    t_uint8 Attribute;                  //CDC_Cmd_Attr_xxx
+    CDC_Command_Handler Handler;
+    t_uint16 Parameter;                 //passed to handler, for commands sharing one handler
+}CDC_Command_Entry;
+
+typedef struct{
+    t_uint16 Hit_Count;
+    t_uint16 Error_Count;
+    t_uint32 Latency;                   //accumulated Timer A counts from dispatching to response
+}CDC_Command_Statistics;
+
 //==============================================================================
 // Public variables
 //==============================================================================
@@ -136,120 +188,348 @@ t_uint16 g_Usb_Cdc_Status_FLAG;
 // Private variables
 //==============================================================================
 t_uint8 Comm_Receive_Buffer[Comm_Receive_Buffer_Size];
-t_uint16 Comm_Receive_Buffer_Index;
+__IO t_uint16 Comm_Receive_Buffer_Head;     //written by USB receiving (interrupt)
+__IO t_uint16 Comm_Receive_Buffer_Tail;     //written by parsing (main loop)
+CDC_Parsing_State Comm_Parsing_State;
+t_uint16 Comm_Parsing_Data_Index;
+t_uint16 Comm_Parsing_DataLength;
+t_uint16 Comm_Parsing_CheckSum;
+USB_Receiving_Protocol_Packet Comm_Receive_Packet_Queue[Comm_Receive_Packet_Queue_Size];
+t_uint8 Comm_Receive_Packet_Queue_Head;
+t_uint8 Comm_Receive_Packet_Queue_Tail;
+t_uint8 Comm_Transmitting_Sequence;
+t_uint8 CDC_Command_Async_Slot;             //latency slot + 1 of the async cmd in CDC_Command_Dispatch(), 0 = none
 t_uint8 Comm_Transmitting_Buffer[Comm_Transmitting_Buffer_Size];
 t_uint8 Comm_Temp_Transmitting_Data_Buffer[CDC_Transmitting_Max_Data_Length];
-USB_Receiving_Protocol_Packet receiving_Data_Packet;
+USB_Receiving_Protocol_Packet *receiving_Data_Packet;     //tail of Comm_Receive_Packet_Queue, not written until the next parsing
+t_uint16 CDC_Bridge_Sending_Length;                     //bytes of the module ring in USB sending, released when _Device_Is_USB_Sending() is 0
+t_uint8 CDC_Bridge_Exit_Pending;
+t_uint16 CDC_Bridge_Exit_Position;                      //Comm_Receive_Buffer index of the leading code of Cmd_UART_Bridge_Exit
+t_uint16 CDC_Bridge_Scan_Position;                      //Comm_Receive_Buffer index of the leading code being scanned
+__IO t_uint8 CDC_Bridge_Scan_Expired;                   //set by Timer B CDC_Bridge_Exit_Hold_MS after CDC_Bridge_Scan_Position
 //==============================================================================
 // Private function prototypes
 //==============================================================================
 //extern t_uint8 tdata[];
+static void init_CDC_Command_Statistics();
+static void account_CDC_Async_Command_Latency(t_uint16 response_tag);
 
 //==============================================================================
 // Private functions
 //==============================================================================
 static void clear_Comm_Receive_Buffer(){
-    t_uint16 i;
-    for(i = 0; i < Comm_Receive_Buffer_Size; i++){
-        Comm_Receive_Buffer[i] = 0;
+    Comm_Receive_Buffer_Head = 0;
+    Comm_Receive_Buffer_Tail = 0;
+    Comm_Parsing_State = CDC_Parse_Wait_LeadingCode;
+    Comm_Receive_Packet_Queue_Head = 0;
+    Comm_Receive_Packet_Queue_Tail = 0;
+}
+static void set_Value_To_Receive_Buffer(t_uint8 value){
+    t_uint16 next;
+    next = (Comm_Receive_Buffer_Head + 1) & Comm_Receive_Buffer_Mask;
+    if(next == Comm_Receive_Buffer_Tail){
+        return;     //buffer full, drop byte, the broken frame is discarded by checkSum or ending codes
     }
-    Comm_Receive_Buffer_Index = 0;
+    Comm_Receive_Buffer[Comm_Receive_Buffer_Head] = value;
+    Comm_Receive_Buffer_Head = next;
 }
-static void shift_Comm_Receive_Buffer_To_First_Position(t_uint16 start_shift_Index){
-    t_uint16 i;
-    t_uint16 idx;
-    if(Comm_Receive_Buffer_Index > Comm_Receive_Buffer_Size){
-        Comm_Receive_Buffer_Index = 0;
+////////////////////////////////////////////////////////////////////////////////
+// resync : a wrong byte may be the leading code of next frame
+static void restart_Parsing_State(t_uint8 value){
+    if(value == LeadingCode){
+        Comm_Parsing_State = CDC_Parse_Wait_SlaveAddress;
+    }else{
+        Comm_Parsing_State = CDC_Parse_Wait_LeadingCode;
     }
-    if(start_shift_Index >= Comm_Receive_Buffer_Index){
-        clear_Comm_Receive_Buffer();
-        return;
+}
+// one byte per call, return Func_Success when a whole frame passed checkSum16 and ending codes
+static t_uint8 Parsing_Receive_Byte_To_Packet(USB_Receiving_Protocol_Packet *packet, t_uint8 value){
+    switch(Comm_Parsing_State){
+        case CDC_Parse_Wait_LeadingCode:
+            restart_Parsing_State(value);
+            break;
+        case CDC_Parse_Wait_SlaveAddress:
+            if((value == SlaveAddressCode) || (value == SequenceSlaveAddressCode)){
+                packet->SlAdd = value;
+                Comm_Parsing_CheckSum = value;
+                Comm_Parsing_State = CDC_Parse_Command;
+            }else{
+                restart_Parsing_State(value);
+            }
+            break;
+        case CDC_Parse_Command:
+            packet->Command = value;
+            Comm_Parsing_CheckSum += value;
+            Comm_Parsing_State = CDC_Parse_Length_Low;
+            break;
+        case CDC_Parse_Length_Low:
+            packet->DataLenExpected_Low = value;
+            Comm_Parsing_CheckSum += value;
+            Comm_Parsing_State = CDC_Parse_Length_High;
+            break;
+        case CDC_Parse_Length_High:
+            packet->DataLenExpected_High = value;
+            Comm_Parsing_CheckSum += value;
+            Comm_Parsing_DataLength = value;
+            Comm_Parsing_DataLength = (Comm_Parsing_DataLength << 8) + packet->DataLenExpected_Low;
+            Comm_Parsing_Data_Index = 0;
+            if(packet->SlAdd == SequenceSlaveAddressCode){
+                //sequence ID is the first data byte
+                if((Comm_Parsing_DataLength == 0) || (Comm_Parsing_DataLength > (CDC_Receiving_Max_Data_Length + 1))){
+                    restart_Parsing_State(value);
+                    break;
+                }
+                Comm_Parsing_DataLength--;
+                packet->DataLenExpected_Low = Comm_Parsing_DataLength;
+                packet->DataLenExpected_High = Comm_Parsing_DataLength >> 8;
+                Comm_Parsing_State = CDC_Parse_Sequence;
+            }else if(Comm_Parsing_DataLength > CDC_Receiving_Max_Data_Length){
+                restart_Parsing_State(value);
+            }else if(Comm_Parsing_DataLength == 0){
+                Comm_Parsing_State = CDC_Parse_CheckSum_Low;
+            }else{
+                Comm_Parsing_State = CDC_Parse_Data;
+            }
+            break;
+        case CDC_Parse_Sequence:
+            packet->SequenceID = value;
+            Comm_Parsing_CheckSum += value;
+            if(Comm_Parsing_DataLength == 0){
+                Comm_Parsing_State = CDC_Parse_CheckSum_Low;
+            }else{
+                Comm_Parsing_State = CDC_Parse_Data;
+            }
+            break;
+        case CDC_Parse_Data:
+            packet->DataBuf[Comm_Parsing_Data_Index++] = value;
+            Comm_Parsing_CheckSum += value;
+            if(Comm_Parsing_Data_Index >= Comm_Parsing_DataLength){
+                Comm_Parsing_State = CDC_Parse_CheckSum_Low;
+            }
+            break;
+        case CDC_Parse_CheckSum_Low:
+            packet->LRCDataLow = value;
+            Comm_Parsing_State = CDC_Parse_CheckSum_High;
+            break;
+        case CDC_Parse_CheckSum_High:
+            packet->LRCDataHigh = value;
+            Comm_Parsing_State = CDC_Parse_EndingCode1;
+            break;
+        case CDC_Parse_EndingCode1:
+            if(value == EndingCode1){
+                Comm_Parsing_State = CDC_Parse_EndingCode2;
+            }else{
+                restart_Parsing_State(value);
+            }
+            break;
+        case CDC_Parse_EndingCode2:
+            if(value != EndingCode2){
+                restart_Parsing_State(value);
+                break;
+            }
+            Comm_Parsing_State = CDC_Parse_Wait_LeadingCode;
+            //check RX Packet with checkSum16
+            if((packet->LRCDataLow == (Comm_Parsing_CheckSum & 0x00ff)) &&
+               (packet->LRCDataHigh == (Comm_Parsing_CheckSum >> 8))){
+                return Func_Success;
+            }
+            break;
+        default:
+            Comm_Parsing_State = CDC_Parse_Wait_LeadingCode;
+            break;
     }
-    idx = 0;
-    for(i = start_shift_Index; i < Comm_Receive_Buffer_Index; i++){
-        Comm_Receive_Buffer[idx] = Comm_Receive_Buffer[start_shift_Index];
-        idx++;
+    return Func_Failure;
+}
+// parsing all received bytes to packet queue, the left bytes are kept in ring buffer while queue is full
+static void Parsing_Receive_Data_To_Packet_Queue(){
+    t_uint8 value;
+    t_uint8 next;
+    next = (Comm_Receive_Packet_Queue_Head + 1) & Comm_Receive_Packet_Queue_Mask;
+    while((next != Comm_Receive_Packet_Queue_Tail) && (Comm_Receive_Buffer_Tail != Comm_Receive_Buffer_Head)){
+        value = Comm_Receive_Buffer[Comm_Receive_Buffer_Tail];
+        Comm_Receive_Buffer_Tail = (Comm_Receive_Buffer_Tail + 1) & Comm_Receive_Buffer_Mask;
+        if(Parsing_Receive_Byte_To_Packet(&Comm_Receive_Packet_Queue[Comm_Receive_Packet_Queue_Head], value) == Func_Success){
+            Comm_Receive_Packet_Queue_Head = next;
+            next = (Comm_Receive_Packet_Queue_Head + 1) & Comm_Receive_Packet_Queue_Mask;
+        }
     }
-    Comm_Receive_Buffer_Index = idx;
 }
-static void set_Value_To_Receive_Buffer(t_uint8 value){
-    if(Comm_Receive_Buffer_Index >= Comm_Receive_Buffer_Size){
-        Comm_Receive_Buffer_Index = 0;
+// take next command from queue to receiving_Data_Packet, the slot is dispatched in place
+static void Parsing_Receive_Data_To_Packet(){
+    if(g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found){
+        return;
     }
-    Comm_Receive_Buffer[Comm_Receive_Buffer_Index] = value;
-    Comm_Receive_Buffer_Index++;
+    Parsing_Receive_Data_To_Packet_Queue();
+    if(Comm_Receive_Packet_Queue_Tail == Comm_Receive_Packet_Queue_Head){
+        return;
+    }
+    receiving_Data_Packet = &Comm_Receive_Packet_Queue[Comm_Receive_Packet_Queue_Tail];
+    Comm_Receive_Packet_Queue_Tail = (Comm_Receive_Packet_Queue_Tail + 1) & Comm_Receive_Packet_Queue_Mask;
+    //responses of this command echo its sequence ID
+    if(receiving_Data_Packet->SlAdd == SequenceSlaveAddressCode){
+        Comm_Transmitting_Sequence = receiving_Data_Packet->SequenceID;
+        g_Usb_Cdc_Status_FLAG |= CDC_TX_With_Sequence;
+    }else{
+        g_Usb_Cdc_Status_FLAG &= ~CDC_TX_With_Sequence;
+    }
+    g_Usb_Cdc_Status_FLAG |= (CDC_RX_Packet_Found + CDC_RX_Packet_Check_True);
 }
+
 ////////////////////////////////////////////////////////////////////////////////
-static t_uint8 Calculate_Receive_Data_To_Packet_For_CheckSum16(){
+// transparent bridge, bytes in Comm_Receive_Buffer are sent to the module instead of parsing
+static void CDC_Bridge_Exit_Hold_Time_Up(void){
+    CDC_Bridge_Scan_Expired = 1;
+}
+// every byte of host is scanned for Cmd_UART_Bridge_Exit by the frame parser, it is not used for cmds in bridge mode,
+// the frame may be split over USB packets or follow payload in the same packet
+static void scan_CDC_Bridge_Exit(t_uint16 position, t_uint8 value){
+    if(CDC_Bridge_Exit_Pending){
+        return;
+    }
+    //the head slot of the queue is not a parsed cmd yet
+    if(Parsing_Receive_Byte_To_Packet(&Comm_Receive_Packet_Queue[Comm_Receive_Packet_Queue_Head], value) == Func_Success){
+        _DUI_Remove_Detection_Calling_Function(CDC_Bridge_Exit_Hold_Fun_Index);
+        CDC_Bridge_Exit_Position = CDC_Bridge_Scan_Position;
+        CDC_Bridge_Exit_Pending = 1;
+        return;
+    }
+    //frames of other cmds are payload, their bytes are not held
+    if((Comm_Parsing_State == CDC_Parse_Length_Low) && (value != Cmd_UART_Bridge_Exit)){
+        restart_Parsing_State(value);
+    }
+    if(Comm_Parsing_State == CDC_Parse_Wait_SlaveAddress){
+        CDC_Bridge_Scan_Position = position;
+        CDC_Bridge_Scan_Expired = 0;
+        //+1 period, the first period after setting is not a whole one
+        _DUI_Set_Calling_Function_While_Form_Detection(CDC_Bridge_Exit_Hold_Fun_Index, CDC_Bridge_Exit_Hold_Time_Up,
+                                                       ((CDC_Bridge_Exit_Hold_MS + Timer_B_Polling_Base_MS - 1) / Timer_B_Polling_Base_MS) + 1);
+    }
+}
+// bytes left in ring buffer by the cmd entering the bridge are scanned too
+static void start_CDC_Bridge_Exit_Scan(){
+    t_uint16 position;
 
-    t_uint16 chkSum;
-    t_uint8 chkSum_hi, chkSum_lo;
-    t_uint16 DataLenExpected;
-
-    DataLenExpected = receiving_Data_Packet.DataLenExpected_High;
-    DataLenExpected = (DataLenExpected << 8) + receiving_Data_Packet.DataLenExpected_Low;
-    chkSum = usCheckSum16(&(receiving_Data_Packet.SlAdd), DataLenExpected + 4);
-    chkSum_hi = chkSum >> 8;
-    chkSum_lo = chkSum & 0x00ff;
-    if((chkSum_hi == receiving_Data_Packet.LRCDataHigh) && (chkSum_lo == receiving_Data_Packet.LRCDataLow)){
-        return Func_Success;
-    }else{
-        return Func_Failure;
+    CDC_Bridge_Exit_Pending = 0;
+    CDC_Bridge_Scan_Expired = 0;
+    Comm_Parsing_State = CDC_Parse_Wait_LeadingCode;
+    for(position = Comm_Receive_Buffer_Tail; position != Comm_Receive_Buffer_Head; position = (position + 1) & Comm_Receive_Buffer_Mask){
+        scan_CDC_Bridge_Exit(position, Comm_Receive_Buffer[position]);
     }
 }
-static void Parsing_Receive_Data_To_Packet(){
-    t_uint16 i,j;
-    t_uint16 startFormIndex;
-    t_uint16 dataLength;
-    t_uint16 endCode1_idx, endCode2_idx;
-    //t_uint16 CheckSumLow_idx, CheckSumHigh_idx;
-    if(g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found){
+// bytes sent to the module are before the exit frame and before the leading code being scanned
+static t_uint16 get_CDC_Bridge_Forward_End(){
+    if(CDC_Bridge_Exit_Pending){
+        return CDC_Bridge_Exit_Position;
+    }
+    if(Comm_Parsing_State != CDC_Parse_Wait_LeadingCode){
+        return CDC_Bridge_Scan_Position;
+    }
+    return Comm_Receive_Buffer_Head;
+}
+static void CDC_Bridge_Leave(){
+    //the ring does not wrap to the bytes of the last USB sending before it is done
+    _DUI_Release_Comm_Module_Bridge_Data(_DUI_Get_Comm_Module_Bridge(), CDC_Bridge_Sending_Length);
+    CDC_Bridge_Sending_Length = 0;
+    _DUI_Set_Comm_Module_Bridge(_DUI_Get_Comm_Module_Bridge(), 0);
+    CDC_Bridge_Exit_Pending = 0;
+    _DUI_Remove_Detection_Calling_Function(CDC_Bridge_Exit_Hold_Fun_Index);
+    //cmds are parsed again from CDC_Bridge_Exit_Position
+    Comm_Parsing_State = CDC_Parse_Wait_LeadingCode;
+}
+// bytes of the module are sent to host while the last sending is done,
+// bytes of host are sent to the module while its TX ring has room, the left ones hold USB receiving
+static void CDC_Bridge_Process(){
+    t_uint8 uart_module;
+    t_uint16 end;
+    t_uint16 length;
+    t_uint16 chunk;
+    t_uint8 *bytes;
+
+    uart_module = _DUI_Get_Comm_Module_Bridge();
+    if(_Device_Is_USB_Break_Received()){
+        //bytes not sent to the module yet are dropped
+        _Device_Clear_USB_Break_Received();
+        clear_Comm_Receive_Buffer();
+        CDC_Bridge_Leave();
         return;
     }
+    if(_Device_Is_USB_Sending() == 0){
+        _DUI_Release_Comm_Module_Bridge_Data(uart_module, CDC_Bridge_Sending_Length);
+        CDC_Bridge_Sending_Length = 0;
+        if(_DUI_Is_Comm_Module_Receiving_Data_Ready(uart_module) == UART_RECEIVING_DATA_READY){
+            bytes = _DUI_Get_Comm_Module_Bridge_Data(uart_module, &length, CDC_Bridge_Send_Max_Length);
+            if(length && (_Device_USB_Send_Bytes_To_PC(bytes, length) == Func_Success)){
+                CDC_Bridge_Sending_Length = length;
+            }
+        }
+    }
+    if(((Comm_Receive_Buffer_Tail - Comm_Receive_Buffer_Head - 1) & Comm_Receive_Buffer_Mask) >= USB_Receive_Max_Bytes_Per_Packet){
+        _Device_USB_Receive_From_PC();
+    }
+    //a leading code not followed by the rest of Cmd_UART_Bridge_Exit in CDC_Bridge_Exit_Hold_MS is payload
+    if(CDC_Bridge_Scan_Expired && (_Device_Is_USB_Data_Received() == 0)){
+        CDC_Bridge_Scan_Expired = 0;
+        if(CDC_Bridge_Exit_Pending == 0){
+            Comm_Parsing_State = CDC_Parse_Wait_LeadingCode;
+        }
+    }
+    end = get_CDC_Bridge_Forward_End();
+    length = (end - Comm_Receive_Buffer_Tail) & Comm_Receive_Buffer_Mask;
+    chunk = _DUI_Get_Comm_Module_Transmit_Free_Size(uart_module);
+    if(length > chunk){
+        length = chunk;
+    }
+    while(length){
+        chunk = Comm_Receive_Buffer_Size - Comm_Receive_Buffer_Tail;
+        if(chunk > length){
+            chunk = length;
+        }
+        _DUI_Communication_Send_Bytes(uart_module, &(Comm_Receive_Buffer[Comm_Receive_Buffer_Tail]), chunk);
+        Comm_Receive_Buffer_Tail = (Comm_Receive_Buffer_Tail + chunk) & Comm_Receive_Buffer_Mask;
+        length -= chunk;
+    }
+    //Cmd_UART_Bridge_Exit is parsed by the next polling
+    if(CDC_Bridge_Exit_Pending && (Comm_Receive_Buffer_Tail == CDC_Bridge_Exit_Position)){
+        CDC_Bridge_Leave();
+    }
+}
+static t_uint8 is_CDC_Bridge_Ready(){
+    t_uint8 uart_module;
 
-    for(i = 0; i < (Comm_Receive_Buffer_Index - 1); i++){
-        //finding leading codes
-        if((Comm_Receive_Buffer[i] == LeadingCode) && (Comm_Receive_Buffer[i+1] == SlaveAddressCode)){
-            startFormIndex = i;
-            dataLength = Comm_Receive_Buffer[startFormIndex + 4];    //offset 4 to get receiving data length_High
-            dataLength = (dataLength << 8) + Comm_Receive_Buffer[startFormIndex + 3];    //offset 3 to get receiving data length_Low
-            endCode1_idx = startFormIndex + 4 + dataLength + 2 + 1;  //add offset 2 is two of Cuecksum bytes
-            endCode2_idx = startFormIndex + 4 + dataLength + 2 + 2;  //add offset 2 is two of Cuecksum bytes
-            //CheckSumLow_idx = startFormIndex + 3 + dataLength + 1;  //Cuecksum Low byte idx
-            //CheckSumHigh_idx = startFormIndex + 3 + dataLength + 2;  //Cuecksum High byte idx
-            //finding Ending Codes
-            if((Comm_Receive_Buffer[endCode1_idx] == EndingCode1) && (Comm_Receive_Buffer[endCode2_idx] == EndingCode2)){
-                //Save data to structure
-                receiving_Data_Packet.SlAdd = SlaveAddressCode;
-                receiving_Data_Packet.Command = Comm_Receive_Buffer[startFormIndex + 2];
-                receiving_Data_Packet.DataLenExpected_Low = dataLength;
-                receiving_Data_Packet.DataLenExpected_High = dataLength >> 8;
-                for(j = 0; j < dataLength; j++){
-                    receiving_Data_Packet.DataBuf[j] = Comm_Receive_Buffer[startFormIndex + 4 + 1 + j];
-                }//for
-                receiving_Data_Packet.LRCDataLow = Comm_Receive_Buffer[endCode1_idx - 2];
-                receiving_Data_Packet.LRCDataHigh = Comm_Receive_Buffer[endCode1_idx - 1];
-                g_Usb_Cdc_Status_FLAG |= CDC_RX_Packet_Found;
-                shift_Comm_Receive_Buffer_To_First_Position(endCode2_idx + 1);
-                //check RX Packet with checkSum16
-                if(Calculate_Receive_Data_To_Packet_For_CheckSum16() == Func_Success){
-                    g_Usb_Cdc_Status_FLAG |= CDC_RX_Packet_Check_True;
-                }else{
-                    g_Usb_Cdc_Status_FLAG &= ~CDC_RX_Packet_Found;
-                    g_Usb_Cdc_Status_FLAG &= ~CDC_RX_Packet_Check_True;
-                }
-                return;
-            }//if
-        }// if
-    }//for(i = 0; i < (Comm_Receive_Buffer_Index - 1); i++){
+    uart_module = _DUI_Get_Comm_Module_Bridge();
+    if(_Device_Is_USB_Break_Received() || (CDC_Bridge_Exit_Pending && (Comm_Receive_Buffer_Tail == CDC_Bridge_Exit_Position))){
+        return 1;
+    }
+    if((_Device_Is_USB_Sending() == 0) && (_DUI_Is_Comm_Module_Receiving_Data_Ready(uart_module) == UART_RECEIVING_DATA_READY)){
+        return 1;
+    }
+    if((CDC_Bridge_Scan_Expired && (_Device_Is_USB_Data_Received() == 0)) ||
+       ((Comm_Receive_Buffer_Tail != get_CDC_Bridge_Forward_End()) && _DUI_Get_Comm_Module_Transmit_Free_Size(uart_module))){
+        return 1;
+    }
+    if(_Device_Is_USB_Data_Received() &&
+       (((Comm_Receive_Buffer_Tail - Comm_Receive_Buffer_Head - 1) & Comm_Receive_Buffer_Mask) >= USB_Receive_Max_Bytes_Per_Packet)){
+        return 1;
+    }
+    return 0;
 }
 
 static void CDC_Receive_Calling_Function(t_uint8* receivedBytesBuffer, t_uint16 receivingSize){
     t_uint16 i;
+    t_uint16 position;
+    t_uint8 bridge;
+
+    //bytes before Cmd_UART_Bridge_Exit are still sent to the module, the cmd is parsed after the bridge is left
+    bridge = (_DUI_Get_Comm_Module_Bridge() != Comm_Bridge_Off);
     for(i = 0; i < receivingSize; i++){
+        position = Comm_Receive_Buffer_Head;
         set_Value_To_Receive_Buffer(receivedBytesBuffer[i]);
+        if(bridge && (position != Comm_Receive_Buffer_Head)){
+            scan_CDC_Bridge_Exit(position, receivedBytesBuffer[i]);
+        }
     }
-    Parsing_Receive_Data_To_Packet();
+    //called by _Device_USB_Receive_From_PC() in main loop,
+    //parsing is done by _DUI_USB_Main_Polling_Function_For_Parsing_Receiving_Packet()
 //    if((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found) && (g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Check_True)){
 //        //_DUI_CDC_Transmitting_Data(&(receiving_Data_Packet.SlAdd), receiving_Data_Packet.DataLenExpected + 3);
 //        _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(receiving_Data_Packet.Command, &(receiving_Data_Packet.SlAdd), receiving_Data_Packet.DataLenExpected + 3);
@@ -264,10 +544,22 @@ void _DUI_Init_USB_AS_CDC_Communication(){
     clear_Comm_Receive_Buffer();
     _Device_Init_USB_Config();
     g_Usb_Cdc_Status_FLAG = 0;
+    init_CDC_Command_Statistics();
     _Device_Set_USB_Receive_From_PC_Calling_Function(CDC_Receive_Calling_Function);
 
 }
 
+t_uint8 _DUI_USB_CDC_Is_Receiving_Data_Pending(){
+    if(_DUI_Get_Comm_Module_Bridge() != Comm_Bridge_Off){
+        return is_CDC_Bridge_Ready();
+    }
+    if((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found) || (Comm_Receive_Packet_Queue_Tail != Comm_Receive_Packet_Queue_Head) ||
+       (Comm_Receive_Buffer_Tail != Comm_Receive_Buffer_Head) || _Device_Is_USB_Data_Received()){
+        return 1;
+    }
+    return 0;
+}
+
 void _DUI_USB_CDC_Polling_Status_Function(){
     t_uint8 status;
 
@@ -306,24 +598,32 @@ void _DUI_CDC_Transmitting_Data(t_uint8* sendBuffer, t_uint16 length){
     }
     //return Func_Success;
 }
-void _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(t_uint8 respons_cmd, t_uint8* sendBuffer, t_uint16 length){
-    t_uint16 index, i;
-    t_uint16 chkSum;
+//header of USB protocol packet in Comm_Transmitting_Buffer, return index of the data field
+static t_uint16 Put_USB_Protocol_Packet_Header(t_uint8 respons_cmd, t_uint16 length){
+    t_uint16 index;
 
-    if(length >= CDC_Transmitting_Max_Data_Length){
-        length = CDC_Transmitting_Max_Data_Length;
-    }
     index = 0;
     Comm_Transmitting_Buffer[index++] = LeadingCode;
-    Comm_Transmitting_Buffer[index++] = SlaveAddressCode;
-    Comm_Transmitting_Buffer[index++] = respons_cmd;
-    Comm_Transmitting_Buffer[index++] = length; //low
-    Comm_Transmitting_Buffer[index++] = length >> 8; //high
-    for(i = 0; i < length; i++){
-        Comm_Transmitting_Buffer[index++] = *(sendBuffer++);
+    if(g_Usb_Cdc_Status_FLAG & CDC_TX_With_Sequence){
+        Comm_Transmitting_Buffer[index++] = SequenceSlaveAddressCode;
+        Comm_Transmitting_Buffer[index++] = respons_cmd;
+        Comm_Transmitting_Buffer[index++] = (length + 1); //low
+        Comm_Transmitting_Buffer[index++] = (length + 1) >> 8; //high
+        Comm_Transmitting_Buffer[index++] = Comm_Transmitting_Sequence;
+    }else{
+        Comm_Transmitting_Buffer[index++] = SlaveAddressCode;
+        Comm_Transmitting_Buffer[index++] = respons_cmd;
+        Comm_Transmitting_Buffer[index++] = length; //low
+        Comm_Transmitting_Buffer[index++] = length >> 8; //high
     }
+    return index;
+}
 
-    chkSum = usCheckSum16(&(Comm_Transmitting_Buffer[1]), length + 4);
+//checkSum and end code after the data field, then send the packet
+static void Send_USB_Protocol_Packet(t_uint16 index){
+    t_uint16 chkSum;
+
+    chkSum = usCheckSum16(&(Comm_Transmitting_Buffer[1]), index - 1);
     Comm_Transmitting_Buffer[index++] = chkSum & 0x00ff;    //checkSum Low Bytes
     Comm_Transmitting_Buffer[index++] = chkSum >> 8;        //checkSum High Bytes
     Comm_Transmitting_Buffer[index++] = EndingCode1;
@@ -332,6 +632,137 @@ void _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(t_uint8 respons_cmd, t_
     _DUI_CDC_Transmitting_Data(Comm_Transmitting_Buffer, index);
 }
 
+void _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(t_uint8 respons_cmd, t_uint8* sendBuffer, t_uint16 length){
+    t_uint16 index, i;
+
+    if(length >= CDC_Transmitting_Max_Data_Length){
+        length = CDC_Transmitting_Max_Data_Length;
+    }
+    index = Put_USB_Protocol_Packet_Header(respons_cmd, length);
+    for(i = 0; i < length; i++){
+        Comm_Transmitting_Buffer[index++] = *(sendBuffer++);
+    }
+    Send_USB_Protocol_Packet(index);
+}
+
+//received UART frame is drained from the receiving ring into the data field directly, after prefix_length bytes of prefix
+void _DUI_CDC_Transmitting_UART_Frame_With_USB_Protocol_Packet(t_uint8 respons_cmd, t_uint8* prefix, t_uint16 prefix_length, t_uint8 uart_module){
+    t_uint16 index, i;
+    t_uint16 length;
+
+    index = Put_USB_Protocol_Packet_Header(respons_cmd, 0);
+    for(i = 0; i < prefix_length; i++){
+        Comm_Transmitting_Buffer[index++] = prefix[i];
+    }
+    _DUI_Get_Receiving_Data_To_Array(uart_module, &(Comm_Transmitting_Buffer[index]), &length, CDC_Transmitting_Max_Data_Length - prefix_length);
+    //length is known after draining, header size does not depend on it
+    Put_USB_Protocol_Packet_Header(respons_cmd, prefix_length + length);
+    Send_USB_Protocol_Packet(index + length);
+}
+
+// response tag of the cmd in CDC_Command_Dispatch(), async cmd keeps it for its result
+t_uint16 _DUI_CDC_Get_Response_Tag(){
+    t_uint16 response_tag;
+
+    response_tag = (t_uint16)CDC_Command_Async_Slot << CDC_Response_Tag_Slot_Shift;
+    if(g_Usb_Cdc_Status_FLAG & CDC_TX_With_Sequence){
+        response_tag |= CDC_Response_Tag_Sequence | Comm_Transmitting_Sequence;
+    }
+    return response_tag;
+}
+static void set_CDC_Response_Tag(t_uint16 response_tag){
+    Comm_Transmitting_Sequence = response_tag & 0x00ff;
+    if(response_tag & CDC_Response_Tag_Sequence){
+        g_Usb_Cdc_Status_FLAG |= CDC_TX_With_Sequence;
+    }else{
+        g_Usb_Cdc_Status_FLAG &= ~CDC_TX_With_Sequence;
+    }
+}
+// result of async cmd is sent with the response tag of the cmd, then its latency is counted
+void _DUI_CDC_Transmitting_Async_Response(t_uint8 respons_cmd, t_uint16 response_tag, t_uint8* sendBuffer, t_uint16 length){
+    t_uint16 dispatch_tag;
+
+    dispatch_tag = _DUI_CDC_Get_Response_Tag();
+    set_CDC_Response_Tag(response_tag);
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(respons_cmd, sendBuffer, length);
+    set_CDC_Response_Tag(dispatch_tag);
+    account_CDC_Async_Command_Latency(response_tag);
+}
+void _DUI_CDC_Transmitting_Async_UART_Frame_Response(t_uint8 respons_cmd, t_uint16 response_tag, t_uint8* prefix, t_uint16 prefix_length, t_uint8 uart_module){
+    t_uint16 dispatch_tag;
+
+    dispatch_tag = _DUI_CDC_Get_Response_Tag();
+    set_CDC_Response_Tag(response_tag);
+    _DUI_CDC_Transmitting_UART_Frame_With_USB_Protocol_Packet(respons_cmd, prefix, prefix_length, uart_module);
+    set_CDC_Response_Tag(dispatch_tag);
+    account_CDC_Async_Command_Latency(response_tag);
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ADC streaming block, called by main() when ADC_Stream_Processing is set
+// the block is copied first, it is not sent if DMA overwrites it during copying
+////////////////////////////////////////////////////////////////////////////////
+void _DUI_CDC_Transmitting_ADC_Stream_Block(){
+    t_uint16 *block;
+    t_uint32 block_number;
+    t_uint32 sample_number;
+    t_uint16 dropped;
+    t_uint16 index, i;
+
+    block = _DUI_ADC_Stream_Get_Ready_Block(&block_number);
+    if(block == 0){
+        return;
+    }
+    index = 6;
+    for(i = 0; i < ADC_Stream_Block_Samples; i++){
+        Comm_Temp_Transmitting_Data_Buffer[index++] = block[i];
+        Comm_Temp_Transmitting_Data_Buffer[index++] = block[i] >> 8;
+    }
+    if(_DUI_ADC_Stream_Release_Block(block_number) == Func_Failure){
+        return;
+    }
+    sample_number = block_number * ADC_Stream_Block_Samples;
+    dropped = _DUI_ADC_Stream_Get_Dropped_Blocks();
+    Comm_Temp_Transmitting_Data_Buffer[0] = sample_number;
+    Comm_Temp_Transmitting_Data_Buffer[1] = sample_number >> 8;
+    Comm_Temp_Transmitting_Data_Buffer[2] = sample_number >> 16;
+    Comm_Temp_Transmitting_Data_Buffer[3] = sample_number >> 24;
+    Comm_Temp_Transmitting_Data_Buffer[4] = dropped;
+    Comm_Temp_Transmitting_Data_Buffer[5] = dropped >> 8;
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_ADC_Stream_Data_Block, Comm_Temp_Transmitting_Data_Buffer, index);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ADC watch event, called by main() when ADC_Watch_Processing is set
+////////////////////////////////////////////////////////////////////////////////
+void _DUI_CDC_Transmitting_ADC_Watch_Event(){
+    t_uint32 sample_number;
+    t_uint32 time_stamp;
+    t_uint16 adc;
+    t_uint16 lost;
+    t_uint8 state;
+
+    if(_DUI_ADC_Watch_Get_Event(&sample_number, &time_stamp, &adc, &state) == Func_Failure){
+        return;
+    }
+    lost = _DUI_ADC_Watch_Get_Lost_Events();
+    Comm_Temp_Transmitting_Data_Buffer[0] = sample_number;
+    Comm_Temp_Transmitting_Data_Buffer[1] = sample_number >> 8;
+    Comm_Temp_Transmitting_Data_Buffer[2] = sample_number >> 16;
+    Comm_Temp_Transmitting_Data_Buffer[3] = sample_number >> 24;
+    Comm_Temp_Transmitting_Data_Buffer[4] = time_stamp;
+    Comm_Temp_Transmitting_Data_Buffer[5] = time_stamp >> 8;
+    Comm_Temp_Transmitting_Data_Buffer[6] = time_stamp >> 16;
+    Comm_Temp_Transmitting_Data_Buffer[7] = time_stamp >> 24;
+    Comm_Temp_Transmitting_Data_Buffer[8] = adc;
+    Comm_Temp_Transmitting_Data_Buffer[9] = adc >> 8;
+    Comm_Temp_Transmitting_Data_Buffer[10] = state;
+    Comm_Temp_Transmitting_Data_Buffer[11] = lost;
+    Comm_Temp_Transmitting_Data_Buffer[12] = lost >> 8;
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_ADC_Watch_Event, Comm_Temp_Transmitting_Data_Buffer, 13);
+}
 
 
 t_uint32 gCdcTempUint32;
@@ -340,1095 +771,1340 @@ t_uint8 gCdcTempUint8;
 float gCdcTempFloat;
 t_uint8* gCdcTempUint8_ptr;                         // Initialize Flash pointer
 
-void _DUI_USB_Main_Polling_Function_For_Parsing_Receiving_Packet(){
-//    if( ((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found) == 0 ) ||
-//        ((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Check_True) == 0)){
-//        return;
-//    }
-//    if((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found) && (g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Check_True)){
-//        //_DUI_CDC_Transmitting_Data(&(receiving_Data_Packet.SlAdd), receiving_Data_Packet.DataLenExpected + 3);
-//        _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(receiving_Data_Packet.Command, &(receiving_Data_Packet.SlAdd), receiving_Data_Packet.DataLenExpected + 3);
-//        g_Usb_Cdc_Status_FLAG &= ~CDC_RX_Packet_Found;
-//        g_Usb_Cdc_Status_FLAG &= ~CDC_RX_Packet_Check_True;
-//    }
-    if((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found) && (g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Check_True)){
-        switch(receiving_Data_Packet.Command){
-
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Set_DSG_Load_Gate           (0x70)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:turn off, 1:turn on
-            //=====================================================================
-            // Transmitting DataLenExpected = N/A
-            // Transmitting DataBuf[0] = N/A(Lo-byte);      Transmitting DataBuf[1] = N/A(Hi-byte)
-            case Cmd_Set_DSG_Load_Gate:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_DSG_Load_Gate,&(gCdcTempUint8), 1);
-                    break;
-                }
-                _DUI_SetKitLoading(receiving_Data_Packet.DataBuf[0]?Turn_On:Turn_Off);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_DSG_Load_Gate,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Set_CHG_Shiftet_Gate           (0x71)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:turn off, 1:turn on
-            //=====================================================================
-            // Transmitting DataLenExpected = N/A
-            // Transmitting DataBuf[0] = N/A(Lo-byte);      Transmitting DataBuf[1] = N/A(Hi-byte)
-            case Cmd_Set_CHG_Shiftet_Gate:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_CHG_Shiftet_Gate,&(gCdcTempUint8), 1);
-                    break;
-                }
-                _DUI_SetChargingViaDSGPort(receiving_Data_Packet.DataBuf[0]?Turn_On:Turn_Off);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_CHG_Shiftet_Gate,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Set_ADC_VPC_Gate           (0x72)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:turn off, 1:turn on
-            //=====================================================================
-            // Transmitting DataLenExpected = N/A
-            // Transmitting DataBuf[0] = N/A(Lo-byte);      Transmitting DataBuf[1] = N/A(Hi-byte)
-            case Cmd_Set_ADC_VPC_Gate:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_ADC_VPC_Gate,&(gCdcTempUint8), 1);
-                    break;
-                }
-                _DUI_SetPackCHGInputPortForMeasurement(receiving_Data_Packet.DataBuf[0]?Turn_On:Turn_Off);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_ADC_VPC_Gate,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Set_ADC_VPD_Gate           (0x73)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:turn off, 1:turn on
-            //=====================================================================
-            // Transmitting DataLenExpected = N/A
-            // Transmitting DataBuf[0] = N/A(Lo-byte);      Transmitting DataBuf[1] = N/A(Hi-byte)
-            case Cmd_Set_ADC_VPD_Gate:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_ADC_VPD_Gate,&(gCdcTempUint8), 1);
-                    break;
-                }
-                _DUI_SetPackDSGInputPortForMeasurement(receiving_Data_Packet.DataBuf[0]?Turn_On:Turn_Off);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_ADC_VPD_Gate,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Communi_Multiplex_Reset         (0x80)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            case Cmd_Communi_Multiplex_Reset:
-                _DUI_Commun_MUX_Init();
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Communi_Multiplex_Reset,&(gCdcTempUint8), 1);
-                break;
-
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Communi_Multiplex_Set_Channel   (0x81)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:RS485_Channel, 1:UART_Channel
-            case Cmd_Communi_Multiplex_Set_Channel:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Communi_Multiplex_Set_Channel,&(gCdcTempUint8), 1);
-                    break;
-                }
-                _DUI_Switch_To_Communication_Port(receiving_Data_Packet.DataBuf[0]?UART_Channel:RS485_Channel);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Communi_Multiplex_Set_Channel,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_UART_Set_Baud_Rate          (0x82)
-            // receiving_Data_Packet.DataLenExpected = 4
-            // receiving_Data_Packet.DataBuf[0] = Baud_Rate, Lo-Word Lo-Byte
-            // receiving_Data_Packet.DataBuf[1] = Baud_Rate, Lo-Word Hi-Byte
-            // receiving_Data_Packet.DataBuf[2] = Baud_Rate, Hi-Word Lo-Byte
-            // receiving_Data_Packet.DataBuf[3] = Baud_Rate, Hi-Word Hi-Byte
-            case Cmd_UART_Set_Baud_Rate:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low < 4)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_UART_Set_Baud_Rate,&(gCdcTempUint8), 1);
-                    break;
-                }
-                gCdcTempUint32 = receiving_Data_Packet.DataBuf[3];
-                gCdcTempUint32 = (gCdcTempUint32 << 8) | receiving_Data_Packet.DataBuf[2];
-                gCdcTempUint32 = (gCdcTempUint32 << 8) | receiving_Data_Packet.DataBuf[1];
-                gCdcTempUint32 = (gCdcTempUint32 << 8) | receiving_Data_Packet.DataBuf[0];
-                _DUI_Set_Communication_BAUD_RATE(gCdcTempUint32);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_UART_Set_Baud_Rate,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            //  Cmd_UART_Set_Default_Baud_Rate  (0x83)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            case Cmd_UART_Set_Default_Baud_Rate:
-                _DUI_Set_Communication_BAUD_RATE(0);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_UART_Set_Default_Baud_Rate,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_UART_RS485_Enable           (0x84)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            case Cmd_UART_RS485_Enable:
-                _DUI_Communication_Enable(Uart_RS485_Module);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_UART_RS485_Enable,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_UART_RS485_Disable          (0x85)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            case Cmd_UART_RS485_Disable:
-                _DUI_Communication_Disable(Uart_RS485_Module);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_UART_RS485_Disable,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_One_Wire_Commu_Enable       (0x86)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            case Cmd_One_Wire_Commu_Enable:
-                _DUI_Communication_Enable(One_Wire_Module);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_One_Wire_Commu_Enable,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_One_Wire_Commu_Disable      (0x87)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            case Cmd_One_Wire_Commu_Disable:
-                _DUI_Communication_Disable(One_Wire_Module);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_One_Wire_Commu_Disable,&(gCdcTempUint8), 1);
-                break;
-//            ///////////////////////////////////////////////////////////////////////
-//            // Cmd_I2C_Reset                   (0x88)
-//            // receiving_Data_Packet.DataLenExpected = 0
-//            // receiving_Data_Packet.DataBuf[0] = N/A
-//            case Cmd_I2C_Reset:
-//                gCdcTempUint8 = Respond_Error_Check_Code;
-//                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_I2C_Reset,&(gCdcTempUint8), 1);
-//                break;
-//            ///////////////////////////////////////////////////////////////////////
-//            // Cmd_I2C_Set_Address             (0x89)
-//            // receiving_Data_Packet.DataLenExpected = 1
-//            // receiving_Data_Packet.DataBuf[0] = Slave Address 7bits
-//            case Cmd_I2C_Set_Address:
-//                gCdcTempUint8 = Respond_Accept_Check_Code;
-//                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_I2C_Set_Address,&(gCdcTempUint8), 1);
-//                break;
+////////////////////////////////////////////////////////////////////////////////
+// Command handlers : (section start)
+// return Func_Success or Func_Failure, the 1 byte Respond_Accept_Check_Code or
+// Respond_Error_Check_Code response is sent by CDC_Command_Dispatch(),
+// payload length is checked by CDC_Command_Table before calling.
+////////////////////////////////////////////////////////////////////////////////
+static t_uint8 Is_Measurement_Processing(){
+    if((_DUI_Measurement_Job_Is_Busy() == 0) && ((G_1st_Module_Function_Status & (ADC_Stream_Processing + ADC_Watch_Processing)) == 0) &&
+       (_DUI_Test_Sequence_Is_Running() == 0)){
+        return 0;
+    }
+    return 1;
+}
+//measurement job of each measurement cmd, parameter of the cmd in CDC_Command_Table
+typedef enum{
+    Job_Charger_24V_Auto,
+    Job_Charger_36V_Auto,
+    Job_Charger_48V_Auto,
+    Job_Pack_DSG_Auto,
+    Job_Pack_CHG_Auto,
+    Job_Channel_Raw_ADC,
+    Job_Direct_PackDSG_Voltage,
+    Job_Direct_PackCHG_Voltage,
+    Job_Direct_Chger_24Voltage,
+    Job_Direct_Chger_36Voltage,
+    Job_Direct_Chger_48Voltage,
+    Job_Direct_DSG_Current,
+    Job_Direct_CHG_Current,
+    Job_All_Direct_Measurement,
+    Job_Channel_Statistics
+}CDC_Measurement_Job_Index;
+// {Response_Cmd, Gate, ADC_Channel, Measured_Function, Steps, Post, Settle_ms, Samples, Reducer, Verdict, Time_Stamp, Response_Tag}
+// Settle_ms of charger jobs is G_Temp_1_DelayCycles, samples and reducer are set by the packet,
+// verdict is CDC_Verdict_Mode, time stamp is CDC_Time_Stamp_Mode, response tag is set by _DUI_Measurement_Job_Enqueue()
+static const MeasurementJob CDC_Measurement_Jobs[] = {
+    {Cmd_Get_Charger_24V_Voltage_Auto, Job_Gate_Charger_24V, ADC_Chger_Vol_ch, Measured_24V_Chger, 3, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Charger_36V_Voltage_Auto, Job_Gate_Charger_36V, ADC_Chger_Vol_ch, Measured_36V_Chger, 3, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Charger_48V_Voltage_Auto, Job_Gate_Charger_48V, ADC_Chger_Vol_ch, Measured_48V_Chger, 3, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_PACK_DSG_Voltage_Auto,    Job_Gate_Pack_DSG,    ADC_Pack_Dsg_ch,  Measured_Pack_DSG_Vol, 1, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_PACK_CHG_Voltage_Auto,    Job_Gate_Pack_CHG,    ADC_Pack_Chg_ch,  Measured_Pack_CHG_Vol, 1, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Channel_Raw_ADC,          Job_Gate_None,        ADC_CHG_ch,       Measured_Empty, 1, Job_Post_Raw_ADC, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Direct_PackDSG_Voltage,   Job_Gate_None,        ADC_Pack_Dsg_ch,  Measured_Pack_DSG_Vol, 1, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Direct_PackCHG_Voltage,   Job_Gate_None,        ADC_Pack_Chg_ch,  Measured_Pack_CHG_Vol, 1, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Direct_Chger_24Voltage,   Job_Gate_None,        ADC_Chger_Vol_ch, Measured_24V_Chger, 1, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Direct_Chger_36Voltage,   Job_Gate_None,        ADC_Chger_Vol_ch, Measured_36V_Chger, 1, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Direct_Chger_48Voltage,   Job_Gate_None,        ADC_Chger_Vol_ch, Measured_48V_Chger, 1, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Direct_DSG_Current,       Job_Gate_None,        ADC_DSG_ch,       Measured_Discharging_Current, 1, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Direct_CHG_Current,       Job_Gate_None,        ADC_CHG_ch,       Measured_Charging_Current, 1, Job_Post_Calibrated, 0, 0, 0, Job_Verdict_None, 0, 0},
+    {Cmd_Get_All_Direct_Measurement,   Job_Gate_None,        ADC_CHG_ch,       Measured_Empty, 1, Job_Post_All_Sequence, 0, Default_Oversample_Samples, Oversample_Mean, Job_Verdict_None, 0, 0},
+    {Cmd_Get_Channel_Statistics,       Job_Gate_None,        ADC_CHG_ch,       Measured_Empty, 1, Job_Post_Statistics, 0, 0, 0, Job_Verdict_None, 0, 0}
+};
+//optional oversampling of a measurement cmd, 8 samples and mean if it is not in the packet
+//DataBuf[index] = samples(Lo-byte), DataBuf[index+1] = samples(Hi-byte), 8 ~ 1024 (multiple of 8)
+//DataBuf[index+2] = 0:mean, 1:median, 2:trimmed mean, 3:oversample and decimate (12 bits)
+static void Set_ADC_Oversampling_By_Packet(MeasurementJob *job, USB_Receiving_Protocol_Packet *packet, t_uint8 index){
+    if(packet->DataLenExpected_Low < (index + 3)){
+        job->Samples = Default_Oversample_Samples;
+        job->Reducer = Oversample_Mean;
+        return;
+    }
+    job->Samples = packet->DataBuf[index + 1];
+    job->Samples = (job->Samples << 8) + packet->DataBuf[index];
+    job->Reducer = packet->DataBuf[index + 2];
+}
+//MeasurementJobVerdicts of measurement cmds with real values, set by Cmd_Set_Verdict_Mode
+t_uint8 CDC_Verdict_Mode = Job_Verdict_None;
+//time stamp trailer of measurement cmds and test sequence, set by Cmd_Set_Time_Stamp_Mode
+t_uint8 CDC_Time_Stamp_Mode = 0;
+//queue the job of a measurement cmd, result is sent by main() when the job is done
+static t_uint8 Enqueue_Measurement_Job_By_Packet(USB_Receiving_Protocol_Packet *packet, t_uint16 job_index, t_uint8 oversampling_index){
+    MeasurementJob job;
 
+    job = CDC_Measurement_Jobs[job_index];
+    if(job.Gate >= Job_Gate_Charger_24V){
+        job.Settle_ms = DelayCycles_To_MS(G_Temp_1_DelayCycles);
+    }
+    if(job.Post != Job_Post_All_Sequence){
+        Set_ADC_Oversampling_By_Packet(&job, packet, oversampling_index);
+    }
+    if((job.Post == Job_Post_Calibrated) || (job.Post == Job_Post_All_Sequence)){
+        job.Verdict = CDC_Verdict_Mode;
+    }
+    job.Time_Stamp = CDC_Time_Stamp_Mode;
+    if(job_index == Job_Channel_Raw_ADC){
+        job.ADC_Channel = packet->DataBuf[0];
+    }
+    if(job_index == Job_Channel_Statistics){
+        job.Measured_Function = packet->DataBuf[0];
+        if(job.Measured_Function == Measured_Empty){
+            job.ADC_Channel = packet->DataBuf[1];
+        }else{
+            job.ADC_Channel = _DUI_Get_Measured_Function_ADC_Channel((MeasuredFunctions)job.Measured_Function);
+        }
+        job.Steps = packet->DataBuf[3];
+        job.Steps = (job.Steps << 8) + packet->DataBuf[2];
+    }
+    return _DUI_Measurement_Job_Enqueue(&job);
+}
+//charger input and ID are switched by queued jobs or test sequence, cmds are serviced between ID steps
+static t_uint8 Is_Charger_Check_Processing(){
+    return (_DUI_Measurement_Job_Is_Using_Charger() || _DUI_Test_Sequence_Is_Running());
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Set_DSG_Load_Gate           (0x70)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0:turn off, 1:turn on
+//=====================================================================
+// Transmitting DataLenExpected = N/A
+// Transmitting DataBuf[0] = N/A(Lo-byte);      Transmitting DataBuf[1] = N/A(Hi-byte)
+static t_uint8 Cmd_Set_DSG_Load_Gate_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_SetKitLoading(packet->DataBuf[0]?Turn_On:Turn_Off);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Set_CHG_Shiftet_Gate           (0x71)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0:turn off, 1:turn on
+//=====================================================================
+// Transmitting DataLenExpected = N/A
+// Transmitting DataBuf[0] = N/A(Lo-byte);      Transmitting DataBuf[1] = N/A(Hi-byte)
+static t_uint8 Cmd_Set_CHG_Shiftet_Gate_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_SetChargingViaDSGPort(packet->DataBuf[0]?Turn_On:Turn_Off);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Set_ADC_VPC_Gate           (0x72)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0:turn off, 1:turn on
+//=====================================================================
+// Transmitting DataLenExpected = N/A
+// Transmitting DataBuf[0] = N/A(Lo-byte);      Transmitting DataBuf[1] = N/A(Hi-byte)
+static t_uint8 Cmd_Set_ADC_VPC_Gate_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_SetPackCHGInputPortForMeasurement(packet->DataBuf[0]?Turn_On:Turn_Off);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Set_ADC_VPD_Gate           (0x73)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0:turn off, 1:turn on
+//=====================================================================
+// Transmitting DataLenExpected = N/A
+// Transmitting DataBuf[0] = N/A(Lo-byte);      Transmitting DataBuf[1] = N/A(Hi-byte)
+static t_uint8 Cmd_Set_ADC_VPD_Gate_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_SetPackDSGInputPortForMeasurement(packet->DataBuf[0]?Turn_On:Turn_Off);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Communi_Multiplex_Reset         (0x80)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = N/A
+static t_uint8 Cmd_Communi_Multiplex_Reset_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_Commun_MUX_Init();
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Communi_Multiplex_Set_Channel   (0x81)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0:RS485_Channel, 1:UART_Channel
+static t_uint8 Cmd_Communi_Multiplex_Set_Channel_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_Switch_To_Communication_Port(packet->DataBuf[0]?UART_Channel:RS485_Channel);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_UART_Set_Baud_Rate          (0x82)
+// receiving_Data_Packet.DataLenExpected = 4
+// receiving_Data_Packet.DataBuf[0] = Baud_Rate, Lo-Word Lo-Byte
+// receiving_Data_Packet.DataBuf[1] = Baud_Rate, Lo-Word Hi-Byte
+// receiving_Data_Packet.DataBuf[2] = Baud_Rate, Hi-Word Lo-Byte
+// receiving_Data_Packet.DataBuf[3] = Baud_Rate, Hi-Word Hi-Byte
+static t_uint8 Cmd_UART_Set_Baud_Rate_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    gCdcTempUint32 = packet->DataBuf[3];
+    gCdcTempUint32 = (gCdcTempUint32 << 8) | packet->DataBuf[2];
+    gCdcTempUint32 = (gCdcTempUint32 << 8) | packet->DataBuf[1];
+    gCdcTempUint32 = (gCdcTempUint32 << 8) | packet->DataBuf[0];
+    _DUI_Set_Communication_BAUD_RATE(gCdcTempUint32);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+//  Cmd_UART_Set_Default_Baud_Rate  (0x83)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = N/A
+static t_uint8 Cmd_UART_Set_Default_Baud_Rate_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_Set_Communication_BAUD_RATE(0);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_UART_RS485_Enable           (0x84)
+// Cmd_One_Wire_Commu_Enable       (0x86)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = N/A
+// parameter = Uart_RS485_Module or One_Wire_Module
+static t_uint8 Cmd_Communication_Enable_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_Communication_Enable(parameter);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_UART_RS485_Disable          (0x85)
+// Cmd_One_Wire_Commu_Disable      (0x87)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = N/A
+// parameter = Uart_RS485_Module or One_Wire_Module
+static t_uint8 Cmd_Communication_Disable_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_Communication_Disable(parameter);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Charger_24V_Channel_Set_ID     (0x8A)
+// Cmd_Charger_36V_Channel_Set_ID     (0x8B)
+// Cmd_Charger_48V_Channel_Set_ID     (0x8C)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0:Chger_ID_OFF, 1:Chger_ID_1st_Step, 2:Chger_ID_2nd_Step
+// parameter = Switch_To_24V_Ch, Switch_To_36V_Ch or Switch_To_48V_Ch
+//=====================================================================
+// Transmitting DataLenExpected = NA
+// Transmitting DataBuf[0] = NA(Lo-byte);      Transmitting DataBuf[1] = NA(Hi-byte)
+static t_uint8 Cmd_Charger_Channel_Set_ID_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(Is_Charger_Check_Processing()){
+        return Func_Failure;
+    }
+    if(packet->DataBuf[0] >= 3){
+        return Func_Failure;
+    }
+    if(packet->DataBuf[0] == 0){
+        _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
+    }else{
+        _DUI_SwitchChargerInputAndIDStep((Switch_Channnel)parameter, (Chger_ID_Steps)packet->DataBuf[0]);
+    }
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_Charger_24V_Voltage_Auto     (0x8D)
+// Cmd_Get_Charger_36V_Voltage_Auto     (0x8E)
+// Cmd_Get_Charger_48V_Voltage_Auto     (0x8F)
+// receiving_Data_Packet.DataLenExpected = 0 or 3
+// receiving_Data_Packet.DataBuf[0 ~ 2] = oversampling (optional), see Set_ADC_Oversampling_By_Packet()
+// parameter = Job_Charger_24V(36V, 48V)_Auto
+//=====================================================================
+// Transmitting DataLenExpected = 12, sent by main() when the queued job is done
+// Transmitting DataBuf[0] = ID off, ADC(Lo-byte);      Transmitting DataBuf[1] = ID off, ADC(Hi-byte)
+// Transmitting DataBuf[2] = ID off, Real-mV(Lo-byte);  Transmitting DataBuf[3] = ID off, Real-mV(Hi-byte)
+// Transmitting DataBuf[4] = ID L1, ADC(Lo-byte);       Transmitting DataBuf[5] = ID L1, ADC(Hi-byte)
+// Transmitting DataBuf[6] = ID L1, Real-mV(Lo-byte);   Transmitting DataBuf[7] = ID L1, Real-mV(Hi-byte)
+// Transmitting DataBuf[8] = ID L2, ADC(Lo-byte);       Transmitting DataBuf[9] = ID L2, ADC(Hi-byte)
+// Transmitting DataBuf[10] = ID L2, Real-mV(Lo-byte);  Transmitting DataBuf[11] = ID L2, Real-mV(Hi-byte)
+static t_uint8 Cmd_Get_Charger_Voltage_Auto_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    return Enqueue_Measurement_Job_By_Packet(packet, parameter, 0);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Charger_24V_Channel_Set_Vin     (0xA0)
+// Cmd_Charger_36V_Channel_Set_Vin     (0xA1)
+// Cmd_Charger_48V_Channel_Set_Vin     (0xA2)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0:turn off Channel, 1:Turn on Channel
+// parameter = Switch_To_24V_Ch, Switch_To_36V_Ch or Switch_To_48V_Ch
+static t_uint8 Cmd_Charger_Channel_Set_Vin_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(Is_Charger_Check_Processing()){
+        return Func_Failure;
+    }
+    if(packet->DataBuf[0] == 0){
+        _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
+    }else{
+        _DUI_SwitchChargerInputAndIDStep((Switch_Channnel)parameter, Chger_ID_OFF);
+    }
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Charger_All_Channel_ID_Set_OFF      (0xA3)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = N/A
+static t_uint8 Cmd_Charger_All_Channel_ID_Set_OFF_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(Is_Charger_Check_Processing()){
+        return Func_Failure;
+    }
+    _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_PACK_DSG_Voltage_Auto (0xA8)
+// Cmd_Get_PACK_CHG_Voltage_Auto (0xA9)
+// receiving_Data_Packet.DataLenExpected = 0 or 3
+// receiving_Data_Packet.DataBuf[0 ~ 2] = oversampling (optional), see Set_ADC_Oversampling_By_Packet()
+// parameter = Job_Pack_DSG_Auto or Job_Pack_CHG_Auto
+//=====================================================================
+// Transmitting DataLenExpected = 4, sent by main() when the queued job is done
+// Transmitting DataBuf[0] = BatteryV ADC(Lo-byte);      Transmitting DataBuf[1] = BatteryV ADC(Hi-byte)
+// Transmitting DataBuf[2] = BatteryV real-mV(Lo-byte);  Transmitting DataBuf[3] = BatteryV real-mV(Hi-byte)
+static t_uint8 Cmd_Get_PACK_Voltage_Auto_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    return Enqueue_Measurement_Job_By_Packet(packet, parameter, 0);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_Channel_Raw_ADC (0xAA)
+// receiving_Data_Packet.DataLenExpected = 1 or 4
+// receiving_Data_Packet.DataBuf[0] = 0:ADC Channel 0, 1:ADC Channel 1, ~ to ~ 7:ADC Channel 7
+// receiving_Data_Packet.DataBuf[1 ~ 3] = oversampling (optional), see Set_ADC_Oversampling_By_Packet()
+//=====================================================================
+// Transmitting DataLenExpected = 2, sent by main() when the queued job is done
+// Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
+// ADC is 12 bits (0 ~ 4092) if reducer is oversample and decimate
+static t_uint8 Cmd_Get_Channel_Raw_ADC_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    return Enqueue_Measurement_Job_By_Packet(packet, parameter, 1);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_Direct_PackDSG_Voltage (0xAB)
+// Cmd_Get_Direct_PackCHG_Voltage (0xAC)
+// Cmd_Get_Direct_Chger_24Voltage (0xAD)
+// Cmd_Get_Direct_Chger_36Voltage (0xAE)
+// Cmd_Get_Direct_Chger_48Voltage (0xAF)
+// receiving_Data_Packet.DataLenExpected = 0 or 3
+// receiving_Data_Packet.DataBuf[0 ~ 2] = oversampling (optional), see Set_ADC_Oversampling_By_Packet()
+// parameter = Job_Direct_xxx of CDC_Measurement_Jobs
+//=====================================================================
+// Transmitting DataLenExpected = 4, sent by main() when the queued job is done
+// Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
+// Transmitting DataBuf[2] = Real Values(Lo-byte);      Transmitting DataBuf[3] = Real Values(Hi-byte)
+static t_uint8 Cmd_Get_Direct_Voltage_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    return Enqueue_Measurement_Job_By_Packet(packet, parameter, 0);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_Direct_DSG_Current (0xB0)
+// Cmd_Get_Direct_CHG_Current (0xB1)
+// receiving_Data_Packet.DataLenExpected = 0 or 3
+// receiving_Data_Packet.DataBuf[0 ~ 2] = oversampling (optional), see Set_ADC_Oversampling_By_Packet()
+// parameter = Job_Direct_DSG_Current or Job_Direct_CHG_Current
+//=====================================================================
+// Transmitting DataLenExpected = 4, sent by main() when the queued job is done
+// Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
+// Transmitting DataBuf[2] = Real Values(Lo-byte);      Transmitting DataBuf[3] = Real Values(Hi-byte)
+static t_uint8 Cmd_Get_Direct_Current_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    return Enqueue_Measurement_Job_By_Packet(packet, parameter, 0);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_Charger_Is_ID_Level (0xB2)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = NA
+//=====================================================================
+// Transmitting DataLenExpected = 1
+// Transmitting DataBuf[0] = (1: use ID switch Voltage adapter)(0: No ID switch adapter);
+static t_uint8 Cmd_Get_Charger_Is_ID_Level_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint8 level;
+    if(_DUI_Get_Charger_ID_Status() == Chger_With_ID_Step){
+        level = 1;
+    }else{
+        level = 0;
+    }
+    //send data out via usb
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_Is_ID_Level,&level, 1);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_All_Direct_Measurement (0xB3)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = NA
+// A0~A4 are converted by one Sequence of Channels conversion, replaces
+// 0xAB ~ 0xB1 round trips, peripheral and gates are not set (same as Direct cmds)
+//=====================================================================
+// Transmitting DataLenExpected = 28, sent by main() when the queued job is done
+// Transmitting DataBuf[0~3]   = 24V Charger ADC, Real Values (Lo-byte first)
+// Transmitting DataBuf[4~7]   = 36V Charger ADC, Real Values (same A4 ADC, 36V offset and factor)
+// Transmitting DataBuf[8~11]  = 48V Charger ADC, Real Values (same A4 ADC, 48V offset and factor)
+// Transmitting DataBuf[12~15] = Pack DSG Voltage ADC, Real Values
+// Transmitting DataBuf[16~19] = Pack CHG Voltage ADC, Real Values
+// Transmitting DataBuf[20~23] = Charging Current ADC, Real Values
+// Transmitting DataBuf[24~27] = Discharging Current ADC, Real Values
+static t_uint8 Cmd_Get_All_Direct_Measurement_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    return Enqueue_Measurement_Job_By_Packet(packet, parameter, 0);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_Channel_Statistics (0xC1)
+// receiving_Data_Packet.DataLenExpected = 4 or 7
+// receiving_Data_Packet.DataBuf[0] = MeasuredFunctions (0 ~ 7), channel of the function, gates are not set (same as Direct cmds)
+//                                    0 : raw channel, statistics of reduced ADC
+// receiving_Data_Packet.DataBuf[1] = ADC channel (0 ~ 7) of MeasuredFunctions 0, not used by others
+// receiving_Data_Packet.DataBuf[2] = conversions N (Lo-byte);  receiving_Data_Packet.DataBuf[3] = (Hi-byte), 1 ~ 65535
+// receiving_Data_Packet.DataBuf[4~6] = oversampling of each conversion (optional, same as Cmd_Get_Channel_Raw_ADC)
+//=====================================================================
+// Transmitting DataLenExpected = 18, sent by main() when N conversions are done
+// Transmitting DataBuf[0~1]   = count of conversions (Lo-byte first)
+// Transmitting DataBuf[2~3]   = min Real Values
+// Transmitting DataBuf[4~5]   = max Real Values
+// Transmitting DataBuf[6~9]   = mean Real Values, Q16.16
+// Transmitting DataBuf[10~15] = sample variance, Q32.16 (Lo-byte first, 10~11 fraction, 12~15 integer)
+//                               exact but the fraction is truncated, 0 ~ 0x7FFFFFFF.FFFF (std. deviation 46341)
+// Transmitting DataBuf[16~17] = ADC overrun count, results dropped because the last one was not taken yet
+//                               and blocks overwritten while reducing, 0 means N back-to-back conversions
+static t_uint8 Cmd_Get_Channel_Statistics_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(packet->DataBuf[0] > Measured_Discharging_Current){
+        return Func_Failure;
+    }
+    return Enqueue_Measurement_Job_By_Packet(packet, parameter, 4);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_ADC_Stream_Start (0xB4)
+// receiving_Data_Packet.DataLenExpected = 4
+// receiving_Data_Packet.DataBuf[0] = ADC channel (0 ~ 7)
+// receiving_Data_Packet.DataBuf[1] = 0: single channel, 1: sequence of channels A(DataBuf[0]) ~ A0
+// receiving_Data_Packet.DataBuf[2] = sample rate S/s (Lo-byte);  receiving_Data_Packet.DataBuf[3] = (Hi-byte)
+//                                    ADC_Stream_Min_Sample_Rate ~ ADC_Stream_Max_Sample_Rate, for all channels
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code, then blocks are sent by main() as
+// Cmd_ADC_Stream_Data_Block (0xB6) until Cmd_ADC_Stream_Stop
+// Transmitting DataLenExpected = 6 + ADC_Stream_Block_Samples * 2
+// Transmitting DataBuf[0~3] = sample number of first sample (Lo-byte first), gap means lost blocks
+// Transmitting DataBuf[4~5] = dropped blocks counter (Lo-byte first), overwritten before sending
+// Transmitting DataBuf[6~]  = ADC samples (Lo-byte first)
+// measurement cmds are refused during streaming, streaming is refused while measurement jobs are queued or watching
+static t_uint8 Cmd_ADC_Stream_Start_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint16 sample_rate;
+    if(Is_Measurement_Processing() || (packet->DataBuf[1] > 1)){
+        return Func_Failure;
+    }
+    sample_rate = packet->DataBuf[2] + ((t_uint16)packet->DataBuf[3] << 8);
+    return _DUI_ADC_Stream_Start((MeasuredADCChannels)packet->DataBuf[0], packet->DataBuf[1], sample_rate);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_ADC_Stream_Stop (0xB5)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = NA
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code
+static t_uint8 Cmd_ADC_Stream_Stop_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(G_1st_Module_Function_Status & ADC_Stream_Processing){
+        _DUI_ADC_Stream_Stop();
+    }
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_ADC_Watch_Start (0xB7)
+// receiving_Data_Packet.DataLenExpected = 7
+// receiving_Data_Packet.DataBuf[0] = ADC channel (0 ~ 7)
+// receiving_Data_Packet.DataBuf[1] = sample rate S/s (Lo-byte);    receiving_Data_Packet.DataBuf[2] = (Hi-byte)
+//                                    ADC_Watch_Min_Sample_Rate ~ ADC_Watch_Max_Sample_Rate
+// receiving_Data_Packet.DataBuf[3] = low threshold ADC (Lo-byte);  receiving_Data_Packet.DataBuf[4] = (Hi-byte)
+// receiving_Data_Packet.DataBuf[5] = high threshold ADC (Lo-byte); receiving_Data_Packet.DataBuf[6] = (Hi-byte)
+//                                    low <= high <= 1023, raw 10 bits ADC without calibration
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code, then an event is sent by main() as
+// Cmd_ADC_Watch_Event (0xB9) at the first conversion and at each crossing
+// until Cmd_ADC_Watch_Stop
+// Transmitting DataLenExpected = 13
+// Transmitting DataBuf[0~3]   = sample number of the crossing (Lo-byte first), 0 is the first conversion
+// Transmitting DataBuf[4~7]   = time stamp (Lo-byte first), Timer_A_Counts_Per_MS counts per ms
+// Transmitting DataBuf[8~9]   = ADC of the crossing (Lo-byte first)
+// Transmitting DataBuf[10]    = 1:below, 2:inside, 3:above the window
+// Transmitting DataBuf[11~12] = lost events counter (Lo-byte first), events are lost if main() is late
+// measurement cmds and streaming are refused during watching
+static t_uint8 Cmd_ADC_Watch_Start_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint16 sample_rate;
+    t_uint16 low_threshold;
+    t_uint16 high_threshold;
+    if(Is_Measurement_Processing()){
+        return Func_Failure;
+    }
+    sample_rate = packet->DataBuf[1] + ((t_uint16)packet->DataBuf[2] << 8);
+    low_threshold = packet->DataBuf[3] + ((t_uint16)packet->DataBuf[4] << 8);
+    high_threshold = packet->DataBuf[5] + ((t_uint16)packet->DataBuf[6] << 8);
+    return _DUI_ADC_Watch_Start((MeasuredADCChannels)packet->DataBuf[0], sample_rate, low_threshold, high_threshold);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_ADC_Watch_Stop (0xB8)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = NA
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code, events not sent yet are discarded
+static t_uint8 Cmd_ADC_Watch_Stop_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(G_1st_Module_Function_Status & ADC_Watch_Processing){
+        _DUI_ADC_Watch_Stop();
+    }
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Test_Sequence_Upload (0xBA)
+// receiving_Data_Packet.DataLenExpected = 2+k (k = 1 ~ 29)
+// receiving_Data_Packet.DataBuf[0] = offset of bytecode (Lo-byte);  receiving_Data_Packet.DataBuf[1] = (Hi-byte)
+// receiving_Data_Packet.DataBuf[2 ~ 1+k] = k bytes of bytecode, offset + k <= Test_Sequence_Max_Length
+// bytecode is a list of TestSequenceOps with operands (Lo-byte first), see DUI_For_Peripheral_Control.h
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code, refused while the sequence is running
+static t_uint8 Cmd_Test_Sequence_Upload_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    gCdcTempUint16 = packet->DataBuf[1];
+    gCdcTempUint16 = (gCdcTempUint16 << 8) + packet->DataBuf[0];
+    return _DUI_Test_Sequence_Upload(gCdcTempUint16, packet->DataLenExpected_Low - 2, &(packet->DataBuf[2]));
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Test_Sequence_Run (0xBB)
+// receiving_Data_Packet.DataLenExpected = 4
+// receiving_Data_Packet.DataBuf[0] = length of bytecode (Lo-byte);  receiving_Data_Packet.DataBuf[1] = (Hi-byte)
+// receiving_Data_Packet.DataBuf[2] = ModBus CRC16 of bytecode (Lo-byte);  receiving_Data_Packet.DataBuf[3] = (Hi-byte)
+//=====================================================================
+// Transmitting Respond_Error_Check_Code if the bytecode is not valid, or measurement is processing
+// Transmitting by main() when the sequence stops
+// Transmitting DataLenExpected = 8+4*n
+// Transmitting DataBuf[0] = TestSequenceStatus, Seq_Status_Done if Seq_Op_End or end of bytecode is reached
+// Transmitting DataBuf[1] = offset of the op where it stops (Lo-byte);  Transmitting DataBuf[2] = (Hi-byte)
+// Transmitting DataBuf[3] = n, results of Seq_Op_Measure
+// Transmitting DataBuf[4 ~ 7] = fail bits (Lo-byte first), bit k is set if result k is outside limits of Seq_Op_Branch_Outside
+//                               or the limit table (Cmd_Limit_Table_Set), ID step is the one of the last Seq_Op_Charger
+// Transmitting DataBuf[8 ~ 7+4*n] = n x {ADC, Real Values} (Lo-byte first)
+//                                   Real Values is the reduced ADC if MeasuredFunctions is Measured_Empty
+// then the time stamp trailer of the first and the last result if Cmd_Set_Time_Stamp_Mode is set (0 if n = 0)
+// measurement cmds, streaming and watching are refused while the sequence is running
+static t_uint8 Cmd_Test_Sequence_Run_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint16 length;
+    t_uint16 crc;
+    if(Is_Measurement_Processing()){
+        return Func_Failure;
+    }
+    length = packet->DataBuf[1];
+    length = (length << 8) + packet->DataBuf[0];
+    crc = packet->DataBuf[3];
+    crc = (crc << 8) + packet->DataBuf[2];
+    return _DUI_Test_Sequence_Run(length, crc, Cmd_Test_Sequence_Run, CDC_Time_Stamp_Mode);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Test_Sequence_Result (0xBC)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = NA
+//=====================================================================
+// Transmitting the result vector of the running or the last sequence, same as Cmd_Test_Sequence_Run
+// Transmitting DataBuf[0] = Seq_Status_Running with the results so far
+static t_uint8 Cmd_Test_Sequence_Result_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    gCdcTempUint16 = _DUI_Test_Sequence_Get_Result(Comm_Temp_Transmitting_Data_Buffer);
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Test_Sequence_Result, Comm_Temp_Transmitting_Data_Buffer, gCdcTempUint16);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Test_Sequence_Stop (0xBD)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = NA
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code, the sequence stops after the conversion in progress,
+// loading and charger are turned off, then the result of Cmd_Test_Sequence_Run is sent with Seq_Status_Aborted
+static t_uint8 Cmd_Test_Sequence_Stop_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    _DUI_Test_Sequence_Abort();
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Limit_Table_Set (0xBE)
+// receiving_Data_Packet.DataLenExpected = 6 or 1
+// receiving_Data_Packet.DataBuf[0] = MeasuredFunctions (1 ~ 7)
+// receiving_Data_Packet.DataBuf[1] = Chger_ID_Steps (0 ~ 2), 1 ~ 2 only for charger functions (1 ~ 3)
+//                                    limit of step 0 is used by the steps without their own limit
+// receiving_Data_Packet.DataBuf[2] = min Real Value (Lo-byte);  receiving_Data_Packet.DataBuf[3] = (Hi-byte)
+// receiving_Data_Packet.DataBuf[4] = max Real Value (Lo-byte);  receiving_Data_Packet.DataBuf[5] = (Hi-byte)
+// DataLenExpected = 1 clears all limits of DataBuf[0], DataBuf[0] = 0 (Measured_Empty) clears the whole table
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code or Respond_Error_Check_Code
+static t_uint8 Cmd_Limit_Table_Set_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint16 min;
+    t_uint16 max;
+    if(packet->DataLenExpected_Low == 1){
+        if(packet->DataBuf[0] > Measured_Discharging_Current){
+            return Func_Failure;
+        }
+        _DUI_Limit_Table_Clear((MeasuredFunctions)packet->DataBuf[0]);
+        return Func_Success;
+    }
+    if(packet->DataLenExpected_Low != 6){
+        return Func_Failure;
+    }
+    min = packet->DataBuf[3];
+    min = (min << 8) + packet->DataBuf[2];
+    max = packet->DataBuf[5];
+    max = (max << 8) + packet->DataBuf[4];
+    return _DUI_Limit_Table_Set((MeasuredFunctions)packet->DataBuf[0], (Chger_ID_Steps)packet->DataBuf[1], min, max);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Limit_Table_Read_Back (0xBF)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = MeasuredFunctions (1 ~ 7)
+//=====================================================================
+// Transmitting DataLenExpected = 13
+// Transmitting DataBuf[0] = bit n is set if Chger_ID_Steps n has a limit
+// Transmitting DataBuf[1 + 4 * n ~ 4 + 4 * n] = {min, max} of Chger_ID_Steps n (Lo-byte first), 0 if not set
+static t_uint8 Cmd_Limit_Table_Read_Back_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint16 min;
+    t_uint16 max;
+    t_uint8 step;
+    if((packet->DataBuf[0] < Measured_24V_Chger) || (packet->DataBuf[0] > Measured_Discharging_Current)){
+        return Func_Failure;
+    }
+    Comm_Temp_Transmitting_Data_Buffer[0] = 0;
+    for(step = Chger_ID_OFF; step <= Chger_ID_2nd_Step; step++){
+        min = 0;
+        max = 0;
+        if(_DUI_Limit_Table_Get((MeasuredFunctions)packet->DataBuf[0], (Chger_ID_Steps)step, &min, &max) == Func_Success){
+            Comm_Temp_Transmitting_Data_Buffer[0] |= (1 << step);
+        }
+        Comm_Temp_Transmitting_Data_Buffer[1 + step * 4] = min;
+        Comm_Temp_Transmitting_Data_Buffer[2 + step * 4] = min >> 8;
+        Comm_Temp_Transmitting_Data_Buffer[3 + step * 4] = max;
+        Comm_Temp_Transmitting_Data_Buffer[4 + step * 4] = max >> 8;
+    }
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Limit_Table_Read_Back, Comm_Temp_Transmitting_Data_Buffer, 13);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Set_Verdict_Mode (0xC0)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0 : values only (default)
+//                                    1 : values, then 2 bytes of verdict
+//                                    2 : 2 bytes of verdict only
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code or Respond_Error_Check_Code
+// verdict of the later measurement cmds with Real Values (not Cmd_Get_Channel_Raw_ADC) :
+// verdict DataBuf[0] = fail bits, verdict DataBuf[1] = checked bits (the value has a limit)
+// bit n is the n-th {ADC, Real Values} of the response, charger auto cmds use the limit of each ID step
+static t_uint8 Cmd_Set_Verdict_Mode_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(packet->DataBuf[0] > Job_Verdict_Only){
+        return Func_Failure;
+    }
+    CDC_Verdict_Mode = packet->DataBuf[0];
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_Time_Stamp (0xC2)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = NA
+//=====================================================================
+// Transmitting DataLenExpected = 6
+// Transmitting DataBuf[0~3] = free running time stamp of Timer A when the cmd is handled (Lo-byte first), wraps around 32 bits
+// Transmitting DataBuf[4] = Timer_A_Counts_Per_MS(Lo-byte); Transmitting DataBuf[5] = Timer_A_Counts_Per_MS(Hi-byte)
+// host aligns its clock by the middle of the round trip
+static t_uint8 Cmd_Get_Time_Stamp_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint32 time_stamp;
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Charger_24V_Channel_Set_ID     (0x8A)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:Chger_ID_OFF, 1:Chger_ID_1st_Step, 2:Chger_ID_2nd_Step
-            //=====================================================================
-            // Transmitting DataLenExpected = NA
-            // Transmitting DataBuf[0] = NA(Lo-byte);      Transmitting DataBuf[1] = NA(Hi-byte)
-            case Cmd_Charger_24V_Channel_Set_ID:
-                if(((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1))
-                   || (receiving_Data_Packet.DataBuf[0] >= 3)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_24V_Channel_Set_ID,&(gCdcTempUint8), 1);
-                    break;
-                }
-                if(receiving_Data_Packet.DataBuf[0] == 0){
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
-                }else{
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_24V_Ch, (Chger_ID_Steps)receiving_Data_Packet.DataBuf[0]);
-                }
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_24V_Channel_Set_ID,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Charger_36V_Channel_Set_ID     (0x8B)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:Chger_ID_OFF, 1:Chger_ID_1st_Step, 2:Chger_ID_2nd_Step
-            //=====================================================================
-            // Transmitting DataLenExpected = NA
-            // Transmitting DataBuf[0] = NA(Lo-byte);      Transmitting DataBuf[1] = NA(Hi-byte)
-            case Cmd_Charger_36V_Channel_Set_ID:
-                if(((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1))
-                   || (receiving_Data_Packet.DataBuf[0] >= 3)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_36V_Channel_Set_ID,&(gCdcTempUint8), 1);
-                    break;
-                }
-                if(receiving_Data_Packet.DataBuf[0] == 0){
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
-                }else{
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_36V_Ch, (Chger_ID_Steps)receiving_Data_Packet.DataBuf[0]);
-                }
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_36V_Channel_Set_ID,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Charger_48V_Channel_Set_ID     (0x8C)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:Chger_ID_OFF, 1:Chger_ID_1st_Step, 2:Chger_ID_2nd_Step
-            //=====================================================================
-            // Transmitting DataLenExpected = NA
-            // Transmitting DataBuf[0] = NA(Lo-byte);      Transmitting DataBuf[1] = NA(Hi-byte)
-            case Cmd_Charger_48V_Channel_Set_ID:
-                if(((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1))
-                   || (receiving_Data_Packet.DataBuf[0] >= 3)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_48V_Channel_Set_ID,&(gCdcTempUint8), 1);
-                    break;
-                }
-                if(receiving_Data_Packet.DataBuf[0] == 0){
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
-                }else{
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_48V_Ch, (Chger_ID_Steps)receiving_Data_Packet.DataBuf[0]);
-                }
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_48V_Channel_Set_ID,&(gCdcTempUint8), 1);
-                break;
+    time_stamp = _Device_Get_TimerA_Time_Stamp();
+    Comm_Temp_Transmitting_Data_Buffer[0] = time_stamp;
+    Comm_Temp_Transmitting_Data_Buffer[1] = time_stamp >> 8;
+    Comm_Temp_Transmitting_Data_Buffer[2] = time_stamp >> 16;
+    Comm_Temp_Transmitting_Data_Buffer[3] = time_stamp >> 24;
+    Comm_Temp_Transmitting_Data_Buffer[4] = Timer_A_Counts_Per_MS & 0x00ff;
+    Comm_Temp_Transmitting_Data_Buffer[5] = Timer_A_Counts_Per_MS >> 8;
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Time_Stamp, Comm_Temp_Transmitting_Data_Buffer, 6);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Set_Time_Stamp_Mode (0xC3)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0 : no time stamp (default)
+//                                    1 : time stamp trailer after the later measurement responses
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code or Respond_Error_Check_Code
+// trailer of measurement cmds (after the verdict if any) and Cmd_Test_Sequence_Run / Cmd_Test_Sequence_Result :
+// trailer DataBuf[0~3] = time stamp of ADC start of the first conversion (Lo-byte first)
+// trailer DataBuf[4~7] = time stamp of DMA done of the last conversion (Lo-byte first)
+// same counter as Cmd_Get_Time_Stamp, the USB latency is not in the time stamps
+static t_uint8 Cmd_Set_Time_Stamp_Mode_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(packet->DataBuf[0] > 1){
+        return Func_Failure;
+    }
+    CDC_Time_Stamp_Mode = packet->DataBuf[0];
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_UART_Overrun_Count (0xC4)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = NA
+//=====================================================================
+// Transmitting DataLenExpected = 4
+// Transmitting DataBuf[0] = RS485 overrun count(Lo-byte);      Transmitting DataBuf[1] = RS485 overrun count(Hi-byte)
+// Transmitting DataBuf[2] = One wire overrun count(Lo-byte);   Transmitting DataBuf[3] = One wire overrun count(Hi-byte)
+// received bytes dropped by full receiving ring since power on, wraps around 16 bits
+static t_uint8 Cmd_Get_UART_Overrun_Count_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    gCdcTempUint16 = _DUI_Get_Comm_Module_Receiving_Overrun_Count(Uart_RS485_Module);
+    Comm_Temp_Transmitting_Data_Buffer[0] = gCdcTempUint16 & 0x00ff;
+    Comm_Temp_Transmitting_Data_Buffer[1] = gCdcTempUint16 >> 8;
+    gCdcTempUint16 = _DUI_Get_Comm_Module_Receiving_Overrun_Count(One_Wire_Module);
+    Comm_Temp_Transmitting_Data_Buffer[2] = gCdcTempUint16 & 0x00ff;
+    Comm_Temp_Transmitting_Data_Buffer[3] = gCdcTempUint16 >> 8;
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_UART_Overrun_Count, Comm_Temp_Transmitting_Data_Buffer, 4);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_UART_Set_Frame_End_Mode (0xC5)
+// receiving_Data_Packet.DataLenExpected = 2 or 4
+// receiving_Data_Packet.DataBuf[0] = 0 : RS485, 1 : One wire
+// receiving_Data_Packet.DataBuf[1] = 0 : gap of silence only (default)
+//                                    1 : LEV packet, by 0x3A leading code and length field
+//                                    2 : by 0x0D 0x0A end code
+//                                    3 : by one wire end check code 0x70F7
+// receiving_Data_Packet.DataBuf[2] = gap ms(Lo-byte);  receiving_Data_Packet.DataBuf[3] = gap ms(Hi-byte)
+//                                    0 or not given : Modbus t3.5 of the baud rate
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code or Respond_Error_Check_Code
+// the gap ends a frame in every mode, it takes effect by the next enable cmd of the module
+static t_uint8 Cmd_UART_Set_Frame_End_Mode_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    gCdcTempUint16 = 0;
+    if(packet->DataLenExpected_Low == 4){
+        gCdcTempUint16 = packet->DataBuf[3];
+        gCdcTempUint16 = (gCdcTempUint16 << 8) + packet->DataBuf[2];
+    }else if(packet->DataLenExpected_Low != 2){
+        return Func_Failure;
+    }
+    return _DUI_Set_Comm_Module_Frame_End_Mode(packet->DataBuf[0], packet->DataBuf[1], gCdcTempUint16);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_UART_Transaction (0xC6)
+// receiving_Data_Packet.DataLenExpected = 8 ~ 31
+// receiving_Data_Packet.DataBuf[0] = 0 : RS485, 1 : One wire
+// receiving_Data_Packet.DataBuf[1] = timeout ms of each attempt after the payload is sent(Lo-byte);  receiving_Data_Packet.DataBuf[2] = (Hi-byte)
+// receiving_Data_Packet.DataBuf[3] = retries, attempts after the first one for timeout or short reply
+// receiving_Data_Packet.DataBuf[4] = expected reply length(Lo-byte);  receiving_Data_Packet.DataBuf[5] = (Hi-byte)
+//                                    0 : reply ends by frame end detection
+// receiving_Data_Packet.DataBuf[6] = frame end mode of the reply as Cmd_UART_Set_Frame_End_Mode, 0xFF : mode of the module
+// receiving_Data_Packet.DataBuf[7 ~ ] = payload to transmit
+//=====================================================================
+// Transmitting Respond_Error_Check_Code if a transaction is running, parameters are not valid or TX ring is full
+// Transmitting by main() when the reply is received or the last attempt is timeout
+// Transmitting DataLenExpected = 6+n
+// Transmitting DataBuf[0] = Comm_Transaction_Status, 0 : OK, 1 : timeout, 2 : short reply
+// Transmitting DataBuf[1] = attempts
+// Transmitting DataBuf[2 ~ 5] = elapsed time from the first transmitting in Timer A counts (Lo-byte first), Timer_A_Counts_Per_MS per ms
+// Transmitting DataBuf[6 ~ 5+n] = reply bytes, n = 0 if timeout
+// bytes received before transmitting are dropped, the reply is not sent as Cmd_UART_RS485_Receive_Data / Cmd_One_Wire_Receive_Data
+static t_uint8 Cmd_UART_Transaction_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint16 timeout_ms;
+    t_uint16 expected_length;
 
-            ///////////////////////////////////////////////////////////////////////
-            // Get_Charger_24V_Voltage_Auto     (0x8D)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 12
-            // Transmitting DataBuf[0] = ID off, ADC(Lo-byte);      Transmitting DataBuf[1] = ID off, ADC(Hi-byte)
-            // Transmitting DataBuf[2] = ID off, Real-mV(Lo-byte);  Transmitting DataBuf[3] = ID off, Real-mV(Hi-byte)
-            // Transmitting DataBuf[4] = ID L1, ADC(Lo-byte);       Transmitting DataBuf[5] = ID L1, ADC(Hi-byte)
-            // Transmitting DataBuf[6] = ID L1, Real-mV(Lo-byte);   Transmitting DataBuf[7] = ID L1, Real-mV(Hi-byte)
-            // Transmitting DataBuf[8] = ID L2, ADC(Lo-byte);       Transmitting DataBuf[9] = ID L2, ADC(Hi-byte)
-            // Transmitting DataBuf[10] = ID L2, Real-mV(Lo-byte);  Transmitting DataBuf[11] = ID L2, Real-mV(Hi-byte)
-            case Cmd_Get_Charger_24V_Voltage_Auto:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                     G_Module_Function_Status &= ~(Charger_ID_Level_1_Check + Charger_ID_Level_2_Check);
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Charger_24V_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_24V_Voltage_Auto,&(gCdcTempUint8), 1);
-                }
-///
-//                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_24V_Voltage, Comm_Temp_Transmitting_Data_Buffer, 4);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Charger_36V_Voltage_Auto     (0x8E)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 12
-            // Transmitting DataBuf[0] = ID off, ADC(Lo-byte);      Transmitting DataBuf[1] = ID off, ADC(Hi-byte)
-            // Transmitting DataBuf[2] = ID off, Real-mV(Lo-byte);  Transmitting DataBuf[3] = ID off, Real-mV(Hi-byte)
-            // Transmitting DataBuf[4] = ID L1, ADC(Lo-byte);       Transmitting DataBuf[5] = ID L1, ADC(Hi-byte)
-            // Transmitting DataBuf[6] = ID L1, Real-mV(Lo-byte);   Transmitting DataBuf[7] = ID L1, Real-mV(Hi-byte)
-            // Transmitting DataBuf[8] = ID L2, ADC(Lo-byte);       Transmitting DataBuf[9] = ID L2, ADC(Hi-byte)
-            // Transmitting DataBuf[10] = ID L2, Real-mV(Lo-byte);  Transmitting DataBuf[11] = ID L2, Real-mV(Hi-byte)
-            case Cmd_Get_Charger_36V_Voltage_Auto:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                     G_Module_Function_Status &= ~(Charger_ID_Level_1_Check + Charger_ID_Level_2_Check);
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Charger_36V_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_36V_Voltage_Auto,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Charger_48V_Voltage_Auto     (0x8F)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 12
-            // Transmitting DataBuf[0] = ID off, ADC(Lo-byte);      Transmitting DataBuf[1] = ID off, ADC(Hi-byte)
-            // Transmitting DataBuf[2] = ID off, Real-mV(Lo-byte);  Transmitting DataBuf[3] = ID off, Real-mV(Hi-byte)
-            // Transmitting DataBuf[4] = ID L1, ADC(Lo-byte);       Transmitting DataBuf[5] = ID L1, ADC(Hi-byte)
-            // Transmitting DataBuf[6] = ID L1, Real-mV(Lo-byte);   Transmitting DataBuf[7] = ID L1, Real-mV(Hi-byte)
-            // Transmitting DataBuf[8] = ID L2, ADC(Lo-byte);       Transmitting DataBuf[9] = ID L2, ADC(Hi-byte)
-            // Transmitting DataBuf[10] = ID L2, Real-mV(Lo-byte);  Transmitting DataBuf[11] = ID L2, Real-mV(Hi-byte)
-            case Cmd_Get_Charger_48V_Voltage_Auto:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                     G_Module_Function_Status &= ~(Charger_ID_Level_1_Check + Charger_ID_Level_2_Check);
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Charger_48V_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_48V_Voltage_Auto,&(gCdcTempUint8), 1);
-                }
-                break;
+    timeout_ms = packet->DataBuf[2];
+    timeout_ms = (timeout_ms << 8) + packet->DataBuf[1];
+    expected_length = packet->DataBuf[5];
+    expected_length = (expected_length << 8) + packet->DataBuf[4];
+    return _DUI_Comm_Transaction_Start(packet->DataBuf[0], timeout_ms, packet->DataBuf[3], expected_length, packet->DataBuf[6],
+                                       &(packet->DataBuf[7]), packet->DataLenExpected_Low - 7, Cmd_UART_Transaction);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Modbus_Read_Plan (0xC7)
+// receiving_Data_Packet.DataLenExpected = 8, 12, 16 ~ 28
+// receiving_Data_Packet.DataBuf[0] = slave address 1 ~ 247
+// receiving_Data_Packet.DataBuf[1] = timeout ms of each attempt(Lo-byte);  receiving_Data_Packet.DataBuf[2] = (Hi-byte)
+// receiving_Data_Packet.DataBuf[3] = retries of each request, for timeout, CRC error or bad reply
+// receiving_Data_Packet.DataBuf[4 + 4n] = function of entry n, 0x03 : holding registers, 0x04 : input registers
+// receiving_Data_Packet.DataBuf[5 + 4n] = start address(Lo-byte);  receiving_Data_Packet.DataBuf[6 + 4n] = (Hi-byte)
+// receiving_Data_Packet.DataBuf[7 + 4n] = quantity 1 ~ 32
+// up to 6 entries and 64 registers
+//=====================================================================
+// Transmitting Respond_Error_Check_Code if a transaction is running, parameters are not valid or TX ring is full
+// Transmitting by main() when the last entry is read or a request is failed
+// Transmitting DataLenExpected = 8+2n
+// Transmitting DataBuf[0] = Comm_Transaction_Status, 0 : OK, 1 : timeout, 4 : CRC error, 5 : bad reply, 6 : exception
+// Transmitting DataBuf[1] = entries done
+// Transmitting DataBuf[2] = exception code of the slave
+// Transmitting DataBuf[3] = attempts of all requests
+// Transmitting DataBuf[4 ~ 7] = elapsed time from the first transmitting in Timer A counts (Lo-byte first), Timer_A_Counts_Per_MS per ms
+// Transmitting DataBuf[8 ~ 7+2n] = registers of the entries done (Lo-byte first)
+static t_uint8 Cmd_Modbus_Read_Plan_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if((packet->DataLenExpected_Low - 4) % Modbus_Read_Plan_Entry_Size){
+        return Func_Failure;
+    }
+    gCdcTempUint16 = packet->DataBuf[2];
+    gCdcTempUint16 = (gCdcTempUint16 << 8) + packet->DataBuf[1];
+    return _DUI_Modbus_Read_Plan_Start(packet->DataBuf[0], gCdcTempUint16, packet->DataBuf[3], &(packet->DataBuf[4]),
+                                       (packet->DataLenExpected_Low - 4) / Modbus_Read_Plan_Entry_Size, Cmd_Modbus_Read_Plan);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Modbus_Write (0xC8)
+// receiving_Data_Packet.DataLenExpected = 9 ~ 29
+// receiving_Data_Packet.DataBuf[0] = slave address 1 ~ 247
+// receiving_Data_Packet.DataBuf[1] = timeout ms of each attempt(Lo-byte);  receiving_Data_Packet.DataBuf[2] = (Hi-byte)
+// receiving_Data_Packet.DataBuf[3] = retries, for timeout, CRC error or bad reply
+// receiving_Data_Packet.DataBuf[4] = function, 0x06 : single register, 0x10 : multiple registers (1 ~ 11)
+// receiving_Data_Packet.DataBuf[5] = start address(Lo-byte);  receiving_Data_Packet.DataBuf[6] = (Hi-byte)
+// receiving_Data_Packet.DataBuf[7 ~ ] = registers (Lo-byte first)
+//=====================================================================
+// Transmitting Respond_Error_Check_Code if a transaction is running, parameters are not valid or TX ring is full
+// Transmitting by main() when the slave replies or the last attempt is failed
+// Transmitting DataLenExpected = 8, as Cmd_Modbus_Read_Plan, DataBuf[1] = 1 if written
+static t_uint8 Cmd_Modbus_Write_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint16 timeout_ms;
+    t_uint16 start_address;
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Charger_24V_Channel_Set_Vin     (0xA0)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:turn off Channel, 1:Turn on Channel
-            case Cmd_Charger_24V_Channel_Set_Vin:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_24V_Channel_Set_Vin,&(gCdcTempUint8), 1);
-                    break;
-                }
-                if(receiving_Data_Packet.DataBuf[0] == 0){
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
-                }else{
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_24V_Ch, Chger_ID_OFF);
-                }
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_24V_Channel_Set_Vin,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Charger_36V_Channel_Set_Vin     (0xA1)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:turn off Channel, 1:Turn on Channel
-            case Cmd_Charger_36V_Channel_Set_Vin:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_36V_Channel_Set_Vin,&(gCdcTempUint8), 1);
-                    break;
-                }
-                if(receiving_Data_Packet.DataBuf[0] == 0){
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
-                }else{
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_36V_Ch, Chger_ID_OFF);
-                }
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_36V_Channel_Set_Vin,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Charger_48V_Channel_Set_Vin     (0xA2)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:turn off Channel, 1:Turn on Channel
-            case Cmd_Charger_48V_Channel_Set_Vin:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_48V_Channel_Set_Vin,&(gCdcTempUint8), 1);
-                    break;
-                }
-                if(receiving_Data_Packet.DataBuf[0] == 0){
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
-                }else{
-                    _DUI_SwitchChargerInputAndIDStep(Switch_To_48V_Ch, Chger_ID_OFF);
-                }
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_48V_Channel_Set_Vin,&(gCdcTempUint8), 1);
-                break;
+    if((packet->DataLenExpected_Low - 7) % 2){
+        return Func_Failure;
+    }
+    timeout_ms = packet->DataBuf[2];
+    timeout_ms = (timeout_ms << 8) + packet->DataBuf[1];
+    start_address = packet->DataBuf[6];
+    start_address = (start_address << 8) + packet->DataBuf[5];
+    return _DUI_Modbus_Write_Start(packet->DataBuf[0], timeout_ms, packet->DataBuf[3], packet->DataBuf[4], start_address,
+                                   &(packet->DataBuf[7]), (packet->DataLenExpected_Low - 7) / 2, Cmd_Modbus_Write);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_UART_Bridge_Enter (0xC9)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = 0 : RS485, 1 : One wire, enabled by Cmd_UART_RS485_Enable / Cmd_One_Wire_Commu_Enable
+//=====================================================================
+// Transmitting Respond_Error_Check_Code if a transaction is running
+// Transmitting Respond_Accept_Check_Code, then bytes of host are sent to the module and bytes of the module are sent to host as they are,
+// in chunks of 64 bytes or after 1 ms of silence
+// host sends bytes after the accept code, ADC streaming and watch events are stopped before
+// the bridge is left by Cmd_UART_Bridge_Exit or the SendBreak request of host, frames of the other module are sent after that
+// escape rule : bytes of host are scanned for a whole Cmd_UART_Bridge_Exit frame (0x3A, 0xA6 or 0xA7 with sequence ID, 0xCA,
+// length, data, checkSum16, 0x0D 0x0A) wherever it is in USB packets, bytes before it are sent to the module and the bytes
+// from it are parsed as cmds, payload with such a frame is sent by Cmd_UART_RS485_Transmit_Data out of the bridge;
+// bytes from 0x3A are held while they may be the exit frame, until a byte does not match or CDC_Bridge_Exit_Hold_MS
+// without more bytes of host
+static t_uint8 Cmd_UART_Bridge_Enter_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(_DUI_Set_Comm_Module_Bridge(packet->DataBuf[0], 1) != Func_Success){
+        return Func_Failure;
+    }
+    start_CDC_Bridge_Exit_Scan();
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_UART_Bridge_Exit (0xCA)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = NA
+//=====================================================================
+// Transmitting Respond_Accept_Check_Code
+// the bridge is left when the cmd is received, after bytes of host before it are sent to the module,
+// it is found in the middle of bridged bytes too, see the escape rule of Cmd_UART_Bridge_Enter,
+// bytes of the module are sent by Cmd_UART_RS485_Receive_Data / Cmd_One_Wire_Receive_Data again
+static t_uint8 Cmd_UART_Bridge_Exit_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_I2C_Transmit_Data, Cmd_I2C_Receive_Data
+// Cmd_UART_RS485_Receive_Data (not here to do)
+// Cmd_One_Wire_Transmit_Data (no function to do), Cmd_One_Wire_Receive_Data (not here to do)
+// receiving_Data_Packet.DataLenExpected
+// receiving_Data_Packet.DataBuf[n]
+static t_uint8 Cmd_Not_Supported_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    return Func_Failure;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_UART_RS485_Transmit_Data
+// receiving_Data_Packet.DataLenExpected
+// receiving_Data_Packet.DataBuf[n]
+//=====
+// Respond_Error_Check_Code if the TX ring of RS485 is full, nothing is sent then
+static t_uint8 Cmd_UART_RS485_Transmit_Data_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    gCdcTempUint16 = packet->DataLenExpected_High;
+    gCdcTempUint16 = (gCdcTempUint16 << 8) + packet->DataLenExpected_Low;
+    return _DUI_Communication_Send_Bytes(Uart_RS485_Module, &(packet->DataBuf[0]), gCdcTempUint16);
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Cal_Set_Charger_24V_Channel_Offset  (0xD0)
+// Cmd_Cal_Set_Charger_36V_Channel_Offset  (0xD1)
+// Cmd_Cal_Set_Charger_48V_Channel_Offset  (0xD2)
+// Cmd_Cal_Set_PACK_DSG_Vol_CAL_ADC_offset  (0xD6)
+// Cmd_Cal_Set_PACK_CHG_Vol_CAL_ADC_offset  (0xD7)
+// Cmd_Cal_Set_DSG_Current_CAL_ADC_offset  (0xD8)
+// Cmd_Cal_Set_CHG_Current_CAL_ADC_offset  (0xD9)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = set Cal_Offset_Data
+// parameter = flash offset of the calibration data
+//=====================================================================
+// Transmitting DataLenExpected = 1
+// Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
+static t_uint8 Cmd_Cal_Set_Offset_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    WriteDataToFlash(parameter, &(packet->DataBuf[0]), 1);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_All_Calibration_Data           (0xD3)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = N/A
+//=====================================================================
+// Transmitting DataLenExpected = 7
+// Transmitting DataBuf[0] = FA_24V_CAL_OFFSET_ADC;
+// Transmitting DataBuf[1] = FA_36V_CAL_OFFSET_ADC;
+// Transmitting DataBuf[2] = FA_48V_CAL_OFFSET_ADC;
+// Transmitting DataBuf[3] = FA_Pack_DSG_CAL_OFFSET_ADC;
+// Transmitting DataBuf[4] = FA_Pack_CHG_CAL_OFFSET_ADC;
+// Transmitting DataBuf[5] = FA_DSG_Current_CAL_OFFSET_ADC;
+// Transmitting DataBuf[6] = FA_CHG_Current_CAL_OFFSET_ADC;
+static t_uint8 Cmd_Get_All_Calibration_Data_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    gCdcTempUint8_ptr = (t_uint8 *)(Flash_segment_C + FA_24V_CAL_OFFSET_ADC_offset);
+    for(gCdcTempUint16 = 0; gCdcTempUint16 < 5; gCdcTempUint16++){
+        Comm_Temp_Transmitting_Data_Buffer[gCdcTempUint16] = (*gCdcTempUint8_ptr++);
+    }
+    Comm_Temp_Transmitting_Data_Buffer[5] = FA_DSG_Current_CAL_OFFSET_ADC;
+    Comm_Temp_Transmitting_Data_Buffer[6] = FA_CHG_Current_CAL_OFFSET_ADC;
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_All_Calibration_Data, Comm_Temp_Transmitting_Data_Buffer, 7);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_All_Flash_Data           (0xD4)
+// receiving_Data_Packet.DataLenExpected = 1
+// receiving_Data_Packet.DataBuf[0] = N/A
+//=====================================================================
+// Transmitting DataLenExpected = 128
+// Transmitting DataBuf[0]~ Transmitting DataBuf[127] : flash data
+static t_uint8 Cmd_Get_All_Flash_Data_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    gCdcTempUint8_ptr = (t_uint8 *)(Flash_segment_C);
+    for(gCdcTempUint16 = 0; gCdcTempUint16 < Flash_segment_Size; gCdcTempUint16++){
+        Comm_Temp_Transmitting_Data_Buffer[gCdcTempUint16] = (*gCdcTempUint8_ptr++);
+    }
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_All_Flash_Data,Comm_Temp_Transmitting_Data_Buffer, Flash_segment_Size);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Set_Cal_Data_To_Flash               (0xD5)
+// receiving_Data_Packet.DataLenExpected = 2+n
+// receiving_Data_Packet.DataBuf[0] = Cal_Write_Data_Offset
+// receiving_Data_Packet.DataBuf[1] = Cal_Write_Data_Length(n)
+// receiving_Data_Packet.DataBuf[2 ~ 1+n] = Cal_Write_Data (Lo-byte first)
+//=====================================================================
+// Transmitting DataLenExpected = 1
+// Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
+static t_uint8 Cmd_Set_Cal_Data_To_Flash_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if((packet->DataBuf[1] + 2) != packet->DataLenExpected_Low){
+        return Func_Failure;
+    }
+    WriteDataToFlash(packet->DataBuf[0], &(packet->DataBuf[2]), packet->DataBuf[1]);
+    _DUI_Update_Real_Value_Multipliers();
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Cal_Table_Upload                    (0xDA)
+// receiving_Data_Packet.DataLenExpected = 3+4*k (k = 1 ~ 7)
+// receiving_Data_Packet.DataBuf[0] = MeasuredFunctions (1 ~ 7)
+// receiving_Data_Packet.DataBuf[1] = Points of the whole table (2 ~ 8)
+// receiving_Data_Packet.DataBuf[2] = index of the first point in this packet, 0 starts a new table
+// receiving_Data_Packet.DataBuf[3 ~ 2+4*k] = k x {ADC, Real Value} (Lo-byte first)
+// a table of 8 points is larger than CDC_Receiving_Max_Data_Length, it is uploaded by 2 packets
+//=====================================================================
+// Transmitting DataLenExpected = 1
+// Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
+static t_uint8 Cmd_Cal_Table_Upload_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if(((packet->DataLenExpected_Low - 3) & 0x03) != 0){
+        return Func_Failure;
+    }
+    return _DUI_Cal_Table_Upload((MeasuredFunctions)packet->DataBuf[0], packet->DataBuf[1], packet->DataBuf[2],
+                                 (packet->DataLenExpected_Low - 3) >> 2, &(packet->DataBuf[3]));
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Cal_Table_Read_Back                 (0xDB)
+// receiving_Data_Packet.DataLenExpected = 2
+// receiving_Data_Packet.DataBuf[0] = MeasuredFunctions (1 ~ 7)
+// receiving_Data_Packet.DataBuf[1] = 0 : uploaded table, 1 : table in flash
+//=====================================================================
+// Transmitting DataLenExpected = 1+Cal_Table_Record_Size
+// Transmitting DataBuf[0] = uploaded table : 1 = all points are uploaded
+//                           table in flash : 1 = the table is in use
+// Transmitting DataBuf[1 ~ Cal_Table_Record_Size] = Cal_Table_Record (Lo-byte first)
+static t_uint8 Cmd_Cal_Table_Read_Back_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    if((packet->DataBuf[0] < Measured_24V_Chger) || (packet->DataBuf[0] > Measured_Discharging_Current)){
+        return Func_Failure;
+    }
+    if(packet->DataBuf[1]){
+        Comm_Temp_Transmitting_Data_Buffer[0] = _DUI_Cal_Table_Is_Active((MeasuredFunctions)packet->DataBuf[0]);
+    }else{
+        Comm_Temp_Transmitting_Data_Buffer[0] = _DUI_Cal_Table_Is_Uploaded();
+    }
+    gCdcTempUint8_ptr = (t_uint8 *)_DUI_Cal_Table_Get((MeasuredFunctions)packet->DataBuf[0], packet->DataBuf[1]);
+    for(gCdcTempUint16 = 1; gCdcTempUint16 <= Cal_Table_Record_Size; gCdcTempUint16++){
+        Comm_Temp_Transmitting_Data_Buffer[gCdcTempUint16] = (*gCdcTempUint8_ptr++);
+    }
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Table_Read_Back, Comm_Temp_Transmitting_Data_Buffer, 1 + Cal_Table_Record_Size);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Cal_Table_Activate                  (0xDC)
+// receiving_Data_Packet.DataLenExpected = 2
+// receiving_Data_Packet.DataBuf[0] = MeasuredFunctions (1 ~ 7)
+// receiving_Data_Packet.DataBuf[1] = 1 : write the uploaded table to flash and use it
+//                                    0 : erase the table, back to offset and mV(mA)_To_ADC_Factor
+//=====================================================================
+// Transmitting DataLenExpected = 1
+// Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
+static t_uint8 Cmd_Cal_Table_Activate_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    return _DUI_Cal_Table_Activate((MeasuredFunctions)packet->DataBuf[0], (packet->DataBuf[1] != 0));
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Test_Data_Send_Back   (0xE2)
+// receiving_Data_Packet.DataLenExpected
+// receiving_Data_Packet.DataBuf[n]
+static t_uint8 Cmd_Test_Data_Send_Back_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    gCdcTempUint16 = packet->DataLenExpected_High;
+    gCdcTempUint16 = (gCdcTempUint16 << 8) + packet->DataLenExpected_Low;
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Test_Data_Send_Back,&(packet->DataBuf[0]), gCdcTempUint16);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_HW_FW_Version           (0xE5)
+// receiving_Data_Packet.DataLenExpected = 0
+// receiving_Data_Packet.DataBuf[0] = N/A
+//=====================================================================
+// Transmitting DataLenExpected = 6
+// Transmitting DataBuf[0] = FA_VERSION;
+// Transmitting DataBuf[1] = FA_MINOR_VERSION;
+// Transmitting DataBuf[2] = FA_EEPROM_VERSION;
+// Transmitting DataBuf[3] = FA_RESERVED_VERSION;
+// Transmitting DataBuf[4] = FA_HW_Version;
+// Transmitting DataBuf[5] = FA_HW_MINOR_Version;
+static t_uint8 Cmd_FW_HW_Version_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    Comm_Temp_Transmitting_Data_Buffer[0] = FA_VERSION;
+    Comm_Temp_Transmitting_Data_Buffer[1] = FA_MINOR_VERSION;
+    Comm_Temp_Transmitting_Data_Buffer[2] = FA_EEPROM_VERSION;
+    Comm_Temp_Transmitting_Data_Buffer[3] = FA_RESERVED_VERSION;
+    Comm_Temp_Transmitting_Data_Buffer[4] = FA_HW_Version;
+    Comm_Temp_Transmitting_Data_Buffer[5] = FA_HW_MINOR_Version;
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_FW_HW_Version,Comm_Temp_Transmitting_Data_Buffer, 6);
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_SetDetectCharger_DelayCycle           (0xE6)
+// receiving_Data_Packet.DataLenExpected = 2
+// receiving_Data_Packet.DataBuf[0] = Delay Cycles (Lo bytes)
+// receiving_Data_Packet.DataBuf[1] = Delay Cycles (Hi bytes)
+//=====================================================================
+// Transmitting DataLenExpected = 1
+// Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
+static t_uint8 Cmd_SetDetectCharger_DelayCycle_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    G_Temp_1_DelayCycles = packet->DataBuf[1];
+    G_Temp_1_DelayCycles = (G_Temp_1_DelayCycles << 8) + packet->DataBuf[0];
+    return Func_Success;
+}
+///////////////////////////////////////////////////////////////////////
+// Cmd_Get_Command_Statistics           (0xE7)
+// receiving_Data_Packet.DataLenExpected = 0 ~ 2
+// receiving_Data_Packet.DataBuf[0] = 1: clear statistics after reading (optional)
+// receiving_Data_Packet.DataBuf[1] = index of the first command in CDC_Command_Table (optional, 0 if not in packet)
+//=====================================================================
+// Transmitting DataLenExpected = 6 + 9 * (commands from the first one, CDC_Command_Stats_Per_Packet at most)
+// the table is read by pages of CDC_Command_Stats_Per_Packet commands, a shorter page is the last one
+// Transmitting DataBuf[0] = unknown cmd count(Lo-byte);  Transmitting DataBuf[1] = unknown cmd count(Hi-byte)
+// Transmitting DataBuf[2] = Timer_A_Counts_Per_MS(Lo-byte); Transmitting DataBuf[3] = Timer_A_Counts_Per_MS(Hi-byte)
+// Transmitting DataBuf[4] = async overflow count(Lo-byte); Transmitting DataBuf[5] = async overflow count(Hi-byte)
+//                           async cmds accepted while all latency slots were used, their latency is not counted
+// for each command, Lo-byte first :
+// Transmitting DataBuf[n] = cmd
+// Transmitting DataBuf[n+1 ~ n+2] = hit count
+// Transmitting DataBuf[n+3 ~ n+4] = error count
+// Transmitting DataBuf[n+5 ~ n+8] = accumulated latency, Timer A counts
+static t_uint8 Cmd_Get_Command_Statistics_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter);
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Charger_All_Channel_ID_Set_OFF      (0xA3)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            case Cmd_Charger_All_Channel_ID_Set_OFF:
-                _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_All_Channel_ID_Set_OFF,&(gCdcTempUint8), 1);
-                break;
-//            ///////////////////////////////////////////////////////////////////////
-//            // Cmd_Charger_All_Channel_Set_Vin     (0xA4)
-//            // receiving_Data_Packet.DataLenExpected = 1
-//            // receiving_Data_Packet.DataBuf[0] = 0:turn off Channel, 1:Turn on Channel
-//            case Cmd_Charger_All_Channel_Set_Vin:
-//                if(receiving_Data_Packet.DataBuf[0] == 0){
-//                    _DUI_Set_Charger_Channel(CHG_OFF_Channel);
-//                }else{
-//                    _DUI_Set_Charger_Channel(CHG_ON_Channel);
-//                }
-//                gCdcTempUint8 = Respond_Accept_Check_Code;
-//                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Charger_All_Channel_Set_Vin,&(gCdcTempUint8), 1);
-//                break;
+//////////////////////////////////////////////////
+// Command handlers : (section stop)
+//////////////////////////////////////////////////
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_All_Charger_Channel_Voltage (0xA5)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 12
-            // Transmitting DataBuf[0] = 24V ADC(Lo-byte);      Transmitting DataBuf[1] = 24V ADC(Hi-byte)
-            // Transmitting DataBuf[2] = 24V real-mV(Lo-byte);  Transmitting DataBuf[3] = 24V real-mV(Hi-byte)
-            // Transmitting DataBuf[4] = 36V ADC(Lo-byte);      Transmitting DataBuf[5] = 36V ADC(Hi-byte)
-            // Transmitting DataBuf[6] = 36V real-mV(Lo-byte);  Transmitting DataBuf[7] = 36V real-mV(Hi-byte)
-            // Transmitting DataBuf[8] = 48V ADC(Lo-byte);      Transmitting DataBuf[9] = 48V ADC(Hi-byte)
-            // Transmitting DataBuf[10] = 48V real-mV(Lo-byte); Transmitting DataBuf[11] = 48V real-mV(Hi-byte)
-//            case Cmd_Get_All_Charger_Channel_Voltage:
-//                //24V
-//                gCdcTempUint16 = G_Charger_24V_Channel_ADC;
-//                Comm_Temp_Transmitting_Data_Buffer[0] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[1] = gCdcTempUint16 >> 8;
-//                gCdcTempFloat = FA_24V_mV_To_ADC_Factor;
-//                gCdcTempFloat = gCdcTempUint16/gCdcTempFloat;
-//                gCdcTempUint16 = (unsigned int)gCdcTempFloat;
-//                Comm_Temp_Transmitting_Data_Buffer[2] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[3] = gCdcTempUint16 >> 8;
-//
-//                //36V
-//                gCdcTempUint16 = G_Charger_36V_Channel_ADC;
-//                Comm_Temp_Transmitting_Data_Buffer[4] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[5] = gCdcTempUint16 >> 8;
-//                gCdcTempFloat = FA_36V_mV_To_ADC_Factor;
-//                gCdcTempFloat = gCdcTempUint16/gCdcTempFloat;
-//                gCdcTempUint16 = (unsigned int)gCdcTempFloat;
-//                Comm_Temp_Transmitting_Data_Buffer[6] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[7] = gCdcTempUint16 >> 8;
-//
-//                //48V
-//                gCdcTempUint16 = G_Charger_48V_Channel_ADC;
-//                Comm_Temp_Transmitting_Data_Buffer[8] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[9] = gCdcTempUint16 >> 8;
-//                gCdcTempFloat = FA_48V_mV_To_ADC_Factor;
-//                gCdcTempFloat = gCdcTempUint16/gCdcTempFloat;
-//                gCdcTempUint16 = (unsigned int)gCdcTempFloat;
-//                Comm_Temp_Transmitting_Data_Buffer[10] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[11] = gCdcTempUint16 >> 8;
-//
-//                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_All_Charger_Channel_Voltage,Comm_Temp_Transmitting_Data_Buffer, 12);
-//                break;
+///////////////////////////////////////////////////////////////////////
+// Command table, sorted by cmd, Max_Data_Length is up to CDC_Receiving_Max_Data_Length
+// CDC_Command(Command, Min_Data_Length, Max_Data_Length, Attribute, Handler, Parameter)
+// the table and CDC_Command_Index are both built from this list at compile time
+#define CDC_Command_List(CDC_Command) \
+    CDC_Command(Cmd_Set_DSG_Load_Gate,             1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Set_DSG_Load_Gate_Handler, 0) \
+    CDC_Command(Cmd_Set_CHG_Shiftet_Gate,          1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Set_CHG_Shiftet_Gate_Handler, 0) \
+    CDC_Command(Cmd_Set_ADC_VPC_Gate,              1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Set_ADC_VPC_Gate_Handler, 0) \
+    CDC_Command(Cmd_Set_ADC_VPD_Gate,              1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Set_ADC_VPD_Gate_Handler, 0) \
+    CDC_Command(Cmd_Communi_Multiplex_Reset,       0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Communi_Multiplex_Reset_Handler, 0) \
+    CDC_Command(Cmd_Communi_Multiplex_Set_Channel, 1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Communi_Multiplex_Set_Channel_Handler, 0) \
+    CDC_Command(Cmd_UART_Set_Baud_Rate,            4, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_UART_Set_Baud_Rate_Handler, 0) \
+    CDC_Command(Cmd_UART_Set_Default_Baud_Rate,    0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_UART_Set_Default_Baud_Rate_Handler, 0) \
+    CDC_Command(Cmd_UART_RS485_Enable,             0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Communication_Enable_Handler, Uart_RS485_Module) \
+    CDC_Command(Cmd_UART_RS485_Disable,            0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Communication_Disable_Handler, Uart_RS485_Module) \
+    CDC_Command(Cmd_One_Wire_Commu_Enable,         0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Communication_Enable_Handler, One_Wire_Module) \
+    CDC_Command(Cmd_One_Wire_Commu_Disable,        0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Communication_Disable_Handler, One_Wire_Module) \
+    CDC_Command(Cmd_Charger_24V_Channel_Set_ID,    1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Charger_Channel_Set_ID_Handler, Switch_To_24V_Ch) \
+    CDC_Command(Cmd_Charger_36V_Channel_Set_ID,    1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Charger_Channel_Set_ID_Handler, Switch_To_36V_Ch) \
+    CDC_Command(Cmd_Charger_48V_Channel_Set_ID,    1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Charger_Channel_Set_ID_Handler, Switch_To_48V_Ch) \
+    CDC_Command(Cmd_Get_Charger_24V_Voltage_Auto,  0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Charger_Voltage_Auto_Handler, Job_Charger_24V_Auto) \
+    CDC_Command(Cmd_Get_Charger_36V_Voltage_Auto,  0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Charger_Voltage_Auto_Handler, Job_Charger_36V_Auto) \
+    CDC_Command(Cmd_Get_Charger_48V_Voltage_Auto,  0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Charger_Voltage_Auto_Handler, Job_Charger_48V_Auto) \
+    CDC_Command(Cmd_I2C_Transmit_Data,             0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Not_Supported_Handler, 0) \
+    CDC_Command(Cmd_I2C_Receive_Data,              0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Not_Supported_Handler, 0) \
+    CDC_Command(Cmd_UART_RS485_Transmit_Data,      0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_UART_RS485_Transmit_Data_Handler, 0) \
+    CDC_Command(Cmd_UART_RS485_Receive_Data,       0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Not_Supported_Handler, 0) \
+    CDC_Command(Cmd_One_Wire_Transmit_Data,        0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Not_Supported_Handler, 0) \
+    CDC_Command(Cmd_One_Wire_Receive_Data,         0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Not_Supported_Handler, 0) \
+    CDC_Command(Cmd_Charger_24V_Channel_Set_Vin,   1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Charger_Channel_Set_Vin_Handler, Switch_To_24V_Ch) \
+    CDC_Command(Cmd_Charger_36V_Channel_Set_Vin,   1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Charger_Channel_Set_Vin_Handler, Switch_To_36V_Ch) \
+    CDC_Command(Cmd_Charger_48V_Channel_Set_Vin,   1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Charger_Channel_Set_Vin_Handler, Switch_To_48V_Ch) \
+    CDC_Command(Cmd_Charger_All_Channel_ID_Set_OFF,0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Charger_All_Channel_ID_Set_OFF_Handler, 0) \
+    CDC_Command(Cmd_Get_PACK_DSG_Voltage_Auto,     0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_PACK_Voltage_Auto_Handler, Job_Pack_DSG_Auto) \
+    CDC_Command(Cmd_Get_PACK_CHG_Voltage_Auto,     0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_PACK_Voltage_Auto_Handler, Job_Pack_CHG_Auto) \
+    CDC_Command(Cmd_Get_Channel_Raw_ADC,           1, 4, CDC_Cmd_Attr_Async, Cmd_Get_Channel_Raw_ADC_Handler, Job_Channel_Raw_ADC) \
+    CDC_Command(Cmd_Get_Direct_PackDSG_Voltage,    0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Direct_Voltage_Handler, Job_Direct_PackDSG_Voltage) \
+    CDC_Command(Cmd_Get_Direct_PackCHG_Voltage,    0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Direct_Voltage_Handler, Job_Direct_PackCHG_Voltage) \
+    CDC_Command(Cmd_Get_Direct_Chger_24Voltage,    0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Direct_Voltage_Handler, Job_Direct_Chger_24Voltage) \
+    CDC_Command(Cmd_Get_Direct_Chger_36Voltage,    0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Direct_Voltage_Handler, Job_Direct_Chger_36Voltage) \
+    CDC_Command(Cmd_Get_Direct_Chger_48Voltage,    0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Direct_Voltage_Handler, Job_Direct_Chger_48Voltage) \
+    CDC_Command(Cmd_Get_Direct_DSG_Current,        0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Direct_Current_Handler, Job_Direct_DSG_Current) \
+    CDC_Command(Cmd_Get_Direct_CHG_Current,        0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_Direct_Current_Handler, Job_Direct_CHG_Current) \
+    CDC_Command(Cmd_Get_Charger_Is_ID_Level,       0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Data_Respond, Cmd_Get_Charger_Is_ID_Level_Handler, 0) \
+    CDC_Command(Cmd_Get_All_Direct_Measurement,    0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_Get_All_Direct_Measurement_Handler, Job_All_Direct_Measurement) \
+    CDC_Command(Cmd_Get_Channel_Statistics,        4, 7, CDC_Cmd_Attr_Async, Cmd_Get_Channel_Statistics_Handler, Job_Channel_Statistics) \
+    CDC_Command(Cmd_ADC_Stream_Start,              4, 4, CDC_Cmd_Attr_Accept_Respond, Cmd_ADC_Stream_Start_Handler, 0) \
+    CDC_Command(Cmd_ADC_Stream_Stop,               0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_ADC_Stream_Stop_Handler, 0) \
+    CDC_Command(Cmd_ADC_Watch_Start,               7, 7, CDC_Cmd_Attr_Accept_Respond, Cmd_ADC_Watch_Start_Handler, 0) \
+    CDC_Command(Cmd_ADC_Watch_Stop,                0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_ADC_Watch_Stop_Handler, 0) \
+    CDC_Command(Cmd_Test_Sequence_Upload,          3, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Test_Sequence_Upload_Handler, 0) \
+    CDC_Command(Cmd_Test_Sequence_Run,             4, 4, CDC_Cmd_Attr_Async, Cmd_Test_Sequence_Run_Handler, 0) \
+    CDC_Command(Cmd_Test_Sequence_Result,          0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Data_Respond, Cmd_Test_Sequence_Result_Handler, 0) \
+    CDC_Command(Cmd_Test_Sequence_Stop,            0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Test_Sequence_Stop_Handler, 0) \
+    CDC_Command(Cmd_Limit_Table_Set,               1, 6, CDC_Cmd_Attr_Accept_Respond, Cmd_Limit_Table_Set_Handler, 0) \
+    CDC_Command(Cmd_Limit_Table_Read_Back,         1, 1, CDC_Cmd_Attr_Data_Respond, Cmd_Limit_Table_Read_Back_Handler, 0) \
+    CDC_Command(Cmd_Set_Verdict_Mode,              1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Set_Verdict_Mode_Handler, 0) \
+    CDC_Command(Cmd_Get_Time_Stamp,                0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Data_Respond, Cmd_Get_Time_Stamp_Handler, 0) \
+    CDC_Command(Cmd_Set_Time_Stamp_Mode,           1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Set_Time_Stamp_Mode_Handler, 0) \
+    CDC_Command(Cmd_Get_UART_Overrun_Count,        0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Data_Respond, Cmd_Get_UART_Overrun_Count_Handler, 0) \
+    CDC_Command(Cmd_UART_Set_Frame_End_Mode,       2, 4, CDC_Cmd_Attr_Accept_Respond, Cmd_UART_Set_Frame_End_Mode_Handler, 0) \
+    CDC_Command(Cmd_UART_Transaction,              8, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Async, Cmd_UART_Transaction_Handler, 0) \
+    CDC_Command(Cmd_Modbus_Read_Plan,              8, 28, CDC_Cmd_Attr_Async, Cmd_Modbus_Read_Plan_Handler, 0) \
+    CDC_Command(Cmd_Modbus_Write,                  9, 29, CDC_Cmd_Attr_Async, Cmd_Modbus_Write_Handler, 0) \
+    CDC_Command(Cmd_UART_Bridge_Enter,             1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_UART_Bridge_Enter_Handler, 0) \
+    CDC_Command(Cmd_UART_Bridge_Exit,              0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_UART_Bridge_Exit_Handler, 0) \
+    CDC_Command(Cmd_Cal_Set_Charger_24V_Channel_Offset,  1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Cal_Set_Offset_Handler, FA_24V_CAL_OFFSET_ADC_offset) \
+    CDC_Command(Cmd_Cal_Set_Charger_36V_Channel_Offset,  1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Cal_Set_Offset_Handler, FA_36V_CAL_OFFSET_ADC_offset) \
+    CDC_Command(Cmd_Cal_Set_Charger_48V_Channel_Offset,  1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Cal_Set_Offset_Handler, FA_48V_CAL_OFFSET_ADC_offset) \
+    CDC_Command(Cmd_Get_All_Calibration_Data,      0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Data_Respond, Cmd_Get_All_Calibration_Data_Handler, 0) \
+    CDC_Command(Cmd_Get_All_Flash_Data,            0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Data_Respond, Cmd_Get_All_Flash_Data_Handler, 0) \
+    CDC_Command(Cmd_Set_Cal_Data_To_Flash,         3, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Set_Cal_Data_To_Flash_Handler, 0) \
+    CDC_Command(Cmd_Cal_Set_PACK_DSG_Vol_CAL_ADC_offset, 1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Cal_Set_Offset_Handler, FA_Pack_DSG_CAL_OFFSET_ADC_offset) \
+    CDC_Command(Cmd_Cal_Set_PACK_CHG_Vol_CAL_ADC_offset, 1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Cal_Set_Offset_Handler, FA_Pack_CHG_CAL_OFFSET_ADC_offset) \
+    CDC_Command(Cmd_Cal_Set_DSG_Current_CAL_ADC_offset,  1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Cal_Set_Offset_Handler, FA_DSG_Current_CAL_OFFSET_ADC_offset) \
+    CDC_Command(Cmd_Cal_Set_CHG_Current_CAL_ADC_offset,  1, 1, CDC_Cmd_Attr_Accept_Respond, Cmd_Cal_Set_Offset_Handler, FA_CHG_Current_CAL_OFFSET_ADC_offset) \
+    CDC_Command(Cmd_Cal_Table_Upload,              7, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Accept_Respond, Cmd_Cal_Table_Upload_Handler, 0) \
+    CDC_Command(Cmd_Cal_Table_Read_Back,           2, 2, CDC_Cmd_Attr_Data_Respond, Cmd_Cal_Table_Read_Back_Handler, 0) \
+    CDC_Command(Cmd_Cal_Table_Activate,            2, 2, CDC_Cmd_Attr_Accept_Respond, Cmd_Cal_Table_Activate_Handler, 0) \
+    CDC_Command(Cmd_Test_Data_Send_Back,           0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Data_Respond, Cmd_Test_Data_Send_Back_Handler, 0) \
+    CDC_Command(Cmd_FW_HW_Version,                 0, CDC_Receiving_Max_Data_Length, CDC_Cmd_Attr_Data_Respond, Cmd_FW_HW_Version_Handler, 0) \
+    CDC_Command(Cmd_SetDetectCharger_DelayCycle,   2, 2, CDC_Cmd_Attr_Accept_Respond, Cmd_SetDetectCharger_DelayCycle_Handler, 0) \
+    CDC_Command(Cmd_Get_Command_Statistics,        0, 2, CDC_Cmd_Attr_Data_Respond, Cmd_Get_Command_Statistics_Handler, 0)
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Auto_Charger_Checking           (0xA6)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 24
-            // channel ID set Off
-            // Transmitting DataBuf[0] = 24V ADC(Lo-byte);      Transmitting DataBuf[1] = 24V ADC(Hi-byte)
-            // Transmitting DataBuf[2] = 24V real-mV(Lo-byte);  Transmitting DataBuf[3] = 24V real-mV(Hi-byte)
-            // Transmitting DataBuf[4] = 36V ADC(Lo-byte);      Transmitting DataBuf[5] = 36V ADC(Hi-byte)
-            // Transmitting DataBuf[6] = 36V real-mV(Lo-byte);  Transmitting DataBuf[7] = 36V real-mV(Hi-byte)
-            // Transmitting DataBuf[8] = 48V ADC(Lo-byte);      Transmitting DataBuf[9] = 48V ADC(Hi-byte)
-            // Transmitting DataBuf[10] = 48V real-mV(Lo-byte); Transmitting DataBuf[11] = 48V real-mV(Hi-byte)
-            // -----------------------------------------
-            // channel ID set on
-            // Transmitting DataBuf[0] = 24V ADC(Lo-byte);      Transmitting DataBuf[1] = 24V ADC(Hi-byte)
-            // Transmitting DataBuf[2] = 24V real-mV(Lo-byte);  Transmitting DataBuf[3] = 24V real-mV(Hi-byte)
-            // Transmitting DataBuf[4] = 36V ADC(Lo-byte);      Transmitting DataBuf[5] = 36V ADC(Hi-byte)
-            // Transmitting DataBuf[6] = 36V real-mV(Lo-byte);  Transmitting DataBuf[7] = 36V real-mV(Hi-byte)
-            // Transmitting DataBuf[8] = 48V ADC(Lo-byte);      Transmitting DataBuf[9] = 48V ADC(Hi-byte)
-            // Transmitting DataBuf[10] = 48V real-mV(Lo-byte); Transmitting DataBuf[11] = 48V real-mV(Hi-byte)
-//            case Cmd_Auto_Charger_Checking:
-//                if(((G_Module_Function_Status & Start_Fast_Charger_Check)==0)&&
-//                   ((G_Module_Function_Status & Start_Charger_Check)==0)){
-//                    G_Module_Function_Status |= Start_Charger_Check;
-//                    G_Module_Function_Status |= Charger_Check_Actived;
-//                }
-//                //_DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_All_Charger_Channel_Voltage,Comm_Temp_Transmitting_Data_Buffer, 12);
-//                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Fast_Auto_Charger_Checking      (0xA7)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 24
-            // channel ID set Off
-            // Transmitting DataBuf[0] = 24V ADC(Lo-byte);      Transmitting DataBuf[1] = 24V ADC(Hi-byte)
-            // Transmitting DataBuf[2] = 24V real-mV(Lo-byte);  Transmitting DataBuf[3] = 24V real-mV(Hi-byte)
-            // Transmitting DataBuf[4] = 36V ADC(Lo-byte);      Transmitting DataBuf[5] = 36V ADC(Hi-byte)
-            // Transmitting DataBuf[6] = 36V real-mV(Lo-byte);  Transmitting DataBuf[7] = 36V real-mV(Hi-byte)
-            // Transmitting DataBuf[8] = 48V ADC(Lo-byte);      Transmitting DataBuf[9] = 48V ADC(Hi-byte)
-            // Transmitting DataBuf[10] = 48V real-mV(Lo-byte); Transmitting DataBuf[11] = 48V real-mV(Hi-byte)
-            // -----------------------------------------
-            // channel ID set on
-            // Transmitting DataBuf[0] = 24V ADC(Lo-byte);      Transmitting DataBuf[1] = 24V ADC(Hi-byte)
-            // Transmitting DataBuf[2] = 24V real-mV(Lo-byte);  Transmitting DataBuf[3] = 24V real-mV(Hi-byte)
-            // Transmitting DataBuf[4] = 36V ADC(Lo-byte);      Transmitting DataBuf[5] = 36V ADC(Hi-byte)
-            // Transmitting DataBuf[6] = 36V real-mV(Lo-byte);  Transmitting DataBuf[7] = 36V real-mV(Hi-byte)
-            // Transmitting DataBuf[8] = 48V ADC(Lo-byte);      Transmitting DataBuf[9] = 48V ADC(Hi-byte)
-            // Transmitting DataBuf[10] = 48V real-mV(Lo-byte); Transmitting DataBuf[11] = 48V real-mV(Hi-byte)
-//            case Cmd_Fast_Auto_Charger_Checking:
-//                if(((G_Module_Function_Status & Start_Fast_Charger_Check)==0)&&
-//                   ((G_Module_Function_Status & Start_Charger_Check)==0)){
-//                    G_Module_Function_Status |= Start_Fast_Charger_Check;
-//                    G_Module_Function_Status |= Charger_Check_Actived;
-//                }
-//                //_DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_All_Charger_Channel_Voltage,Comm_Temp_Transmitting_Data_Buffer, 12);
-//                break;
+#define CDC_Command_Table_Entry(cmd, min_length, max_length, attribute, handler, parameter) \
+    {cmd, min_length, max_length, attribute, handler, parameter},
+const CDC_Command_Entry CDC_Command_Table[] = {
+    CDC_Command_List(CDC_Command_Table_Entry)
+};
+//position of each cmd in CDC_Command_Table
+#define CDC_Command_Table_Position(cmd, min_length, max_length, attribute, handler, parameter) \
+    cmd##_Position,
+enum{
+    CDC_Command_List(CDC_Command_Table_Position)
+    CDC_Command_Table_Entries
+};
+//cmd - CDC_Command_Opcode_Base => CDC_Command_Table index + 1, const in flash instead of building it in RAM
+#define CDC_Command_Index_Entry(cmd, min_length, max_length, attribute, handler, parameter) \
+    [cmd - CDC_Command_Opcode_Base] = cmd##_Position + 1,
+const t_uint8 CDC_Command_Index[CDC_Command_Opcode_Range] = {
+    CDC_Command_List(CDC_Command_Index_Entry)
+};
+#define CDC_Command_Table_Size      (sizeof(CDC_Command_Table) / sizeof(CDC_Command_Entry))
+#define CDC_Command_Stats_Per_Packet    ((CDC_Transmitting_Max_Data_Length - 6) / 9)
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_PACK_DSG_Voltage_Auto (0xA8)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 4
-            // Transmitting DataBuf[0] = BatteryV ADC(Lo-byte);      Transmitting DataBuf[1] = BatteryV ADC(Hi-byte)
-            // Transmitting DataBuf[2] = BatteryV real-mV(Lo-byte);  Transmitting DataBuf[3] = BatteryV real-mV(Hi-byte)
-            case Cmd_Get_PACK_DSG_Voltage_Auto:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Pack_DSG_Vol_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_PACK_DSG_Voltage_Auto,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_PACK_CHG_Voltage_Auto (0xA9)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 4
-            // Transmitting DataBuf[0] = BatteryV ADC(Lo-byte);      Transmitting DataBuf[1] = BatteryV ADC(Hi-byte)
-            // Transmitting DataBuf[2] = BatteryV real-mV(Lo-byte);  Transmitting DataBuf[3] = BatteryV real-mV(Hi-byte)
-            case Cmd_Get_PACK_CHG_Voltage_Auto:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Pack_CHG_Vol_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_PACK_CHG_Voltage_Auto,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Channel_Raw_ADC (0xAA)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = 0:ADC Channel 0, 1:ADC Channel 1, ~ to ~ 7:ADC Channel 7
-            //=====================================================================
-            // Transmitting DataLenExpected = 2
-            // Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
-            case Cmd_Get_Channel_Raw_ADC:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1) && (receiving_Data_Packet.DataBuf[0] > 7)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Channel_Raw_ADC,&(gCdcTempUint8), 1);
-                    break;
-                }
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    gCdcTempUint8 = receiving_Data_Packet.DataBuf[0];
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status |= DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Channels_ADC_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Channel_Raw_ADC,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Direct_PackDSG_Voltage (0xAB)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = NA
-            //=====================================================================
-            // Transmitting DataLenExpected = 4
-            // Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
-            // Transmitting DataBuf[2] = Real Values(Lo-byte);      Transmitting DataBuf[3] = Real Values(Hi-byte)
-            case Cmd_Get_Direct_PackDSG_Voltage:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status |= DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Pack_DSG_Vol_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_PackDSG_Voltage,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Direct_PackCHG_Voltage (0xAC)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = NA
-            //=====================================================================
-            // Transmitting DataLenExpected = 4
-            // Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
-            // Transmitting DataBuf[2] = Real Values(Lo-byte);      Transmitting DataBuf[3] = Real Values(Hi-byte)
-            case Cmd_Get_Direct_PackCHG_Voltage:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status |= DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Pack_CHG_Vol_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_PackCHG_Voltage,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Direct_Chger_24Voltage (0xAD)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = NA
-            //=====================================================================
-            // Transmitting DataLenExpected = 4
-            // Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
-            // Transmitting DataBuf[2] = Real Values(Lo-byte);      Transmitting DataBuf[3] = Real Values(Hi-byte)
-            case Cmd_Get_Direct_Chger_24Voltage:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status |= DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Charger_24V_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_Chger_24Voltage,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Direct_Chger_36Voltage (0xAE)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = NA
-            //=====================================================================
-            // Transmitting DataLenExpected = 4
-            // Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
-            // Transmitting DataBuf[2] = Real Values(Lo-byte);      Transmitting DataBuf[3] = Real Values(Hi-byte)
-            case Cmd_Get_Direct_Chger_36Voltage:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status |= DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Charger_36V_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_Chger_36Voltage,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Direct_Chger_48Voltage (0xAF)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = NA
-            //=====================================================================
-            // Transmitting DataLenExpected = 4
-            // Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
-            // Transmitting DataBuf[2] = Real Values(Lo-byte);      Transmitting DataBuf[3] = Real Values(Hi-byte)
-            case Cmd_Get_Direct_Chger_48Voltage:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status |= DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status |= Set_Charger_48V_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_Chger_48Voltage,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Direct_DSG_Current (0xB0)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = NA
-            //=====================================================================
-            // Transmitting DataLenExpected = 4
-            // Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
-            // Transmitting DataBuf[2] = Real Values(Lo-byte);      Transmitting DataBuf[3] = Real Values(Hi-byte)
-            case Cmd_Get_Direct_DSG_Current:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status |= DirMeasuredProcessingViaADC_Ch;
-                    G_1st_Module_Function_Status |= Set_Dsg_Current_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_DSG_Current,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Direct_CHG_Current (0xB1)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = NA
-            //=====================================================================
-            // Transmitting DataLenExpected = 4
-            // Transmitting DataBuf[0] = channel ADC(Lo-byte);      Transmitting DataBuf[1] = channel ADC(Hi-byte)
-            // Transmitting DataBuf[2] = Real Values(Lo-byte);      Transmitting DataBuf[3] = Real Values(Hi-byte)
-            case Cmd_Get_Direct_CHG_Current:
-                if(((G_Module_Function_Status & (Set_Charger_24V_Measured_Processing + Set_Charger_36V_Measured_Processing + Set_Charger_48V_Measured_Processing)) == 0)&&
-                    ((G_Module_Function_Status & (Set_Pack_DSG_Vol_Measured_Processing + Set_Pack_CHG_Vol_Measured_Processing + Set_Channels_ADC_Measured_Processing))== 0)){
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status |= DirMeasuredProcessingViaADC_Ch;
-                    G_1st_Module_Function_Status |= Set_Chg_Current_Measured_Processing;
-                }else{
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_CHG_Current,&(gCdcTempUint8), 1);
-                }
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_Charger_Is_ID_Level (0xB2)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = NA
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = (1: use ID switch Voltage adapter)(0: No ID switch adapter);
-            case Cmd_Get_Charger_Is_ID_Level:
-                gCdcTempUint8 = _DUI_Get_Charger_ID_Status();
-                if(gCdcTempUint8 == Chger_With_ID_Step){
-                    //send data out via usb
-                    gCdcTempUint8 = 1;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_Is_ID_Level,&(gCdcTempUint8), 1);
-                }else{
-                     //send data out via usb
-                    gCdcTempUint8 = 0;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_Is_ID_Level,&(gCdcTempUint8), 1);
-               }
-                break;
-    ///////////////////////////////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////
-
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_I2C_Transmit_Data
-            // receiving_Data_Packet.DataLenExpected
-            // receiving_Data_Packet.DataBuf[n]
-            case Cmd_I2C_Transmit_Data:
-                gCdcTempUint8 = Respond_Error_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_I2C_Transmit_Data,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_I2C_Receive_Data
-            // receiving_Data_Packet.DataLenExpected
-            // receiving_Data_Packet.DataBuf[n]
-            case Cmd_I2C_Receive_Data:
-                gCdcTempUint8 = Respond_Error_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_I2C_Receive_Data,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_UART_RS485_Transmit_Data
-            // receiving_Data_Packet.DataLenExpected
-            // receiving_Data_Packet.DataBuf[n]
-            case Cmd_UART_RS485_Transmit_Data:
-                gCdcTempUint16 = receiving_Data_Packet.DataLenExpected_High;
-                gCdcTempUint16 = (gCdcTempUint16 << 8) + receiving_Data_Packet.DataLenExpected_Low;
-                _DUI_Communication_Send_Bytes(Uart_RS485_Module, &(receiving_Data_Packet.DataBuf[0]), gCdcTempUint16);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_UART_RS485_Transmit_Data,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_UART_RS485_Receive_Data
-            // receiving_Data_Packet.DataLenExpected
-            // receiving_Data_Packet.DataBuf[n]
-            case Cmd_UART_RS485_Receive_Data:
-                // not here to do
-                gCdcTempUint8 = Respond_Error_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_UART_RS485_Receive_Data,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_One_Wire_Transmit_Data
-            // receiving_Data_Packet.DataLenExpected
-            // receiving_Data_Packet.DataBuf[n]
-            case Cmd_One_Wire_Transmit_Data:
-                // no function to do
-                gCdcTempUint8 = Respond_Error_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_One_Wire_Transmit_Data,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_One_Wire_Receive_Data
-            // receiving_Data_Packet.DataLenExpected
-            // receiving_Data_Packet.DataBuf[n]
-            case Cmd_One_Wire_Receive_Data:
-                // not here to do
-                gCdcTempUint8 = Respond_Error_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_One_Wire_Receive_Data,&(gCdcTempUint8), 1);
-                break;
-    ///////////////////////////////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////
-
-    // Calibration Status cmd
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Cal_Set_Charger_24V_Channel_Offset  (0xD0)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = set Cal_Offset_Data
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
-            case Cmd_Cal_Set_Charger_24V_Channel_Offset:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_Charger_24V_Channel_Offset,&(gCdcTempUint8), 1);
-                    break;
-                }
-                WriteDataToFlash(FA_24V_CAL_OFFSET_ADC_offset, &(receiving_Data_Packet.DataBuf[0]), 1);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_Charger_24V_Channel_Offset,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Cal_Set_Charger_36V_Channel_Offset  (0xD1)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = set Cal_Offset_Data
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
-            case Cmd_Cal_Set_Charger_36V_Channel_Offset:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_Charger_36V_Channel_Offset,&(gCdcTempUint8), 1);
-                    break;
-                }
-                WriteDataToFlash(FA_36V_CAL_OFFSET_ADC_offset, &(receiving_Data_Packet.DataBuf[0]), 1);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_Charger_36V_Channel_Offset,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Cal_Set_Charger_48V_Channel_Offset  (0xD2)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = set Cal_Offset_Data
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
-            case Cmd_Cal_Set_Charger_48V_Channel_Offset:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_Charger_48V_Channel_Offset,&(gCdcTempUint8), 1);
-                    break;
-                }
-                WriteDataToFlash(FA_48V_CAL_OFFSET_ADC_offset, &(receiving_Data_Packet.DataBuf[0]), 1);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_Charger_48V_Channel_Offset,&(gCdcTempUint8), 1);
-                break;
+CDC_Command_Statistics CDC_Command_Stats[CDC_Command_Table_Size];   //same index as CDC_Command_Table
+t_uint16 CDC_Command_Unknown_Count;
+//latency slots of async cmds waiting for their result, the slot is kept in the response tag of the cmd
+//one for each measurement job, UART transaction, Modbus plan or write and test sequence, 15 at most
+#define CDC_Command_Async_Slots     (Measurement_Job_Queue_Size + 3)
+t_uint8 CDC_Command_Async_Index[CDC_Command_Async_Slots];
+t_uint32 CDC_Command_Async_Time_Stamp[CDC_Command_Async_Slots];
+t_uint16 CDC_Command_Async_Used_Bits;       //bit n : slot n is used
+t_uint16 CDC_Command_Async_Overflow_Count;
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_All_Calibration_Data           (0xD3)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 7
-            // Transmitting DataBuf[0] = FA_24V_CAL_OFFSET_ADC;
-            // Transmitting DataBuf[1] = FA_36V_CAL_OFFSET_ADC;
-            // Transmitting DataBuf[2] = FA_48V_CAL_OFFSET_ADC;
-            // Transmitting DataBuf[3] = FA_Pack_DSG_CAL_OFFSET_ADC;
-            // Transmitting DataBuf[4] = FA_Pack_CHG_CAL_OFFSET_ADC;
-            // Transmitting DataBuf[5] = FA_DSG_Current_CAL_OFFSET_ADC;
-            // Transmitting DataBuf[6] = FA_CHG_Current_CAL_OFFSET_ADC;
-            case Cmd_Get_All_Calibration_Data:
-                gCdcTempUint8_ptr = (t_uint8 *)(Flash_segment_C + FA_24V_CAL_OFFSET_ADC_offset);
-                for(gCdcTempUint16 = 0; gCdcTempUint16 < 5; gCdcTempUint16++){
-                    Comm_Temp_Transmitting_Data_Buffer[gCdcTempUint16] = (*gCdcTempUint8_ptr++);
-                }
-                Comm_Temp_Transmitting_Data_Buffer[5] = FA_DSG_Current_CAL_OFFSET_ADC;
-                Comm_Temp_Transmitting_Data_Buffer[6] = FA_CHG_Current_CAL_OFFSET_ADC;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_All_Calibration_Data, Comm_Temp_Transmitting_Data_Buffer, 7);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Get_All_Flash_Data           (0xD4)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 128
-            // Transmitting DataBuf[0]~ Transmitting DataBuf[127] : flash data
-            case Cmd_Get_All_Flash_Data:
-                gCdcTempUint8_ptr = (t_uint8 *)(Flash_segment_C);
-                for(gCdcTempUint16 = 0; gCdcTempUint16 < Flash_segment_Size; gCdcTempUint16++){
-                    Comm_Temp_Transmitting_Data_Buffer[gCdcTempUint16] = (*gCdcTempUint8_ptr++);
-                }
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_All_Flash_Data,Comm_Temp_Transmitting_Data_Buffer, Flash_segment_Size);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Set_Cal_Data_To_Flash               (0xD5)
-            // receiving_Data_Packet.DataLenExpected = 2+n
-            // receiving_Data_Packet.DataBuf[0] = Cal_Write_Data_Offset
-            // receiving_Data_Packet.DataBuf[1] = Cal_Write_Data_Length(n)
-            // receiving_Data_Packet.DataBuf[2 ~ 1+n] = Cal_Write_Data (Lo-byte first)
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
-            case Cmd_Set_Cal_Data_To_Flash:
-                gCdcTempUint16 = receiving_Data_Packet.DataLenExpected_High;
-                gCdcTempUint16 = (gCdcTempUint16 << 8) + receiving_Data_Packet.DataLenExpected_Low;
-                if((gCdcTempUint16 < 3)||((receiving_Data_Packet.DataBuf[1] + 2) != gCdcTempUint16)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_Cal_Data_To_Flash,&(gCdcTempUint8), 1);
-                    break;
-                }
-                WriteDataToFlash(receiving_Data_Packet.DataBuf[0], &(receiving_Data_Packet.DataBuf[2]), receiving_Data_Packet.DataBuf[1]);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Set_Cal_Data_To_Flash,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Cal_Set_PACK_DSG_Vol_CAL_ADC_offset  (0xD6)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = set Cal_Offset_Data
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
-            case Cmd_Cal_Set_PACK_DSG_Vol_CAL_ADC_offset:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_PACK_DSG_Vol_CAL_ADC_offset,&(gCdcTempUint8), 1);
-                    break;
-                }
-                WriteDataToFlash(FA_Pack_DSG_CAL_OFFSET_ADC_offset, &(receiving_Data_Packet.DataBuf[0]), 1);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_PACK_DSG_Vol_CAL_ADC_offset,&(gCdcTempUint8), 1);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Cal_Set_PACK_CHG_Vol_CAL_ADC_offset  (0xD7)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = set Cal_Offset_Data
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
-            case Cmd_Cal_Set_PACK_CHG_Vol_CAL_ADC_offset:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_PACK_CHG_Vol_CAL_ADC_offset,&(gCdcTempUint8), 1);
-                    break;
-                }
-                WriteDataToFlash(FA_Pack_CHG_CAL_OFFSET_ADC_offset, &(receiving_Data_Packet.DataBuf[0]), 1);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_PACK_CHG_Vol_CAL_ADC_offset,&(gCdcTempUint8), 1);
-                break;
+static void clear_CDC_Command_Statistics(){
+    t_uint8 i;
+    for(i = 0; i < CDC_Command_Table_Size; i++){
+        CDC_Command_Stats[i].Hit_Count = 0;
+        CDC_Command_Stats[i].Error_Count = 0;
+        CDC_Command_Stats[i].Latency = 0;
+    }
+    CDC_Command_Unknown_Count = 0;
+    CDC_Command_Async_Overflow_Count = 0;
+}
+static void init_CDC_Command_Statistics(){
+    CDC_Command_Async_Used_Bits = 0;
+    CDC_Command_Async_Slot = 0;
+    clear_CDC_Command_Statistics();
+}
+// slot + 1 for the async cmd of index, 0 if all slots are used
+static t_uint8 get_CDC_Async_Command_Slot(t_uint8 index, t_uint32 time_stamp){
+    t_uint8 slot;
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Cal_Set_DSG_Current_CAL_ADC_offset  (0xD8)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = set Cal_Offset_Data
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
-            case Cmd_Cal_Set_DSG_Current_CAL_ADC_offset:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_DSG_Current_CAL_ADC_offset,&(gCdcTempUint8), 1);
-                    break;
-                }
-                WriteDataToFlash(FA_DSG_Current_CAL_OFFSET_ADC_offset, &(receiving_Data_Packet.DataBuf[0]), 1);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_DSG_Current_CAL_ADC_offset,&(gCdcTempUint8), 1);
-                break;
+    for(slot = 0; slot < CDC_Command_Async_Slots; slot++){
+        if((CDC_Command_Async_Used_Bits & (1 << slot)) == 0){
+            CDC_Command_Async_Used_Bits |= (1 << slot);
+            CDC_Command_Async_Index[slot] = index;
+            CDC_Command_Async_Time_Stamp[slot] = time_stamp;
+            return slot + 1;
+        }
+    }
+    CDC_Command_Async_Overflow_Count++;
+    return 0;
+}
+// latency of async command is the time until main() sends its result, on any status,
+// the slot in the response tag is freed
+static void account_CDC_Async_Command_Latency(t_uint16 response_tag){
+    t_uint8 slot;
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Cal_Set_CHG_Current_CAL_ADC_offset  (0xD9)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = set Cal_Offset_Data
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
-            case Cmd_Cal_Set_CHG_Current_CAL_ADC_offset:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 1)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_CHG_Current_CAL_ADC_offset,&(gCdcTempUint8), 1);
-                    break;
-                }
-                WriteDataToFlash(FA_CHG_Current_CAL_OFFSET_ADC_offset, &(receiving_Data_Packet.DataBuf[0]), 1);
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_CHG_Current_CAL_ADC_offset,&(gCdcTempUint8), 1);
-                break;
+    slot = response_tag >> CDC_Response_Tag_Slot_Shift;
+    if(slot == 0){
+        return;
+    }
+    slot--;
+    if((CDC_Command_Async_Used_Bits & (1 << slot)) == 0){
+        return;
+    }
+    CDC_Command_Async_Used_Bits &= ~(1 << slot);
+    CDC_Command_Stats[CDC_Command_Async_Index[slot]].Latency += _Device_Get_TimerA_Time_Stamp() - CDC_Command_Async_Time_Stamp[slot];
+}
+static t_uint8 Cmd_Get_Command_Statistics_Handler(USB_Receiving_Protocol_Packet *packet, t_uint16 parameter){
+    t_uint16 index;
+    t_uint8 i;
+    t_uint8 last;
+    i = 0;
+    if(packet->DataLenExpected_Low == 2){
+        i = packet->DataBuf[1];
+    }
+    if(i > CDC_Command_Table_Size){
+        return Func_Failure;
+    }
+    last = CDC_Command_Table_Size;
+    if((last - i) > CDC_Command_Stats_Per_Packet){
+        last = i + CDC_Command_Stats_Per_Packet;
+    }
+    index = 0;
+    Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Unknown_Count;
+    Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Unknown_Count >> 8;
+    Comm_Temp_Transmitting_Data_Buffer[index++] = Timer_A_Counts_Per_MS & 0x00ff;
+    Comm_Temp_Transmitting_Data_Buffer[index++] = Timer_A_Counts_Per_MS >> 8;
+    Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Async_Overflow_Count;
+    Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Async_Overflow_Count >> 8;
+    for(; i < last; i++){
+        Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Table[i].Command;
+        Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Stats[i].Hit_Count;
+        Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Stats[i].Hit_Count >> 8;
+        Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Stats[i].Error_Count;
+        Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Stats[i].Error_Count >> 8;
+        Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Stats[i].Latency;
+        Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Stats[i].Latency >> 8;
+        Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Stats[i].Latency >> 16;
+        Comm_Temp_Transmitting_Data_Buffer[index++] = CDC_Command_Stats[i].Latency >> 24;
+    }
+    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Command_Statistics, Comm_Temp_Transmitting_Data_Buffer, index);
+    if((packet->DataLenExpected_Low >= 1) && (packet->DataBuf[0] == 1)){
+        clear_CDC_Command_Statistics();
+    }
+    return Func_Success;
+}
+// O(1) lookup by cmd, check payload length, call handler and send the 1 byte response
+static void CDC_Command_Dispatch(USB_Receiving_Protocol_Packet *packet){
+    const CDC_Command_Entry *entry;
+    t_uint8 index;
+    t_uint8 respond_code;
+    t_uint8 result;
+    t_uint16 length;
+    t_uint32 time_stamp;
 
-    ///////////////////////////////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_For_Connect_Detection   (0xE1)
-            // receiving_Data_Packet.DataLenExpected
-            // receiving_Data_Packet.DataBuf[n]
-            //case Cmd_For_Connect_Detection:
-                //gCdcTempUint8 = Respond_Accept_Check_Code;
-                //_DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_For_Connect_Detection,&(gCdcTempUint8), 1);
-                //break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Test_Data_Send_Back   (0xE2)
-            // receiving_Data_Packet.DataLenExpected
-            // receiving_Data_Packet.DataBuf[n]
-            case Cmd_Test_Data_Send_Back:
-                gCdcTempUint16 = receiving_Data_Packet.DataLenExpected_High;
-                gCdcTempUint16 = (gCdcTempUint16 << 8) + receiving_Data_Packet.DataLenExpected_Low;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Test_Data_Send_Back,&(receiving_Data_Packet.DataBuf[0]), gCdcTempUint16);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_Test_Get_All_Raw_ADC_Data           (0xE3)
-            // receiving_Data_Packet.DataLenExpected = 1
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 12
-            // Transmitting DataBuf[0] = ADC_Channel0(Lo-byte);  Transmitting DataBuf[1] = ADC_Channel0(Hi-byte)
-            // Transmitting DataBuf[2] = ADC_Channel1(Lo-byte);  Transmitting DataBuf[3] = ADC_Channel1(Hi-byte)
-            // Transmitting DataBuf[4] = ADC_Channel2(Lo-byte);  Transmitting DataBuf[5] = ADC_Channel2(Hi-byte)
-            // Transmitting DataBuf[6] = ADC_Channel3(Lo-byte);  Transmitting DataBuf[7] = ADC_Channel3(Hi-byte)
-            // Transmitting DataBuf[8] = ADC_Channel4(Lo-byte);  Transmitting DataBuf[9] = ADC_Channel4(Hi-byte)
-            // Transmitting DataBuf[10] = ADC_Channel5(Lo-byte);  Transmitting DataBuf[11] = ADC_Channel5(Hi-byte)
-//            case Cmd_Test_Get_All_Raw_ADC_Data:
-//                gCdcTempUint16 = _Device_Get_ADC_Result(ADC_Channel0);
-//                Comm_Temp_Transmitting_Data_Buffer[0] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[1] = gCdcTempUint16 >> 8;
-//                gCdcTempUint16 = _Device_Get_ADC_Result(ADC_Channel1);
-//                Comm_Temp_Transmitting_Data_Buffer[2] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[3] = gCdcTempUint16 >> 8;
-//                gCdcTempUint16 = _Device_Get_ADC_Result(ADC_Channel2);
-//                Comm_Temp_Transmitting_Data_Buffer[4] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[5] = gCdcTempUint16 >> 8;
-//                gCdcTempUint16 = _Device_Get_ADC_Result(ADC_Channel3);
-//                Comm_Temp_Transmitting_Data_Buffer[6] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[7] = gCdcTempUint16 >> 8;
-//                gCdcTempUint16 = _Device_Get_ADC_Result(ADC_Channel4);
-//                Comm_Temp_Transmitting_Data_Buffer[8] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[9] = gCdcTempUint16 >> 8;
-//                gCdcTempUint16 = _Device_Get_ADC_Result(ADC_Channel5);
-//                Comm_Temp_Transmitting_Data_Buffer[10] = gCdcTempUint16;
-//                Comm_Temp_Transmitting_Data_Buffer[11] = gCdcTempUint16 >> 8;
-//
-//                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Test_Get_All_Raw_ADC_Data,Comm_Temp_Transmitting_Data_Buffer, 12);
-//                break;
+    index = CDC_Command_Not_Found;
+    if((packet->Command >= CDC_Command_Opcode_Base) &&
+       (packet->Command < (CDC_Command_Opcode_Base + CDC_Command_Opcode_Range))){
+        index = CDC_Command_Index[packet->Command - CDC_Command_Opcode_Base];
+    }
+    if(index == CDC_Command_Not_Found){
+        CDC_Command_Unknown_Count++;
+        respond_code = Respond_Error_Check_Code;
+        _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Error_Cmd,&respond_code, 1);
+        return;
+    }
+    index--;
+    entry = &CDC_Command_Table[index];
+    time_stamp = _Device_Get_TimerA_Time_Stamp();
+    length = packet->DataLenExpected_High;
+    length = (length << 8) + packet->DataLenExpected_Low;
 
+    if((length < entry->Min_Data_Length) || (length > entry->Max_Data_Length)){
+        result = Func_Failure;
+    }else{
+        //the handler of async cmd keeps the slot by _DUI_CDC_Get_Response_Tag()
+        if(entry->Attribute == CDC_Cmd_Attr_Async){
+            CDC_Command_Async_Slot = get_CDC_Async_Command_Slot(index, time_stamp);
+        }
+        result = entry->Handler(packet, entry->Parameter);
+        if((result != Func_Success) && CDC_Command_Async_Slot){
+            CDC_Command_Async_Used_Bits &= ~(1 << (CDC_Command_Async_Slot - 1));
+        }
+        CDC_Command_Async_Slot = 0;
+    }
 
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_HW_FW_Version           (0xE5)
-            // receiving_Data_Packet.DataLenExpected = 0
-            // receiving_Data_Packet.DataBuf[0] = N/A
-            //=====================================================================
-            // Transmitting DataLenExpected = 5
-            // Transmitting DataBuf[0] = FA_VERSION;
-            // Transmitting DataBuf[1] = FA_MINOR_VERSION;
-            // Transmitting DataBuf[2] = FA_EEPROM_VERSION;
-            // Transmitting DataBuf[3] = FA_RESERVED_VERSION;
-            // Transmitting DataBuf[4] = FA_HW_Version;
-            // Transmitting DataBuf[5] = FA_HW_MINOR_Version;
-            case Cmd_FW_HW_Version:
-                Comm_Temp_Transmitting_Data_Buffer[0] = FA_VERSION;
-                Comm_Temp_Transmitting_Data_Buffer[1] = FA_MINOR_VERSION;
-                Comm_Temp_Transmitting_Data_Buffer[2] = FA_EEPROM_VERSION;
-                Comm_Temp_Transmitting_Data_Buffer[3] = FA_RESERVED_VERSION;
-                Comm_Temp_Transmitting_Data_Buffer[4] = FA_HW_Version;
-                Comm_Temp_Transmitting_Data_Buffer[5] = FA_HW_MINOR_Version;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_FW_HW_Version,Comm_Temp_Transmitting_Data_Buffer, 6);
-                break;
-            ///////////////////////////////////////////////////////////////////////
-            // Cmd_SetDetectCharger_DelayCycle           (0xE6)
-            // receiving_Data_Packet.DataLenExpected = 2
-            // receiving_Data_Packet.DataBuf[0] = Delay Cycles (Lo bytes)
-            // receiving_Data_Packet.DataBuf[1] = Delay Cycles (Hi bytes)
-            //=====================================================================
-            // Transmitting DataLenExpected = 1
-            // Transmitting DataBuf[0] = Respond_Accept_Check_Code or Respond_Error_Check_Code
-            case Cmd_SetDetectCharger_DelayCycle:
-                if((receiving_Data_Packet.DataLenExpected_High == 0) && (receiving_Data_Packet.DataLenExpected_Low != 2)){
-                    gCdcTempUint8 = Respond_Error_Check_Code;
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Cal_Set_PACK_CHG_Vol_CAL_ADC_offset,&(gCdcTempUint8), 1);
-                    break;
-                }
-                G_Temp_1_DelayCycles = receiving_Data_Packet.DataBuf[1];
-                G_Temp_1_DelayCycles = (gCdcTempUint16 << 8) + receiving_Data_Packet.DataBuf[0];
-                gCdcTempUint8 = Respond_Accept_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_SetDetectCharger_DelayCycle,&(gCdcTempUint8), 1);
-                break;
+    if(result != Func_Success){
+        CDC_Command_Stats[index].Error_Count++;
+        respond_code = Respond_Error_Check_Code;
+        _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(entry->Command,&respond_code, 1);
+    }else if(entry->Attribute == CDC_Cmd_Attr_Accept_Respond){
+        respond_code = Respond_Accept_Check_Code;
+        _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(entry->Command,&respond_code, 1);
+    }
+    CDC_Command_Stats[index].Hit_Count++;
+    //latency of accepted async cmd is counted when its result is sent
+    if((result != Func_Success) || (entry->Attribute != CDC_Cmd_Attr_Async)){
+        CDC_Command_Stats[index].Latency += _Device_Get_TimerA_Time_Stamp() - time_stamp;
+    }
+}
 
-            default:
-                gCdcTempUint8 = Respond_Error_Check_Code;
-                _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Error_Cmd,&(gCdcTempUint8), 1);
-                break;
-        }
+void _DUI_USB_Main_Polling_Function_For_Parsing_Receiving_Packet(){
 
+//    if( ((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found) == 0 ) ||
+//        ((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Check_True) == 0)){
+//        return;
+//    }
+//    if((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found) && (g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Check_True)){
+//        //_DUI_CDC_Transmitting_Data(&(receiving_Data_Packet.SlAdd), receiving_Data_Packet.DataLenExpected + 3);
+//        _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(receiving_Data_Packet.Command, &(receiving_Data_Packet.SlAdd), receiving_Data_Packet.DataLenExpected + 3);
+//        g_Usb_Cdc_Status_FLAG &= ~CDC_RX_Packet_Found;
+//        g_Usb_Cdc_Status_FLAG &= ~CDC_RX_Packet_Check_True;
+//    }
+    //no USB protocol packet is parsed in bridge mode
+    if(_DUI_Get_Comm_Module_Bridge() != Comm_Bridge_Off){
+        CDC_Bridge_Process();
+        return;
+    }
+    //SendBreak out of bridge mode is not used
+    _Device_Clear_USB_Break_Received();
+    //receiving USB data when ring buffer has space for one USB packet, otherwise data is held by USB API
+    if(((Comm_Receive_Buffer_Tail - Comm_Receive_Buffer_Head - 1) & Comm_Receive_Buffer_Mask) >= USB_Receive_Max_Bytes_Per_Packet){
+        _Device_USB_Receive_From_PC();
+    }
+    Parsing_Receive_Data_To_Packet();
+    if((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found) && (g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Check_True)){
+        CDC_Command_Dispatch(receiving_Data_Packet);
 
         g_Usb_Cdc_Status_FLAG &= ~CDC_RX_Packet_Found;
         g_Usb_Cdc_Status_FLAG &= ~CDC_RX_Packet_Check_True;
+        //only responses of the cmd have its sequence ID, async results have their response tags,
+        //received UART data, ADC stream and watch events are sent without sequence ID
+        g_Usb_Cdc_Status_FLAG &= ~CDC_TX_With_Sequence;
     }//if((g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Found) && (g_Usb_Cdc_Status_FLAG & CDC_RX_Packet_Check_True)){
+    //bytes of the module just bridged by the cmd are sent by CDC_Bridge_Process()
+    if(_DUI_Get_Comm_Module_Bridge() != Comm_Bridge_Off){
+        return;
+    }
     ///////////////////////////////////////////////////////////////////////////////////
     //Check_UART_RS485_Receive_Data Ready, and send out
     if(_DUI_Is_Comm_Module_Receiving_Data_Ready(Uart_RS485_Module) == UART_RECEIVING_DATA_READY){
-        _DUI_Get_Receiving_Data_To_Array(Uart_RS485_Module, Comm_Temp_Transmitting_Data_Buffer, &gCdcTempUint16, CDC_Transmitting_Max_Data_Length);
-        _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_UART_RS485_Receive_Data, Comm_Temp_Transmitting_Data_Buffer, gCdcTempUint16);
+        _DUI_CDC_Transmitting_UART_Frame_With_USB_Protocol_Packet(Cmd_UART_RS485_Receive_Data, 0, 0, Uart_RS485_Module);
     }
     ///////////////////////////////////////////////////////////////////////////////////
     //Check_One_Wire_Receive_Data Ready, and send out
     if(_DUI_Is_Comm_Module_Receiving_Data_Ready(One_Wire_Module) == UART_RECEIVING_DATA_READY){
-        _DUI_Get_Receiving_Data_To_Array(One_Wire_Module, Comm_Temp_Transmitting_Data_Buffer, &gCdcTempUint16, CDC_Transmitting_Max_Data_Length);
-        _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_One_Wire_Receive_Data, Comm_Temp_Transmitting_Data_Buffer, gCdcTempUint16);
+        _DUI_CDC_Transmitting_UART_Frame_With_USB_Protocol_Packet(Cmd_One_Wire_Receive_Data, 0, 0, One_Wire_Module);
     }
-
 }
 
 //void _Device_Set_USB_Receive_From_PC_Calling_Function(void (*calling_fun)(t_uint8* receivedBytesBuffer, t_uint16 receivingSize)){
@@ -96,6 +96,34 @@
 
 #define Cmd_Get_Charger_Is_ID_Level         (0xB2)
 
+#define Cmd_Get_All_Direct_Measurement      (0xB3)  //all Direct ADC and Real Values by one Sequence of Channels conversion
+
+#define Cmd_ADC_Stream_Start                (0xB4)  //timer triggered ADC streaming
+#define Cmd_ADC_Stream_Stop                 (0xB5)
+#define Cmd_ADC_Stream_Data_Block           (0xB6)  //only sent by FA, one block of streaming samples
+#define Cmd_ADC_Watch_Start                 (0xB7)  //window comparator watch, reports threshold crossings only
+#define Cmd_ADC_Watch_Stop                  (0xB8)
+#define Cmd_ADC_Watch_Event                 (0xB9)  //only sent by FA, one threshold crossing
+
+#define Cmd_Test_Sequence_Upload            (0xBA)  //bytecode of gate, mux, wait and measure steps
+#define Cmd_Test_Sequence_Run               (0xBB)  //result vector is sent when the sequence stops
+#define Cmd_Test_Sequence_Result            (0xBC)
+#define Cmd_Test_Sequence_Stop              (0xBD)
+
+#define Cmd_Limit_Table_Set                 (0xBE)  //pass/fail limits of Real Values
+#define Cmd_Limit_Table_Read_Back           (0xBF)
+#define Cmd_Set_Verdict_Mode                (0xC0)  //measurement responses with values, verdict or both
+#define Cmd_Get_Channel_Statistics          (0xC1)  //min, max, mean and variance over N conversions
+#define Cmd_Get_Time_Stamp                  (0xC2)  //free running tick of the fixture, for host clock alignment
+#define Cmd_Set_Time_Stamp_Mode             (0xC3)  //ADC start/done time stamps after measurement responses
+#define Cmd_Get_UART_Overrun_Count          (0xC4)  //bytes dropped by RS485 / one wire receiving rings
+#define Cmd_UART_Set_Frame_End_Mode         (0xC5)  //protocol end code / length and gap of received UART frames
+#define Cmd_UART_Transaction                (0xC6)  //transmit and await the reply with timeout and retries
+#define Cmd_Modbus_Read_Plan                (0xC7)  //Modbus RTU master, read register ranges by one cmd
+#define Cmd_Modbus_Write                    (0xC8)  //Modbus RTU master, function 06 / 16
+#define Cmd_UART_Bridge_Enter               (0xC9)  //transparent USB <-> UART bridge, bytes are not in USB protocol packets
+#define Cmd_UART_Bridge_Exit                (0xCA)  //only cmd parsed in bridge mode, as the whole USB packet
+
 
 // Calibration Status cmd
 #define Cmd_Cal_Set_Charger_24V_Channel_Offset  (0xD0)
@@ -111,6 +139,10 @@
 #define Cmd_Cal_Set_DSG_Current_CAL_ADC_offset      (0xD8)
 #define Cmd_Cal_Set_CHG_Current_CAL_ADC_offset      (0xD9)
 
+#define Cmd_Cal_Table_Upload                    (0xDA)  //piecewise linear calibration table, staged in RAM
+#define Cmd_Cal_Table_Read_Back                 (0xDB)
+#define Cmd_Cal_Table_Activate                  (0xDC)  //write the staged table to flash and use it
+
 
 // Test/Debug Status cmd
 #define Cmd_Error_Cmd                   (0xE0)
@@ -121,6 +153,13 @@
 // cmd
 #define Cmd_FW_HW_Version               (0xE5)  //
 #define Cmd_SetDetectCharger_DelayCycle (0xE6)  //
+#define Cmd_Get_Command_Statistics      (0xE7)  //hit, error and latency counters of each cmd
+
+//response tag of async cmd, kept by the job until its result is sent
+//CDC_Response_Tag_Sequence + sequence ID : result with sequence ID, 0 : result without sequence ID
+#define CDC_Response_Tag_Sequence       (0x0100)
+//bits 12 ~ 15 : latency slot + 1 of the async cmd, 0 : latency is not counted
+#define CDC_Response_Tag_Slot_Shift     12
 
 
 
@@ -190,7 +229,14 @@ void _DUI_USB_CDC_Polling_Status_Function();
 void _DUI_CDC_Receive_Calling_Function(t_uint8* receivedBytesBuffer, t_uint16 receivingSize);
 void _DUI_CDC_Transmitting_Data(t_uint8* sendBuffer, t_uint16 length);
 void _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(t_uint8 respons_cmd, t_uint8* sendBuffer, t_uint16 length);
+void _DUI_CDC_Transmitting_UART_Frame_With_USB_Protocol_Packet(t_uint8 respons_cmd, t_uint8* prefix, t_uint16 prefix_length, t_uint8 uart_module);
+t_uint16 _DUI_CDC_Get_Response_Tag();
+void _DUI_CDC_Transmitting_Async_Response(t_uint8 respons_cmd, t_uint16 response_tag, t_uint8* sendBuffer, t_uint16 length);
+void _DUI_CDC_Transmitting_Async_UART_Frame_Response(t_uint8 respons_cmd, t_uint16 response_tag, t_uint8* prefix, t_uint16 prefix_length, t_uint8 uart_module);
 void _DUI_USB_Main_Polling_Function_For_Parsing_Receiving_Packet();
+t_uint8 _DUI_USB_CDC_Is_Receiving_Data_Pending();
+void _DUI_CDC_Transmitting_ADC_Stream_Block();
+void _DUI_CDC_Transmitting_ADC_Watch_Event();
 
 // For USB CDC Setup  : (section stop)
 //////////////////////////////////////////////////
@@ -1,10 +1,12 @@
 
 
 
+#include "MCU_Devices/TypeDefine.h"
+
 #define Global_VarArray_Int_Size	                        (19)
 
 
-extern unsigned int G_Var_Array[];
+extern t_uint16 G_Var_Array[];
 
 
 #define G_SysModeStatusCode                 (G_Var_Array[ 0])
@@ -23,7 +25,9 @@ extern unsigned int G_Var_Array[];
 #define G_Temp_RealValue_From_ADC_L1        (G_Var_Array[ 13])  //use
 #define G_Temp_ADC_L2                       (G_Var_Array[ 14])  //use
 #define G_Temp_RealValue_From_ADC_L2        (G_Var_Array[ 15])  //use
-#define G_Temp_1_DelayCycles                (G_Var_Array[ 16])  //use
+#define G_Temp_ADC_Result_Num               (6)                 //G_Temp_ADC_L0 ~ G_Temp_RealValue_From_ADC_L2
+#define G_Temp_1_DelayCycles                (G_Var_Array[ 16])  //use, not cleared with the results
+#define DelayCycles_To_MS(cycles)           ((t_uint16)(((t_uint32)(cycles) * 634 + 999) / 1000))  //same time as DelayCycles() of main.c
 #define G_Temp_2                            (G_Var_Array[ 17])  //use
 #define G_Temp_3                            (G_Var_Array[ 18])  //use
 
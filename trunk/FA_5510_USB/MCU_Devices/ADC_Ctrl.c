@@ -23,6 +23,7 @@
 #include "adc10_a.h"
 #include "ref.h"
 #include "msp_dma.h"
+#include "timer_a.h"
 //#include "ucs.h"
 #include "MCU_Devices.h"
 //==============================================================================
@@ -116,6 +117,51 @@
 #define ADC_conversion_Channels     8  //do not modify
 //uint16_t ADC_Result[ADC_conversion_Times][ADC_conversion_Channels];
 uint16_t ADC_Result[ADC_conversion_Channels];
+//time stamps of the last result, _Device_Get_TimerA_Time_Stamp() at ADC start and DMA done
+__IO t_uint32 ADC_Start_Time_Stamp;
+__IO t_uint32 ADC_Done_Time_Stamp;
+
+//ADC streaming ping-pong buffers, filled by DMA1 one after the other
+t_uint16 ADC_Stream_Buffer[2][ADC_Stream_Block_Samples];
+__IO t_uint8 ADC_Stream_Mode;
+__IO t_uint8 ADC_Stream_Ready_Flag;                 //bit0: buffer 0 is ready, bit1: buffer 1 is ready
+__IO t_uint32 ADC_Stream_Block_Counter;             //done blocks, buffer index = (counter & 0x01)
+__IO t_uint16 ADC_Stream_Dropped_Block_Counter;     //blocks overwritten before sending
+
+//oversampling of repeated single channel, each DMA block is reduced by DMA1_ISR
+//while DMA1 fills the other ping-pong buffer, so conversions never wait for the reducer
+t_uint16 ADC_Oversample_Buffer[2][ADC_Oversample_Block_Samples];
+__IO t_uint8 ADC_Oversample_Mode;                   //repeated single channel conversion is running
+__IO t_uint8 ADC_Oversample_Done_Index;             //ping-pong buffer of the next done block
+t_uint8 ADC_Oversample_Continuous;                  //conversions go on after the result for the next one
+__IO t_uint8 ADC_Oversample_Result_Ready;           //continuous result is not taken yet
+__IO t_uint16 ADC_Oversample_Overrun_Counter;       //blocks overwritten while reducing, results not taken in time
+__IO t_uint32 ADC_Oversample_Next_Start_Time_Stamp; //continuous result in progress is started at the last DMA done
+t_uint16 ADC_Oversample_Blocks = 1;                 //DMA blocks of one result
+ADC_Oversample_Reducer ADC_Oversample_Reducer_Type = ADC_Reducer_Mean;
+__IO t_uint16 ADC_Oversample_Block_Counter;
+__IO t_uint32 ADC_Oversample_Accumulator;
+t_uint16 ADC_Oversample_Result_x4;                  //result in 1/4 LSB
+
+//ADC window watch, events are queued by ADC10_ISR and sent by main()
+#define ADC_Watch_Event_Queue_Mask      (ADC_Watch_Event_Queue_Size - 1)
+#define ADC_Watch_Divided_Sample_Rate   100     //Timer A0 is SMCLK / 64 below this rate
+__IO t_uint8 ADC_Watch_Mode;
+__IO t_uint8 ADC_Watch_Current_State;
+t_uint16 ADC_Watch_Low_Threshold;
+t_uint16 ADC_Watch_High_Threshold;
+__IO t_uint32 ADC_Watch_Block_Counter;              //DMA1 blocks of ADC_Stream_Block_Samples conversions
+ADC_Watch_Event ADC_Watch_Events[ADC_Watch_Event_Queue_Size];
+__IO t_uint8 ADC_Watch_Event_Head;                  //written by ADC10_ISR
+__IO t_uint8 ADC_Watch_Event_Tail;                  //written by main()
+__IO t_uint16 ADC_Watch_Lost_Event_Counter;         //events dropped while the queue is full
+//window comparator interrupts of the crossings out of each ADC_Watch_State
+static const t_uint16 ADC_Watch_Interrupt_Mask[] = {
+    ADC10HIIE + ADC10LOIE + ADC10INIE,  //ADC_Watch_Unknown
+    ADC10HIIE + ADC10INIE,              //ADC_Watch_Below
+    ADC10HIIE + ADC10LOIE,              //ADC_Watch_Inside
+    ADC10LOIE + ADC10INIE               //ADC_Watch_Above
+};
 
 //==============================================================================
 // Private function prototypes
@@ -277,17 +323,31 @@ void _Device_Measured_Sequence_ADC_Conversion_Start(void){
          * Use ADC_Result[i*2] as destination
          * Increment destination address after every transfer
          */
+        //DMA1DA is loaded by enabling, the last ping-pong buffer of RepeatedSingle mode is not used
+        DMA_disableTransfers(DMA_BASE, DMA_CHANNEL_1);
         DMA_setDstAddress(DMA_BASE,
             DMA_CHANNEL_1,
             //(uint32_t)&ADC_Result[i][0],
             (uint32_t)&ADC_Result[0],
             DMA_DIRECTION_INCREMENT);
+        DMA_enableTransfers(DMA_BASE, DMA_CHANNEL_1);
 
             //Wait if ADC10_A core is active
             while (ADC10_A_isBusy(ADC10_A_BASE)) ;
 
+            ADC_Oversample_Mode = 0;
+            ADC_Oversample_Continuous = 0;
+
+            //sequence is A7 down to A0, input may be changed by RepeatedSingle mode,
+            //so ADC and DMA are shared with RepeatedSingle mode without init again
+            ADC10_A_memoryConfigure(ADC10_A_BASE,
+                ADC10_A_INPUT_A7,
+                ADC10_A_VREFPOS_INT,
+                ADC10_A_VREFNEG_AVSS);
+
             //Enable and Start the conversion
             //in Repeated Sequence of Channels Conversion Mode
+            ADC_Start_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
             ADC10_A_startConversion(ADC10_A_BASE,
                 ADC10_A_REPEATED_SEQOFCHANNELS);
             //__bis_SR_register(LPM0_bits);
@@ -297,6 +357,7 @@ void _Device_Measured_Sequence_ADC_Conversion_Start(void){
 void  _Device_Measured_RepeatedSingle_ADC_Init(){
 
     Interrupt_ADC_Conversion_Done_ptr_fuc = empty_ADC_Conversion_Done_fun;
+    ADC_Oversample_Continuous = 0;
 
     GPIO_setAsInputPin( MEASUREMENT_ADC_PORT, 0xff );   //all ADC Pin
 
@@ -362,7 +423,7 @@ void  _Device_Measured_RepeatedSingle_ADC_Init(){
     DMA_init(DMA_BASE,
         DMA_CHANNEL_1,
         DMA_TRANSFER_REPEATED_SINGLE,
-        8,
+        ADC_Oversample_Block_Samples,
         DMA_TRIGGERSOURCE_24,
         DMA_SIZE_SRCWORD_DSTWORD,
         DMA_TRIGGER_RISINGEDGE);
@@ -392,6 +453,17 @@ void  _Device_Measured_RepeatedSingle_ADC_Init(){
         DMA_CHANNEL_1);
 
 
+}
+// samples : ADC_Oversample_Min_Samples ~ ADC_Oversample_Max_Samples, multiple of ADC_Oversample_Block_Samples
+// used from the next _Device_Measured_RepeatedSingle_ADC_Conversion_Start()
+t_uint8 _Device_Set_RepeatedSingle_ADC_Oversampling(t_uint16 samples, ADC_Oversample_Reducer reducer){
+    if((samples < ADC_Oversample_Min_Samples) || (samples > ADC_Oversample_Max_Samples) ||
+       (samples % ADC_Oversample_Block_Samples) || (reducer > ADC_Reducer_Decimate)){
+        return Func_Failure;
+    }
+    ADC_Oversample_Blocks = samples / ADC_Oversample_Block_Samples;
+    ADC_Oversample_Reducer_Type = reducer;
+    return Func_Success;
 }
 void  _Device_Set_Measured_RepeatedSingle_ADC_Chasnnel(MeasuredSingleADCChannels adc_channel){
     /*
@@ -405,20 +477,55 @@ void  _Device_Set_Measured_RepeatedSingle_ADC_Chasnnel(MeasuredSingleADCChannels
         ADC10_A_VREFPOS_INT,
         ADC10_A_VREFNEG_AVSS);
 }
+// continuous : conversions are not stopped after a result, the next result is converted
+//              while main() handles the last one, used for many results of the same channel
+// not continuous : conversions are stopped after each result
+void _Device_Set_RepeatedSingle_ADC_Continuous(t_uint8 enable){
+    if(enable){
+        ADC_Oversample_Overrun_Counter = 0;
+    }else if(ADC_Oversample_Continuous && ADC_Oversample_Mode){
+        ADC_Oversample_Mode = 0;
+        ADC10_A_disableConversions(ADC10_A_BASE, ADC10_A_PREEMPTCONVERSION);
+    }
+    ADC_Oversample_Continuous = enable;
+    ADC_Oversample_Result_Ready = 0;
+}
+// overrun counter since the last _Device_Set_RepeatedSingle_ADC_Continuous(1)
+t_uint16 _Device_Get_RepeatedSingle_ADC_Overrun_Count(){
+    return ADC_Oversample_Overrun_Counter;
+}
 void _Device_Measured_RepeatedSingle_ADC_Conversion_Start(void){
     volatile uint16_t i;
 
+        if(ADC_Oversample_Continuous && ADC_Oversample_Mode){
+            //conversions are running, last result is taken and the next one is in progress
+            ADC_Oversample_Result_Ready = 0;
+            return;
+        }
+        ADC_Oversample_Accumulator = 0;
+        ADC_Oversample_Block_Counter = 0;
+        ADC_Oversample_Done_Index = 0;
+        ADC_Oversample_Result_Ready = 0;
+        ADC_Oversample_Mode = 1;
+
         //Configure Memory Buffer
         /*
          * Base Address of the DMA Module
          * Configure DMA channel 1
-         * Use ADC_Result[i*2] as destination
+         * Use ADC_Oversample_Buffer[0] as destination, it is copied into the
+         * temporary register by enabling, DMA1DA is reloaded at the end of block,
+         * so next block goes to ADC_Oversample_Buffer[1]
          * Increment destination address after every transfer
          */
+        DMA_disableTransfers(DMA_BASE, DMA_CHANNEL_1);
         DMA_setDstAddress(DMA_BASE,
             DMA_CHANNEL_1,
-            //(uint32_t)&ADC_Result[i][0],
-            (uint32_t)&ADC_Result[0],
+            (uint32_t)&ADC_Oversample_Buffer[0][0],
+            DMA_DIRECTION_INCREMENT);
+        DMA_enableTransfers(DMA_BASE, DMA_CHANNEL_1);
+        DMA_setDstAddress(DMA_BASE,
+            DMA_CHANNEL_1,
+            (uint32_t)&ADC_Oversample_Buffer[1][0],
             DMA_DIRECTION_INCREMENT);
 
             //Wait if ADC10_A core is active
@@ -426,10 +533,21 @@ void _Device_Measured_RepeatedSingle_ADC_Conversion_Start(void){
 
             //Enable and Start the conversion
             //in Repeated Sequence of Channels Conversion Mode
+            ADC_Start_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+            ADC_Oversample_Next_Start_Time_Stamp = ADC_Start_Time_Stamp;
             ADC10_A_startConversion(ADC10_A_BASE,
                 ADC10_A_REPEATED_SINGLECHANNEL);
             //__bis_SR_register(LPM0_bits);
 }
+// time stamps of the last result, Timer_A_Counts_Per_MS counts per ms
+// start : conversion is started, or the last result is done in continuous mode
+// done  : DMA1_ISR of the last block
+void _Device_Get_ADC_Time_Stamps(t_uint32 *start_time_stamp, t_uint32 *done_time_stamp){
+    __disable_interrupt();
+    *start_time_stamp = ADC_Start_Time_Stamp;
+    *done_time_stamp = ADC_Done_Time_Stamp;
+    __enable_interrupt();
+}
 
 void _Device_Set_Interrupt_For_ADC_Conversion_Done_Calling_Function(void (*calling_fun)()){
     Interrupt_ADC_Conversion_Done_ptr_fuc = calling_fun;
@@ -499,30 +617,520 @@ t_uint16 _Device_Get_Sequence_ADC_Result(t_uint8 ADCchannel){
     }
 }
 
+// 10 bits result of the reducer, rounded
 t_uint16 _Device_Get_RepeatedSingle_ADC_Result(){
-	volatile uint16_t ADC_Result_Average;
-    uint8_t i;
-    uint16_t ADC_Result_sum;
-
-        //Clear accumulate register
-        ADC_Result_sum = 0x0;
-        for (i = 0; i < 8; i++){
-            ADC_Result_sum += ADC_Result[i];
-        }
+    return (ADC_Oversample_Result_x4 + 2) >> 2;
+}
+// 12 bits result for ADC_Reducer_Decimate, otherwise 10 bits result
+t_uint16 _Device_Get_RepeatedSingle_ADC_Reduced_Result(){
+    if(ADC_Oversample_Reducer_Type == ADC_Reducer_Decimate){
+        return ADC_Oversample_Result_x4;
+    }
+    return _Device_Get_RepeatedSingle_ADC_Result();
+}
+
+// reduce one DMA block into the accumulator, return 1 when all blocks are done
+static t_uint8 ADC_Oversample_Block_Done(void){
+    t_uint16 *block;
+    t_uint16 sample;
+    t_uint16 sum;
+    t_uint8 i;
+    t_uint8 j;
+    t_uint8 k;
+
+    //DMA is filling the other buffer now, done buffer is for the block after next,
+    //so the reducer has a whole block time and works in place
+    block = &ADC_Oversample_Buffer[ADC_Oversample_Done_Index][0];
+    DMA_setDstAddress(DMA_BASE,
+        DMA_CHANNEL_1,
+        (uint32_t)block,
+        DMA_DIRECTION_INCREMENT);
+    ADC_Oversample_Done_Index ^= 0x01;
+    sum = 0;
+    switch(ADC_Oversample_Reducer_Type){
+        case ADC_Reducer_Median:
+            //insertion sort, sum of 2 middle samples is median x 2
+            for(i = 1; i < ADC_Oversample_Block_Samples; i++){
+                sample = block[i];
+                for(j = i; (j > 0) && (block[j - 1] > sample); j--){
+                    block[j] = block[j - 1];
+                }
+                block[j] = sample;
+            }
+            sum = block[(ADC_Oversample_Block_Samples >> 1) - 1] + block[ADC_Oversample_Block_Samples >> 1];
+            break;
+        case ADC_Reducer_Trimmed_Mean:
+            i = 0;      //index of min
+            j = 0;      //index of max
+            for(k = 0; k < ADC_Oversample_Block_Samples; k++){
+                sum += block[k];
+                if(block[k] < block[i]){
+                    i = k;
+                }
+                if(block[k] > block[j]){
+                    j = k;
+                }
+            }
+            sum -= block[i] + block[j];
+            break;
+        default:
+            for(i = 0; i < ADC_Oversample_Block_Samples; i++){
+                sum += block[i];
+            }
+            break;
+    }
+    if(DMA_getInterruptStatus(DMA_BASE, DMA_CHANNEL_1) == DMA_INT_ACTIVE){
+        //the other buffer is done too, DMA has started to overwrite this one
+        ADC_Oversample_Overrun_Counter++;
+    }
+    ADC_Oversample_Accumulator += sum;
+    ADC_Oversample_Block_Counter++;
+    if(ADC_Oversample_Block_Counter < ADC_Oversample_Blocks){
+        return 0;
+    }
+    return 1;
+}
+
+// result of the accumulated blocks, the accumulator is cleared for the next result
+static void ADC_Oversample_Latch_Result(void){
+    t_uint16 divisor;
+
+    //number of samples in the accumulator
+    switch(ADC_Oversample_Reducer_Type){
+        case ADC_Reducer_Median:
+            divisor = ADC_Oversample_Blocks * 2;
+            break;
+        case ADC_Reducer_Trimmed_Mean:
+            divisor = ADC_Oversample_Blocks * (ADC_Oversample_Block_Samples - 2);
+            break;
+        default:
+            divisor = ADC_Oversample_Blocks * ADC_Oversample_Block_Samples;
+            break;
+    }
+    ADC_Oversample_Result_x4 = (t_uint16)(((ADC_Oversample_Accumulator << 2) + (divisor >> 1)) / divisor);
+    ADC_Oversample_Accumulator = 0;
+    ADC_Oversample_Block_Counter = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ADC streaming
+// Timer A0 CCR1 output (TA0.1) triggers one conversion at each period, DMA1
+// moves ADC_Stream_Block_Samples results into one ping-pong buffer and then
+// goes on with the other one without stopping the conversions.
+// In sequence mode, channels are A(ADCchannel) down to A0 and repeated, so the
+// channel of a sample is (ADCchannel - (sample number % (ADCchannel + 1))).
+// Timer B0 is not used as trigger source, it is the 1ms base of the
+// calling-function table (UART frame detection, charger checking).
+////////////////////////////////////////////////////////////////////////////////
+t_uint8 _Device_ADC_Stream_Start(t_uint8 ADCchannel, t_uint8 sequence, t_uint16 sample_rate){
+    t_uint16 period;
+
+    if((ADCchannel > ADC_Channel7) || (sample_rate < ADC_Stream_Min_Sample_Rate) || (sample_rate > ADC_Stream_Max_Sample_Rate)){
+        return Func_Failure;
+    }
+    period = (t_uint16)(REQUIRE_FREQ_SMCLK / sample_rate);
+
+    TIMER_A_stop(TIMER_A0_BASE);
+    ADC10_A_disableConversions(ADC10_A_BASE, ADC10_A_PREEMPTCONVERSION);
+    DMA_disableTransfers(DMA_BASE, DMA_CHANNEL_1);
+
+    ADC_Stream_Ready_Flag = 0;
+    ADC_Stream_Block_Counter = 0;
+    ADC_Stream_Dropped_Block_Counter = 0;
+    ADC_Stream_Mode = 1;
+    ADC_Oversample_Mode = 0;
+    ADC_Oversample_Continuous = 0;
+    ADC_Watch_Mode = 0;
+
+    /*
+     * Base Address for the ADC10_A Module
+     * Use TA0.1 output as sample/hold signal, one conversion at each rising edge
+     * USE MODOSC 5MHZ Digital Oscillator as clock source
+     * Use default clock divider of 1
+     */
+    ADC10_A_init(ADC10_A_BASE,
+        ADC10_A_SAMPLEHOLDSOURCE_1,
+        ADC10_A_CLOCKSOURCE_ADC10OSC,
+        ADC10_A_CLOCKDIVIDER_1);
+
+    ADC10_A_enable(ADC10_A_BASE);
+
+    /*
+     * Base Address for the ADC10_A Module
+     * Sample/hold for 32 clock cycles, (32 + 11) / 5MHz = 8.6us (< 20us at 50kS/s)
+     * Disable Multiple Sampling, conversions are triggered by timer
+     */
+    ADC10_A_setupSamplingTimer(ADC10_A_BASE,
+        ADC10_A_CYCLEHOLD_32_CYCLES,
+        ADC10_A_MULTIPLESAMPLESDISABLE);
+
+    ADC10_A_setResolution(ADC10_A_BASE,
+        ADC10_A_RESOLUTION_10BIT);
+
+    //internal reference 2.5V is kept on by _Device_Measured_RepeatedSingle_ADC_Init()
+    ADC10_A_memoryConfigure(ADC10_A_BASE,
+        ADCchannel,
+        ADC10_A_VREFPOS_INT,
+        ADC10_A_VREFNEG_AVSS);
+
+    /*
+     * Base Address of the DMA Module
+     * Configure DMA channel 1
+     * Configure channel for repeated single transfer
+     * DMA interrupt flag will be set after every ADC_Stream_Block_Samples transfers
+     * Use DMA Trigger Source 24 (ADC10IFG)
+     * Tranfer Word-to-Word
+     * Trigger upon Rising Edge of Trigger Source
+     */
+    DMA_init(DMA_BASE,
+        DMA_CHANNEL_1,
+        DMA_TRANSFER_REPEATED_SINGLE,
+        ADC_Stream_Block_Samples,
+        DMA_TRIGGERSOURCE_24,
+        DMA_SIZE_SRCWORD_DSTWORD,
+        DMA_TRIGGER_RISINGEDGE);
+
+    DMA_setSrcAddress(DMA_BASE,
+        DMA_CHANNEL_1,
+        ADC10_A_getMemoryAddressForDMA(ADC10_A_BASE),
+        DMA_DIRECTION_UNCHANGED);
+
+    DMA_setDstAddress(DMA_BASE,
+        DMA_CHANNEL_1,
+        (uint32_t)&ADC_Stream_Buffer[0][0],
+        DMA_DIRECTION_INCREMENT);
+
+    DMA_clearInterrupt(DMA_BASE,
+        DMA_CHANNEL_1);
+    DMA_enableInterrupt(DMA_BASE,
+        DMA_CHANNEL_1);
+    DMA_enableTransfers(DMA_BASE,
+        DMA_CHANNEL_1);
+
+    //buffer 0 is copied into the temporary register by enabling,
+    //DMA1DA is reloaded at the end of block, so next block goes to buffer 1
+    DMA_setDstAddress(DMA_BASE,
+        DMA_CHANNEL_1,
+        (uint32_t)&ADC_Stream_Buffer[1][0],
+        DMA_DIRECTION_INCREMENT);
+
+    //Timer A0 up mode, TA0.1 rising edge at every period of SMCLK
+    TIMER_A_configureUpMode(TIMER_A0_BASE,
+        TIMER_A_CLOCKSOURCE_SMCLK,
+        TIMER_A_CLOCKSOURCE_DIVIDER_1,
+        period - 1,
+        TIMER_A_TAIE_INTERRUPT_DISABLE,
+        TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,
+        TIMER_A_DO_CLEAR);
+    TIMER_A_initCompare(TIMER_A0_BASE,
+        TIMER_A_CAPTURECOMPARE_REGISTER_1,
+        TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,
+        TIMER_A_OUTPUTMODE_RESET_SET,
+        period >> 1);
+
+    if(sequence){
+        ADC10_A_startConversion(ADC10_A_BASE,
+            ADC10_A_REPEATED_SEQOFCHANNELS);
+    }else{
+        ADC10_A_startConversion(ADC10_A_BASE,
+            ADC10_A_REPEATED_SINGLECHANNEL);
+    }
+    TIMER_A_startCounter(TIMER_A0_BASE, TIMER_A_UP_MODE);
+
+    return Func_Success;
+}
+
+void _Device_ADC_Stream_Stop(void){
+    TIMER_A_stop(TIMER_A0_BASE);
+    ADC10_A_disableConversions(ADC10_A_BASE, ADC10_A_PREEMPTCONVERSION);
+    DMA_disableTransfers(DMA_BASE, DMA_CHANNEL_1);
+    ADC_Stream_Mode = 0;
+    ADC_Stream_Ready_Flag = 0;
+}
+
+t_uint8 _Device_ADC_Stream_Is_Block_Ready(void){
+    return (ADC_Stream_Ready_Flag != 0);
+}
+
+// return the last done block and its block number, 0 if it is sent or overwritten
+t_uint16* _Device_ADC_Stream_Get_Ready_Block(t_uint32 *block_number){
+    t_uint16 *block;
+
+    block = 0;
+    __disable_interrupt();
+    *block_number = ADC_Stream_Block_Counter - 1;
+    if(ADC_Stream_Ready_Flag & (1 << (*block_number & 0x01))){
+        block = &ADC_Stream_Buffer[*block_number & 0x01][0];
+    }
+    __enable_interrupt();
+    return block;
+}
+
+// return Func_Failure if DMA starts to overwrite the block while it is being read,
+// the block is counted as dropped by ISR
+t_uint8 _Device_ADC_Stream_Release_Block(t_uint32 block_number){
+    t_uint8 result;
+
+    result = Func_Failure;
+    __disable_interrupt();
+    if((ADC_Stream_Block_Counter == (block_number + 1)) && (ADC_Stream_Ready_Flag & (1 << (block_number & 0x01)))){
+        ADC_Stream_Ready_Flag &= ~(1 << (block_number & 0x01));
+        result = Func_Success;
+    }
+    __enable_interrupt();
+    return result;
+}
 
-        //Average of 64 conversions results
-        ADC_Result_Average = ADC_Result_sum >> 3;
+t_uint16 _Device_ADC_Stream_Get_Dropped_Blocks(void){
+    return ADC_Stream_Dropped_Block_Counter;
+}
 
-        //SET BREAKPOINT HERE to be able to watch ADC_Result_Average
-        //Delay before next 64 conversions
-        //__delay_cycles(5);
+static void ADC_Stream_Block_Done(void){
+    t_uint8 done_index;
 
-        return ADC_Result_Average;
+    done_index = (t_uint8)ADC_Stream_Block_Counter & 0x01;
+    //DMA is filling the other buffer now, done buffer is for the block after next
+    DMA_setDstAddress(DMA_BASE,
+        DMA_CHANNEL_1,
+        (uint32_t)&ADC_Stream_Buffer[done_index][0],
+        DMA_DIRECTION_INCREMENT);
+    if(ADC_Stream_Ready_Flag & (1 << (done_index ^ 0x01))){
+        //the filling buffer is not sent yet
+        ADC_Stream_Ready_Flag &= ~(1 << (done_index ^ 0x01));
+        ADC_Stream_Dropped_Block_Counter++;
+    }
+    ADC_Stream_Ready_Flag |= (1 << done_index);
+    ADC_Stream_Block_Counter++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ADC window watch
+// Conversions are triggered by TA0.1 as streaming, the window comparator of
+// ADC10_A checks every result with ADC10LO / ADC10HI and only the interrupts of
+// the crossings out of the current state are enabled, so ADC10_ISR runs only
+// when the value leaves or re-enters the window.
+// DMA1 moves the results into a scratch block without CPU, the sample number
+// of an event is blocks * ADC_Stream_Block_Samples + transfers of the block.
+////////////////////////////////////////////////////////////////////////////////
+t_uint8 _Device_ADC_Watch_Start(t_uint8 ADCchannel, t_uint16 sample_rate, t_uint16 low_threshold, t_uint16 high_threshold){
+    t_uint16 period;
+    t_uint16 divider;
+
+    if((ADCchannel > ADC_Channel7) || (sample_rate < ADC_Watch_Min_Sample_Rate) || (sample_rate > ADC_Watch_Max_Sample_Rate) ||
+       (low_threshold > high_threshold) || (high_threshold > ADC_Watch_Max_Threshold)){
+        return Func_Failure;
+    }
+    if(sample_rate < ADC_Watch_Divided_Sample_Rate){
+        divider = TIMER_A_CLOCKSOURCE_DIVIDER_64;
+        period = (t_uint16)((REQUIRE_FREQ_SMCLK / 64) / sample_rate);
+    }else{
+        divider = TIMER_A_CLOCKSOURCE_DIVIDER_1;
+        period = (t_uint16)(REQUIRE_FREQ_SMCLK / sample_rate);
+    }
+
+    TIMER_A_stop(TIMER_A0_BASE);
+    ADC10_A_disableConversions(ADC10_A_BASE, ADC10_A_PREEMPTCONVERSION);
+    DMA_disableTransfers(DMA_BASE, DMA_CHANNEL_1);
+
+    ADC_Watch_Low_Threshold = low_threshold;
+    ADC_Watch_High_Threshold = high_threshold;
+    ADC_Watch_Current_State = ADC_Watch_Unknown;
+    ADC_Watch_Block_Counter = 0;
+    ADC_Watch_Event_Head = 0;
+    ADC_Watch_Event_Tail = 0;
+    ADC_Watch_Lost_Event_Counter = 0;
+    ADC_Watch_Mode = 1;
+    ADC_Stream_Mode = 0;
+    ADC_Oversample_Mode = 0;
+    ADC_Oversample_Continuous = 0;
+
+    /*
+     * Base Address for the ADC10_A Module
+     * Use TA0.1 output as sample/hold signal, one conversion at each rising edge
+     * USE MODOSC 5MHZ Digital Oscillator as clock source
+     * Use default clock divider of 1
+     */
+    ADC10_A_init(ADC10_A_BASE,
+        ADC10_A_SAMPLEHOLDSOURCE_1,
+        ADC10_A_CLOCKSOURCE_ADC10OSC,
+        ADC10_A_CLOCKDIVIDER_1);
+
+    ADC10_A_enable(ADC10_A_BASE);
+
+    /*
+     * Base Address for the ADC10_A Module
+     * Sample/hold for 128 clock cycles as measurement, (128 + 11) / 5MHz = 28us (< 100us at 10kS/s)
+     * Disable Multiple Sampling, conversions are triggered by timer
+     */
+    ADC10_A_setupSamplingTimer(ADC10_A_BASE,
+        ADC10_A_CYCLEHOLD_128_CYCLES,
+        ADC10_A_MULTIPLESAMPLESDISABLE);
+
+    ADC10_A_setResolution(ADC10_A_BASE,
+        ADC10_A_RESOLUTION_10BIT);
+
+    //internal reference 2.5V is kept on by _Device_Measured_RepeatedSingle_ADC_Init()
+    ADC10_A_memoryConfigure(ADC10_A_BASE,
+        ADCchannel,
+        ADC10_A_VREFPOS_INT,
+        ADC10_A_VREFNEG_AVSS);
+
+    //window comparator, the first conversion is reported as the initial state
+    ADC10_A_setWindowComp(ADC10_A_BASE,
+        high_threshold,
+        low_threshold);
+    ADC10_A_clearInterrupt(ADC10_A_BASE,
+        ADC10HIIFG + ADC10LOIFG + ADC10INIFG);
+    ADC10_A_enableInterrupt(ADC10_A_BASE,
+        ADC_Watch_Interrupt_Mask[ADC_Watch_Unknown]);
+
+    /*
+     * Base Address of the DMA Module
+     * Configure DMA channel 1
+     * Configure channel for repeated single transfer
+     * DMA interrupt flag will be set after every ADC_Stream_Block_Samples transfers
+     * Use DMA Trigger Source 24 (ADC10IFG)
+     * Tranfer Word-to-Word
+     * Trigger upon Rising Edge of Trigger Source
+     */
+    DMA_init(DMA_BASE,
+        DMA_CHANNEL_1,
+        DMA_TRANSFER_REPEATED_SINGLE,
+        ADC_Stream_Block_Samples,
+        DMA_TRIGGERSOURCE_24,
+        DMA_SIZE_SRCWORD_DSTWORD,
+        DMA_TRIGGER_RISINGEDGE);
+
+    DMA_setSrcAddress(DMA_BASE,
+        DMA_CHANNEL_1,
+        ADC10_A_getMemoryAddressForDMA(ADC10_A_BASE),
+        DMA_DIRECTION_UNCHANGED);
+
+    //streaming buffer is the scratch block, results are not used
+    DMA_setDstAddress(DMA_BASE,
+        DMA_CHANNEL_1,
+        (uint32_t)&ADC_Stream_Buffer[0][0],
+        DMA_DIRECTION_INCREMENT);
+
+    DMA_clearInterrupt(DMA_BASE,
+        DMA_CHANNEL_1);
+    DMA_enableInterrupt(DMA_BASE,
+        DMA_CHANNEL_1);
+    DMA_enableTransfers(DMA_BASE,
+        DMA_CHANNEL_1);
+
+    //Timer A0 up mode, TA0.1 rising edge at every period
+    TIMER_A_configureUpMode(TIMER_A0_BASE,
+        TIMER_A_CLOCKSOURCE_SMCLK,
+        divider,
+        period - 1,
+        TIMER_A_TAIE_INTERRUPT_DISABLE,
+        TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,
+        TIMER_A_DO_CLEAR);
+    TIMER_A_initCompare(TIMER_A0_BASE,
+        TIMER_A_CAPTURECOMPARE_REGISTER_1,
+        TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,
+        TIMER_A_OUTPUTMODE_RESET_SET,
+        period >> 1);
+
+    ADC10_A_startConversion(ADC10_A_BASE,
+        ADC10_A_REPEATED_SINGLECHANNEL);
+    TIMER_A_startCounter(TIMER_A0_BASE, TIMER_A_UP_MODE);
+
+    return Func_Success;
+}
+
+void _Device_ADC_Watch_Stop(void){
+    TIMER_A_stop(TIMER_A0_BASE);
+    ADC10_A_disableInterrupt(ADC10_A_BASE, ADC10HIIE + ADC10LOIE + ADC10INIE);
+    ADC10_A_disableConversions(ADC10_A_BASE, ADC10_A_PREEMPTCONVERSION);
+    DMA_disableTransfers(DMA_BASE, DMA_CHANNEL_1);
+    ADC_Watch_Mode = 0;
+}
+
+t_uint8 _Device_ADC_Watch_Is_Event_Ready(void){
+    return (ADC_Watch_Event_Head != ADC_Watch_Event_Tail);
+}
+
+// return Func_Failure if there is no event, single producer (ADC10_ISR) and consumer (main())
+t_uint8 _Device_ADC_Watch_Get_Event(ADC_Watch_Event *event){
+    if(ADC_Watch_Event_Head == ADC_Watch_Event_Tail){
+        return Func_Failure;
+    }
+    *event = ADC_Watch_Events[ADC_Watch_Event_Tail];
+    ADC_Watch_Event_Tail = (ADC_Watch_Event_Tail + 1) & ADC_Watch_Event_Queue_Mask;
+    return Func_Success;
+}
+
+t_uint16 _Device_ADC_Watch_Get_Lost_Events(void){
+    return ADC_Watch_Lost_Event_Counter;
+}
+
+static void ADC_Watch_Crossing(void){
+    t_uint32 blocks;
+    t_uint16 remaining;
+    t_uint16 adc;
+    t_uint8 state;
+    ADC_Watch_Event *event;
+
+    //DMA1 has moved ADC10MEM0 already, DMA1SZ is reloaded at the end of a block
+    blocks = ADC_Watch_Block_Counter;
+    if(DMA1CTL & DMAIFG){
+        //DMA1_ISR is pending
+        blocks++;
+    }
+    remaining = DMA1SZ;
+    adc = ADC10MEM0;
+    ADC10_A_clearInterrupt(ADC10_A_BASE,
+        ADC10HIIFG + ADC10LOIFG + ADC10INIFG);
+
+    if(adc > ADC_Watch_High_Threshold){
+        state = ADC_Watch_Above;
+    }else if(adc < ADC_Watch_Low_Threshold){
+        state = ADC_Watch_Below;
+    }else{
+        state = ADC_Watch_Inside;
+    }
+    if(state == ADC_Watch_Current_State){
+        //flag of the previous conversion
+        return;
+    }
+    ADC_Watch_Current_State = state;
+    ADC10_A_disableInterrupt(ADC10_A_BASE, ADC10HIIE + ADC10LOIE + ADC10INIE);
+    ADC10_A_enableInterrupt(ADC10_A_BASE, ADC_Watch_Interrupt_Mask[state]);
+
+    if(((ADC_Watch_Event_Head + 1) & ADC_Watch_Event_Queue_Mask) == ADC_Watch_Event_Tail){
+        ADC_Watch_Lost_Event_Counter++;
+        return;
+    }
+    event = &ADC_Watch_Events[ADC_Watch_Event_Head];
+    event->Sample_Number = blocks * ADC_Stream_Block_Samples + (ADC_Stream_Block_Samples - remaining) - 1;
+    event->Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+    event->ADC = adc;
+    event->State = state;
+    ADC_Watch_Event_Head = (ADC_Watch_Event_Head + 1) & ADC_Watch_Event_Queue_Mask;
+}
+
+#pragma vector=ADC10_VECTOR
+__interrupt void ADC10_ISR (void)
+{
+    switch (__even_in_range(ADC10IV,12)){
+        case  6:        //ADC10HIIFG, above the window
+        case  8:        //ADC10LOIFG, below the window
+        case 10:        //ADC10INIFG, inside the window
+            ADC_Watch_Crossing();
+            //exit LPM0 for sending the event
+            __bic_SR_register_on_exit(LPM0_bits);
+            break;
+        default: break;
+    }
 }
 
 #pragma vector=DMA_VECTOR
 __interrupt void DMA1_ISR (void)
 {
+    t_uint32 time_stamp;
+
     switch (__even_in_range(DMAIV,16)){
         case  0: break; //No interrupt
         case  2:        //DMA0IFG
@@ -537,13 +1145,53 @@ __interrupt void DMA1_ISR (void)
 
             break;
         case  4: //DMA1IFG
+            if(ADC_Stream_Mode){
+                //Streaming block Complete, conversions go on
+                ADC_Stream_Block_Done();
+                //exit LPM0 for sending the block
+                __bic_SR_register_on_exit(LPM0_bits);
+                break;
+            }
+            if(ADC_Watch_Mode){
+                //scratch block is full, only counts the samples
+                ADC_Watch_Block_Counter++;
+                break;
+            }
+            if(ADC_Oversample_Mode){
+                if(ADC_Oversample_Block_Done() == 0){
+                    //more blocks, repeated single channel conversions go on
+                    break;
+                }
+                if(ADC_Oversample_Continuous){
+                    //conversions go on for the next result
+                    time_stamp = _Device_Get_TimerA_Time_Stamp();
+                    if(ADC_Oversample_Result_Ready){
+                        //last result is not taken yet, it is kept and this one is dropped
+                        ADC_Oversample_Accumulator = 0;
+                        ADC_Oversample_Block_Counter = 0;
+                        ADC_Oversample_Overrun_Counter++;
+                        ADC_Oversample_Next_Start_Time_Stamp = time_stamp;
+                        break;
+                    }
+                    ADC_Oversample_Latch_Result();
+                    ADC_Start_Time_Stamp = ADC_Oversample_Next_Start_Time_Stamp;
+                    ADC_Oversample_Next_Start_Time_Stamp = time_stamp;
+                    ADC_Done_Time_Stamp = time_stamp;
+                    ADC_Oversample_Result_Ready = 1;
+                    (*Interrupt_ADC_Conversion_Done_ptr_fuc)();
+                    __bic_SR_register_on_exit(LPM0_bits);
+                    break;
+                }
+                ADC_Oversample_Latch_Result();
+                ADC_Oversample_Mode = 0;
+            }
             //Sequence of Channels Conversion Complete
             //Disable Conversion without pre-empting any conversions taking place.
             ADC10_A_disableConversions(ADC10_A_BASE, ADC10_A_PREEMPTCONVERSION);
+            ADC_Done_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
             (*Interrupt_ADC_Conversion_Done_ptr_fuc)();
-            //exit LPM
-            //__bic_SR_register_on_exit(CPUOFF);
-            //__bic_SR_register_on_exit(LPM3_bits);   // Exit LPM0-3
+            //exit LPM0 for the next step of the measurement job
+            __bic_SR_register_on_exit(LPM0_bits);
             break;
         case  6: break; //DMA2IFG
         default: break;
@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @file    CRC_Module.c
+  * @author  Dynapack ADT, Hsinmo
+  * @version V1.0.0
+  * @date    17-October-2026
+  * @brief   CRC16 module
+  ******************************************************************************
+  * @attention
+  *
+  * CRC16 module computes CRC-CCITT (x^16 + x^12 + x^5 + 1) only.
+  * Bytes written to CRCDIRB_L and the result read from CRCINIRES give the
+  * standard CRC-CCITT (MSB first, 0x29B1 of "123456789" with seed 0xFFFF).
+  * ModBus CRC16 (x^16 + x^15 + x^2 + 1) can not be done by the module.
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 Dynapack</center></h2>
+  ******************************************************************************
+  */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include "inc/hw_memmap.h"
+#include "crc.h"
+
+#include "MCU_Devices.h"
+//==============================================================================
+// Global/Extern variables
+//==============================================================================
+//==============================================================================
+// Extern functions
+//==============================================================================
+//==============================================================================
+// Private typedef
+//==============================================================================
+//==============================================================================
+// Private define
+//==============================================================================
+//==============================================================================
+// Private macro
+//==============================================================================
+//==============================================================================
+// Private Enum
+//==============================================================================
+//==============================================================================
+// Private variables
+//==============================================================================
+//==============================================================================
+// Private function prototypes
+//==============================================================================
+//==============================================================================
+// Private functions
+//==============================================================================
+// one byte per write, no CPU cycles for the polynomial
+// the module is not shared by interrupts, do not call it in ISR
+t_uint16 _Device_CRC16_CCITT(t_uint16 seed, t_uint8 *data, t_uint16 length){
+    CRC_setSeed(CRC_BASE, seed);
+    while(length--){
+        CRCDIRB_L = *(data++);
+    }
+    return CRC_getResult(CRC_BASE);
+}
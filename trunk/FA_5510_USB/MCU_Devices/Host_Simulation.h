@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file    Host_Simulation.h
+  * @author  Dynapack ADT, Hsinmo
+  * @version V1.0.0
+  * @date    17-October-2026
+  * @brief   Host (Linux) simulation of the MCU_Devices layer
+  ******************************************************************************
+  * @attention
+  *
+  * Only used when _Config_HOST_SIMULATION_ is defined. Host_Simulation_Devices.c
+  * replaces every *.c source of MCU_Devices, so main.c and the DUI_* files can be
+  * compiled by the workstation compiler without the IAR project, e.g.
+  *
+  *   gcc -D_Config_HOST_SIMULATION_ -I. -o fa_sim main.c DUI_For_USB_CDC.c
+  *       DUI_For_UART.c DUI_For_Peripheral_Control.c Utilities/CheckSum16.c
+  *       Utilities/CRC16_CCITT.c Utilities/ModBus_CRC16.c MCU_Devices/Host_Simulation_Devices.c
+  *
+  * Host test programs are built the same way with their own main() instead of main.c:
+  *   Host_Simulation_Q16_Test.c  : Q16.16 real values against the float path, all ADC codes
+  *   Host_Simulation_CRC16_Test.c : usCRC16CCITT (CRC16 module model) against the software loop
+  *   Host_Simulation_CDC_Parse_Test.c : replay of recorded CDC traffic (Host_Simulation_CDC_Parse_Traffic.txt),
+  *                                      frames found and parse cost per byte
+  *
+  * Environment variables:
+  *   FA_SIM_SCRIPT   : script file for ADC waveforms and UART peers (see below)
+  *   FA_SIM_FLASH    : image file of Config_Segment, then segment D, B and A (written back)
+  *   FA_SIM_REALTIME : 0 = do not pace simulated time with wall clock
+  *   FA_SIM_TRACE    : 1 = print CDC round trip cycles to stderr
+  *                     2 = also print every received CDC chunk in hex (recorded traffic)
+  *
+  * Signals:
+  *   SIGUSR1         : SendBreak request of the host on the virtual CDC port
+  *
+  * Script lines ('#' for comment):
+  *   adc   <ch 0~7> <time ms> <adc code>   ; step waveform point
+  *   noise <lsb>                           ; deterministic noise amplitude
+  *   uart  <1|2> echo                      ; peer echoes every byte
+  *   uart  <1|2> reply <delay ms> <hex..>  ; peer replies after each frame
+  *   uart  <1|2> modbus <slave> <delay ms> [n] ; Modbus RTU slave, first n replies with CRC error
+  *
+  * The virtual CDC port is a pseudo terminal, its name is printed to stderr.
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 Dynapack</center></h2>
+  ******************************************************************************
+  */
+#pragma once
+
+#if defined(_Config_HOST_SIMULATION_)
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include "TypeDefine.h"
+
+//==============================================================================
+// Private define
+//==============================================================================
+#define VOID                            void
+
+#define LPM0_bits                       (0x0010)
+#define LPM3_bits                       (0x00D0)
+#define GIE                             (0x0008)
+
+#define WDTPW                           (0x5A00)
+#define WDTHOLD                         (0x0080)
+#define WDTCTL                          Host_Sim_WDTCTL
+
+#define GPIO_PORT_P1                    1
+#define GPIO_PORT_P2                    2
+#define GPIO_PIN0                       (0x0001)
+#define GPIO_PIN1                       (0x0002)
+#define GPIO_PIN2                       (0x0004)
+#define GPIO_PIN3                       (0x0008)
+#define GPIO_PIN4                       (0x0010)
+#define GPIO_PIN5                       (0x0020)
+#define GPIO_PIN6                       (0x0040)
+#define GPIO_PIN7                       (0x0080)
+
+//==============================================================================
+// Private macro
+//==============================================================================
+#define __delay_cycles(cycles)          Host_Sim_Advance_Cycles(cycles)
+#define __bis_SR_register(bits)         Host_Sim_Enter_Low_Power_Mode(bits)
+#define __enable_interrupt()            Host_Sim_Enable_Interrupt()
+#define __disable_interrupt()
+#define __no_operation()
+#define _NOP()
+
+#define GPIO_setOutputHighOnPin(port, pins)     Host_Sim_Set_GPIO((port), (pins), 1)
+#define GPIO_setOutputLowOnPin(port, pins)      Host_Sim_Set_GPIO((port), (pins), 0)
+#define GPIO_toggleOutputOnPin(port, pins)      Host_Sim_Set_GPIO((port), (pins), 2)
+
+//==============================================================================
+// Global/Extern variables
+//==============================================================================
+extern t_uint16 Host_Sim_WDTCTL;
+
+//==============================================================================
+// Public functions
+//==============================================================================
+void Host_Sim_Advance_Cycles(unsigned long cycles);
+void Host_Sim_Enter_Low_Power_Mode(t_uint16 bits);
+void Host_Sim_Enable_Interrupt(void);
+void Host_Sim_Set_GPIO(t_uint8 port, t_uint16 pins, t_uint8 level);
+unsigned long long Host_Sim_Get_Cycle_Count(void);
+
+#endif //_Config_HOST_SIMULATION_
@@ -0,0 +1,199 @@
+/**
+  ******************************************************************************
+  * @file    Host_Simulation_CDC_Parse_Test.c
+  * @author  Dynapack ADT, Hsinmo
+  * @version V1.0.0
+  * @date    17-October-2026
+  * @brief   Host replay of recorded CDC traffic through the receive ring parser
+  ******************************************************************************
+  * @attention
+  *
+  * Only used when _Config_HOST_SIMULATION_ is defined. DUI_For_USB_CDC.c is
+  * compiled into this file for its static parser, so it is not linked again, e.g.
+  *
+  *   FA_SIM_TRACE=2 ./fa_sim 2>traffic.txt       (then run the PC test tool)
+  *   gcc -O2 -D_Config_HOST_SIMULATION_ -I. -o cdc_parse_test MCU_Devices/Host_Simulation_CDC_Parse_Test.c
+  *       DUI_For_UART.c DUI_For_Peripheral_Control.c Utilities/CheckSum16.c
+  *       Utilities/CRC16_CCITT.c Utilities/ModBus_CRC16.c MCU_Devices/Host_Simulation_Devices.c
+  *   ./cdc_parse_test traffic.txt [frames]
+  *
+  * Without arguments Host_Simulation_CDC_Parse_Traffic.txt is replayed and
+  * CDC_Parse_Test_Traffic_Frames frames are expected, run from FA_5510_USB.
+  * It is a recording of the PC test tool with sequence frames, two frames per
+  * packet, broken lead-ins and an oversized frame.
+  * Every "fa_sim: cdc rx" line of the trace is one USB packet as it was received.
+  * The packets are given to CDC_Receive_Calling_Function() and parsed by
+  * Parsing_Receive_Data_To_Packet_Queue(), the packet queue is emptied as by the
+  * main loop. It prints the frames found of one pass and fails if they are not the
+  * expected ones, then the parse cost per byte in ns and in cycles of the host CPU
+  * (time stamp counter of x86), not of the MSP430.
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 Dynapack</center></h2>
+  ******************************************************************************
+  */
+#if defined(_Config_HOST_SIMULATION_)
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../DUI_For_USB_CDC.c"
+
+//==============================================================================
+// Private define
+//==============================================================================
+#define CDC_Parse_Test_Max_Bytes        (1024UL * 1024)
+#define CDC_Parse_Test_Max_Packets      (64UL * 1024)
+#define CDC_Parse_Test_Min_Bytes        (64UL * 1024 * 1024)    //parsed bytes of the timing
+#define CDC_Parse_Test_Line_Size        512
+#define CDC_Parse_Test_Traffic_File     "MCU_Devices/Host_Simulation_CDC_Parse_Traffic.txt"
+#define CDC_Parse_Test_Traffic_Frames   (209)   //20 frames of the recording are broken on purpose
+
+//==============================================================================
+// Global variables
+//==============================================================================
+t_uint16 G_Var_Array[Global_VarArray_Int_Size];     //main.c is not linked
+
+//==============================================================================
+// Private variables
+//==============================================================================
+static t_uint8 CDC_Parse_Test_Bytes[CDC_Parse_Test_Max_Bytes];
+static t_uint16 CDC_Parse_Test_Packet_Length[CDC_Parse_Test_Max_Packets];
+static unsigned long CDC_Parse_Test_Packets;
+static unsigned long CDC_Parse_Test_Total_Bytes;
+
+//==============================================================================
+// Private functions
+//==============================================================================
+static unsigned long long CDC_Parse_Test_Host_Cycles(void){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+// "fa_sim: cdc rx <n> bytes <hex> .." lines of FA_SIM_TRACE=2
+static int CDC_Parse_Test_Load(const char *file_name){
+    FILE *fp;
+    char line[CDC_Parse_Test_Line_Size];
+    char *p;
+    char *end;
+    unsigned long length;
+    unsigned long i;
+
+    fp = fopen(file_name, "r");
+    if(fp == NULL){
+        return 0;
+    }
+    while(fgets(line, sizeof(line), fp) != NULL){
+        p = strstr(line, "cdc rx ");
+        if(p == NULL){
+            continue;
+        }
+        length = strtoul(p + 7, &end, 10);
+        p = strstr(end, "bytes");
+        if((p == NULL) || (length == 0) || (length > USB_Receive_Max_Bytes_Per_Packet) ||
+           (CDC_Parse_Test_Packets >= CDC_Parse_Test_Max_Packets) ||
+           ((CDC_Parse_Test_Total_Bytes + length) > CDC_Parse_Test_Max_Bytes)){
+            continue;
+        }
+        p += 5;
+        for(i = 0; i < length; i++){
+            CDC_Parse_Test_Bytes[CDC_Parse_Test_Total_Bytes + i] = (t_uint8)strtoul(p, &end, 16);
+            if(end == p){
+                break;
+            }
+            p = end;
+        }
+        if(i != length){
+            continue;
+        }
+        CDC_Parse_Test_Packet_Length[CDC_Parse_Test_Packets++] = (t_uint16)length;
+        CDC_Parse_Test_Total_Bytes += length;
+    }
+    fclose(fp);
+    return 1;
+}
+// one pass of all recorded packets, return the frames found
+static unsigned long CDC_Parse_Test_Replay(void){
+    unsigned long frames;
+    unsigned long offset;
+    unsigned long i;
+
+    frames = 0;
+    offset = 0;
+    clear_Comm_Receive_Buffer();
+    for(i = 0; i < CDC_Parse_Test_Packets; i++){
+        CDC_Receive_Calling_Function(&CDC_Parse_Test_Bytes[offset], CDC_Parse_Test_Packet_Length[i]);
+        offset += CDC_Parse_Test_Packet_Length[i];
+        //the left bytes are parsed after the main loop takes the queued packets
+        do{
+            Parsing_Receive_Data_To_Packet_Queue();
+            frames += (Comm_Receive_Packet_Queue_Head - Comm_Receive_Packet_Queue_Tail) & Comm_Receive_Packet_Queue_Mask;
+            Comm_Receive_Packet_Queue_Tail = Comm_Receive_Packet_Queue_Head;
+        }while(Comm_Receive_Buffer_Tail != Comm_Receive_Buffer_Head);
+    }
+    return frames;
+}
+
+//==============================================================================
+// Public functions
+//==============================================================================
+int main(int argc, char *argv[]){
+    struct timespec start;
+    struct timespec stop;
+    unsigned long long start_cycles;
+    unsigned long long cycles;
+    const char *file_name;
+    unsigned long expected;
+    unsigned long frames;
+    unsigned long passes;
+    unsigned long i;
+    double ns;
+
+    file_name = CDC_Parse_Test_Traffic_File;
+    expected = CDC_Parse_Test_Traffic_Frames;
+    if(argc >= 2){
+        file_name = argv[1];
+        expected = (argc >= 3) ? strtoul(argv[2], NULL, 10) : 0;
+    }
+    if(!CDC_Parse_Test_Load(file_name)){
+        printf("usage : %s [<FA_SIM_TRACE=2 stderr of fa_sim> [frames]]\n", argv[0]);
+        return 1;
+    }
+    if(CDC_Parse_Test_Total_Bytes == 0){
+        printf("no cdc rx packets in %s\n", file_name);
+        return 1;
+    }
+    frames = CDC_Parse_Test_Replay();
+    printf("%lu USB packets, %lu bytes, %lu frames\n", CDC_Parse_Test_Packets, CDC_Parse_Test_Total_Bytes, frames);
+    if(expected && (frames != expected)){
+        printf("FAIL : %lu frames expected\n", expected);
+        return 1;
+    }
+
+    passes = (CDC_Parse_Test_Min_Bytes + CDC_Parse_Test_Total_Bytes - 1) / CDC_Parse_Test_Total_Bytes;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    start_cycles = CDC_Parse_Test_Host_Cycles();
+    for(i = 0; i < passes; i++){
+        if(CDC_Parse_Test_Replay() != frames){
+            printf("FAIL pass %lu : frames differ\n", i);
+            return 1;
+        }
+    }
+    cycles = CDC_Parse_Test_Host_Cycles() - start_cycles;
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    ns = ((stop.tv_sec - start.tv_sec) * 1e9 + (stop.tv_nsec - start.tv_nsec)) / ((double)passes * CDC_Parse_Test_Total_Bytes);
+    printf("%lu passes : %.2f ns per byte, %.1f host cycles per byte\n", passes, ns,
+           (double)cycles / ((double)passes * CDC_Parse_Test_Total_Bytes));
+    return 0;
+}
+
+#endif //_Config_HOST_SIMULATION_
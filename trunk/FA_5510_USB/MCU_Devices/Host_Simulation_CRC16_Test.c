@@ -0,0 +1,120 @@
+/**
+  ******************************************************************************
+  * @file    Host_Simulation_CRC16_Test.c
+  * @author  Dynapack ADT, Hsinmo
+  * @version V1.0.0
+  * @date    17-October-2026
+  * @brief   Host test of usCRC16CCITT by the CRC16 module against the software loop
+  ******************************************************************************
+  * @attention
+  *
+  * Only used when _Config_HOST_SIMULATION_ is defined, e.g.
+  *
+  *   gcc -O2 -D_Config_HOST_SIMULATION_ -I. -o crc16_test MCU_Devices/Host_Simulation_CRC16_Test.c
+  *       Utilities/CRC16_CCITT.c Utilities/ModBus_CRC16.c MCU_Devices/Host_Simulation_Devices.c
+  *   ./crc16_test
+  *
+  * usCRC16CCITT() of Utilities.h (_Config_CRC16_CCITT_BY_CRC_MODULE_) runs on the
+  * bit model of CRCDIRB_L writes in Host_Simulation_Devices.c. It is compared with
+  * the software loop for 4 start offsets x lengths 0 ~ 600 of random frames and of
+  * 0xFF frames, and with the check value 0x29B1 of "123456789". It fails on any
+  * mismatch. No timing, the cost of the module is only known on the MSP430.
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 Dynapack</center></h2>
+  ******************************************************************************
+  */
+#if defined(_Config_HOST_SIMULATION_)
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <stdio.h>
+#include <string.h>
+
+#include "../Utilities/Utilities.h"
+
+//==============================================================================
+// Private define
+//==============================================================================
+#define CRC16_Test_Max_Length           600
+#define CRC16_Test_Offsets              4
+#define CRC16_Test_Check_Value          0x29B1      //CRC-CCITT of "123456789" with seed 0xFFFF
+
+//==============================================================================
+// Private variables
+//==============================================================================
+static unsigned char CRC16_Test_Buffer[CRC16_Test_Max_Length + CRC16_Test_Offsets];
+static unsigned long CRC16_Test_Compared;
+static unsigned long CRC16_Test_Failed;
+
+//==============================================================================
+// Private functions
+//==============================================================================
+// usCRC16CCITT without _Config_CRC16_CCITT_BY_CRC_MODULE_
+static unsigned int CRC16_Test_Software( unsigned char * pucFrame, unsigned int usLen )
+{
+    unsigned int            usCRC = 0xFFFF;
+    unsigned char           ucBit;
+
+    while( usLen-- )
+    {
+        usCRC ^= ( unsigned int )( *( pucFrame++ ) ) << 8;
+        for( ucBit = 0; ucBit < 8; ucBit++ )
+        {
+            usCRC = ( usCRC & 0x8000 ) ? ( ( usCRC << 1 ) ^ 0x1021 ) : ( usCRC << 1 );
+        }
+    }
+    return usCRC & 0xFFFF;
+}
+static void CRC16_Test_Compare(unsigned int offset, unsigned int length){
+    unsigned int expected;
+    unsigned int value;
+
+    expected = CRC16_Test_Software(&CRC16_Test_Buffer[offset], length);
+    value = usCRC16CCITT(&CRC16_Test_Buffer[offset], length) & 0xFFFF;
+    CRC16_Test_Compared++;
+    if(value != expected){
+        if(CRC16_Test_Failed < 10){
+            printf("FAIL offset %u length %u : software 0x%04X, CRC16 module 0x%04X\n", offset, length, expected, value);
+        }
+        CRC16_Test_Failed++;
+    }
+}
+
+//==============================================================================
+// Public functions
+//==============================================================================
+int main(void){
+    unsigned int i;
+    unsigned int offset;
+    unsigned int length;
+    unsigned int value;
+    unsigned long seed;
+
+    memcpy(CRC16_Test_Buffer, "123456789", 9);
+    value = usCRC16CCITT(CRC16_Test_Buffer, 9) & 0xFFFF;
+    if(value != CRC16_Test_Check_Value){
+        printf("FAIL check value : 0x%04X, not 0x%04X\n", value, CRC16_Test_Check_Value);
+        CRC16_Test_Failed++;
+    }
+    seed = 1;
+    for(i = 0; i < sizeof(CRC16_Test_Buffer); i++){
+        seed = seed * 1103515245 + 12345;
+        CRC16_Test_Buffer[i] = seed >> 16;
+    }
+    for(offset = 0; offset < CRC16_Test_Offsets; offset++){
+        for(length = 0; length <= CRC16_Test_Max_Length; length++){
+            CRC16_Test_Compare(offset, length);
+        }
+    }
+    memset(CRC16_Test_Buffer, 0xFF, sizeof(CRC16_Test_Buffer));
+    for(offset = 0; offset < CRC16_Test_Offsets; offset++){
+        for(length = 0; length <= CRC16_Test_Max_Length; length++){
+            CRC16_Test_Compare(offset, length);
+        }
+    }
+    printf("%lu frames compared, %lu failed\n", CRC16_Test_Compared, CRC16_Test_Failed);
+    return (CRC16_Test_Failed == 0) ? 0 : 1;
+}
+
+#endif //_Config_HOST_SIMULATION_
@@ -0,0 +1,1452 @@
+/**
+  ******************************************************************************
+  * @file    Host_Simulation_Devices.c
+  * @author  Dynapack ADT, Hsinmo
+  * @version V1.0.0
+  * @date    17-October-2026
+  * @brief   Host (Linux) simulation of the MCU_Devices layer
+  ******************************************************************************
+  * @attention
+  *
+  * Simulated peripherals:
+  *   ADC10_A + DMA1  : scripted step waveforms per channel, 8 samples per block,
+  *                     TA0.1 triggered streaming into ping-pong blocks
+  *   USCI_A1/USCI_A0 : scripted RS485 / one-wire peers, paced by baud rate
+  *   Timer A/Timer B : ISR calling tables driven by the simulated MCLK counter
+  *   USB CDC         : pseudo terminal, SIGUSR1 is the SendBreak request of the host
+  *   Info flash D~A  : RAM image, loaded from and saved to FA_SIM_FLASH
+  *                     (segment C first, then D, B, A)
+  *
+  * Simulated time only moves in __delay_cycles(), ADC conversions, UART
+  * sending and LPM0, so replies are repeatable for the same input.
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 Dynapack</center></h2>
+  ******************************************************************************
+  */
+#if defined(_Config_HOST_SIMULATION_)
+
+//==============================================================================
+// Includes
+//==============================================================================
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+#include <sys/time.h>
+
+#include "MCU_Devices.h"
+#include "Host_Simulation.h"
+#include "InformationFlash_Memory_Define.h"
+#include "../FA_MainSystemConfigDefineVarsForFlash.h"
+#include "../SystemConfigDefineForFlash.h"
+#include "../Utilities/Utilities.h"
+
+//==============================================================================
+// Global/Extern variables
+//==============================================================================
+t_uint16 Host_Sim_WDTCTL;
+unsigned char Host_Sim_Info_Flash[Flash_segment_Size * 4];
+
+//==============================================================================
+// Private define
+//==============================================================================
+#define Sim_Cycles_Per_MS               (REQUIRE_FREQ_MCLK / 1000)
+#define Sim_TimerA_Period_Cycles        ((unsigned long long)Sim_Cycles_Per_MS * Timer_A_Polling_Base_MS)
+#define Sim_TimerB_Period_Cycles        ((unsigned long long)Sim_Cycles_Per_MS * Timer_B_Polling_Base_MS)
+
+// 8 samples * (128 S/H + 11 conversion) ADC10OSC(5MHz) clocks, in MCLK cycles
+#define Sim_ADC_Block_Samples           8
+#define Sim_ADC_Block_Cycles            ((unsigned long long)Sim_ADC_Block_Samples * (128 + 11) * (REQUIRE_FREQ_MCLK / 1000) / 5000)
+
+#define Sim_Max_ADC_Points              64
+#define Sim_Max_Peer_Reply_Length       256
+#define Sim_UART_RX_Queue_Size          1024
+#define Sim_USB_Receive_Size            64
+#define Sim_Modbus_Registers            256     //holding registers 0x1000 + address at start, input registers 0x4000 + address
+
+//==============================================================================
+// Private typedef
+//==============================================================================
+typedef struct{
+    t_uint8 channel;
+    unsigned long time_ms;
+    t_uint16 code;
+}Sim_ADC_Point;
+
+typedef enum{
+    Sim_Peer_Silent,
+    Sim_Peer_Echo,
+    Sim_Peer_Reply,
+    Sim_Peer_Modbus
+}Sim_Peer_Mode;
+
+typedef struct{
+    //device side
+    t_uint8 enabled;
+    t_uint32 baud_rate;
+    t_uint8 (*rx_fun)(__IO t_uint8 receivedByte);
+    //peer model
+    Sim_Peer_Mode mode;
+    unsigned long reply_delay_ms;
+    t_uint8 reply[Sim_Max_Peer_Reply_Length];
+    t_uint16 reply_length;
+    t_uint8 modbus_slave;
+    t_uint16 modbus_bad_crc;        //replies with CRC error before the good ones
+    t_uint8 request[Sim_Max_Peer_Reply_Length];
+    t_uint16 request_length;
+    //bytes on the wire to the device
+    unsigned long long rx_due[Sim_UART_RX_Queue_Size];
+    t_uint8 rx_byte[Sim_UART_RX_Queue_Size];
+    t_uint16 rx_head;
+    t_uint16 rx_tail;
+    //TX ring of the device, one byte is moved to the wire per character time
+    t_uint8 tx_ring[Uart_Module_1_TX_Ring_Size];
+    t_uint16 tx_head;
+    t_uint16 tx_tail;
+    t_uint8 tx_active;
+    unsigned long long tx_next;     //TXIFG of the next byte, the wire is busy until then
+    void (*tx_done_fun)(void);
+}Sim_UART_Module;
+
+//==============================================================================
+// Private variables
+//==============================================================================
+static unsigned long long Sim_Cycle_Count;
+static unsigned long long Sim_TimerA_Next;
+static unsigned long long Sim_TimerB_Next;
+static t_uint8 Sim_TimerA_Enabled;
+static t_uint8 Sim_TimerB_Enabled;
+static t_uint8 Sim_Interrupt_Enabled;
+static t_uint8 Sim_Wakeup;
+
+static t_uint8 Sim_Realtime = 1;
+static t_uint8 Sim_Trace;
+static struct timeval Sim_Wall_Start;
+static const char *Sim_Flash_File;
+
+static Sim_ADC_Point Sim_ADC_Points[Sim_Max_ADC_Points];
+static t_uint8 Sim_ADC_Point_Num;
+static t_uint16 Sim_ADC_Noise;
+static t_uint16 Sim_Modbus_Holding[Sim_Modbus_Registers];
+static t_uint32 Sim_ADC_Noise_Seed = 0x1234567;
+static t_uint8 Sim_ADC_Channel;
+static t_uint8 Sim_ADC_Sequence_Mode;
+static t_uint16 ADC_Result[Sim_ADC_Block_Samples];
+static t_uint16 Sim_ADC_Oversample_Blocks = 1;
+static ADC_Oversample_Reducer Sim_ADC_Oversample_Reducer = ADC_Reducer_Mean;
+static t_uint16 Sim_ADC_Oversample_Result_x4;
+static t_uint8 Sim_ADC_Continuous;
+static t_uint8 Sim_ADC_Continuous_Running;
+static unsigned long long Sim_ADC_Continuous_Next;     //cycle of the next continuous result
+static t_uint8 Sim_ADC_Result_Ready;
+static t_uint16 Sim_ADC_Overrun_Counter;
+static t_uint32 ADC_Start_Time_Stamp;
+static t_uint32 ADC_Done_Time_Stamp;
+static t_uint32 Sim_ADC_Next_Start_Time_Stamp;
+
+static t_uint8 Sim_ADC_Stream_Mode;
+static t_uint8 Sim_ADC_Stream_Channel;
+static t_uint8 Sim_ADC_Stream_Sequence;
+static unsigned long long Sim_ADC_Stream_Block_Cycles;
+static unsigned long long Sim_ADC_Stream_Next;
+static t_uint16 ADC_Stream_Buffer[2][ADC_Stream_Block_Samples];
+static t_uint8 ADC_Stream_Ready_Flag;
+static t_uint32 ADC_Stream_Block_Counter;
+static t_uint16 ADC_Stream_Dropped_Block_Counter;
+
+static t_uint8 Sim_ADC_Watch_Mode;
+static t_uint8 Sim_ADC_Watch_Channel;
+static unsigned long long Sim_ADC_Watch_Sample_Cycles;
+static unsigned long long Sim_ADC_Watch_Next;
+static t_uint32 Sim_ADC_Watch_Sample_Counter;
+static t_uint8 ADC_Watch_Current_State;
+static t_uint16 ADC_Watch_Low_Threshold;
+static t_uint16 ADC_Watch_High_Threshold;
+static ADC_Watch_Event ADC_Watch_Events[ADC_Watch_Event_Queue_Size];
+static t_uint8 ADC_Watch_Event_Head;
+static t_uint8 ADC_Watch_Event_Tail;
+static t_uint16 ADC_Watch_Lost_Event_Counter;
+
+static Sim_UART_Module Sim_UART[2];
+
+static int Sim_CDC_Fd = -1;
+static unsigned char usb_ReceiveDataBuffer[Sim_USB_Receive_Size];
+static unsigned long long Sim_CDC_Arrival_Cycle;
+static t_uint8 Sim_CDC_Data_Event;      //bCDCDataReceived_event
+static volatile sig_atomic_t Sim_CDC_Break_Event;   //bCDCBreakReceived_event
+static volatile sig_atomic_t Sim_CDC_Break_Wakeup;  //USB interrupt of SendBreak is not served yet
+
+static t_uint16 Sim_GPIO_Out[3];
+
+//==============================================================================
+// Private function prototypes
+//==============================================================================
+static void empty_fun(void){}
+static t_uint8 empty_uart_fun(__IO t_uint8 receivedByte){return Uart_Receive_Keep_LPM;}
+static void empty_uart_tx_done_fun(void){}
+static void empty_usb_fun(t_uint8* receivedBytesBuffer, t_uint16 receivingSize){}
+
+static void (*Interrupt_TimerA_ptr_fuc[Max_TimerA_INTERRUPT_Function_Calling])(void);
+static void (*Interrupt_TimerB_ptr_fuc[Max_TimerB_INTERRUPT_Function_Calling])(void);
+static t_uint16 Setting_Interrupt_Calling_TimingDelay_TimerB[Max_TimerB_INTERRUPT_Function_Calling];
+static t_uint16 Interrupt_Calling_TimingDelay_counter_TimerB[Max_TimerB_INTERRUPT_Function_Calling];
+static void (*Interrupt_ADC_Conversion_Done_ptr_fuc)(void) = empty_fun;
+static void (*USB_CDC_ReceiveData_ptr_fuc)(t_uint8* receivedBytesBuffer, t_uint16 receivingSize) = empty_usb_fun;
+static void Sim_DMA1_Continuous_ISR(void);
+
+//==============================================================================
+// Private functions
+//==============================================================================
+static void Sim_Load_Default_Flash(void){
+    unsigned char *ptr;
+    float f;
+    t_uint16 w;
+
+    memset(Host_Sim_Info_Flash, 0xff, Flash_segment_Size * 4);
+    ptr = (unsigned char *)Config_Segment;
+    ptr[FA_VERSION_offset] = _FA_VERSION_;
+    ptr[FA_MINOR_VERSION_offset] = _FA_MINOR_VERSION_;
+    ptr[FA_EEPROM_VERSION_offset] = _FA_EEPROM_VERSION_;
+    ptr[FA_RESERVED_VERSION_offset] = _FA_RESERVED_VERSION_;
+    w = _FA_Serial_Num_;            memcpy(ptr + FA_Serial_Num_offset, &w, 2);
+    w = _FA_Serial_Num_Extend_;     memcpy(ptr + FA_Serial_Num_Extend_offset, &w, 2);
+    w = _FA_Manufacture_Date_;      memcpy(ptr + FA_Manufacture_Date_offset, &w, 2);
+    f = _FA_24V_mV_To_ADC_Factor_;  memcpy(ptr + FA_24V_mV_To_ADC_Factor_offset, &f, 4);
+    f = _FA_36V_mV_To_ADC_Factor_;  memcpy(ptr + FA_36V_mV_To_ADC_Factor_offset, &f, 4);
+    f = _FA_48V_mV_To_ADC_Factor_;  memcpy(ptr + FA_48V_mV_To_ADC_Factor_offset, &f, 4);
+    ptr[FA_24V_CAL_OFFSET_ADC_offset] = _FA_24V_CAL_OFFSET_ADC_;
+    ptr[FA_36V_CAL_OFFSET_ADC_offset] = _FA_36V_CAL_OFFSET_ADC_;
+    ptr[FA_48V_CAL_OFFSET_ADC_offset] = _FA_48V_CAL_OFFSET_ADC_;
+    ptr[FA_Pack_DSG_CAL_OFFSET_ADC_offset] = _FA_Pack_DSG_CAL_OFFSET_ADC_;
+    ptr[FA_Pack_CHG_CAL_OFFSET_ADC_offset] = _FA_Pack_CHG_CAL_OFFSET_ADC_;
+    ptr[Reserved_1_Byte_offset] = _Reserved_1_Byte_;
+    f = _FA_Pack_DSG_mV_To_ADC_Factor_;  memcpy(ptr + FA_Pack_DSG_mV_To_ADC_Factor_offset, &f, 4);
+    ptr[FA_HW_Version_offset] = _FA_HW_Version_;
+    ptr[FA_HW_MINOR_Version_offset] = _FA_HW_MINOR_Version_;
+    w = _FA_HW_FUNCTION1_BIT_;      memcpy(ptr + FA_HW_FUNCTION1_BIT_offset, &w, 2);
+    w = _FA_HW_FUNCTION2_BIT_;      memcpy(ptr + FA_HW_FUNCTION2_BIT_offset, &w, 2);
+    w = _FA_HW_FUNCTION3_BIT_;      memcpy(ptr + FA_HW_FUNCTION3_BIT_offset, &w, 2);
+    f = _FA_Pack_CHG_mV_To_ADC_Factor_;  memcpy(ptr + FA_Pack_CHG_mV_To_ADC_Factor_offset, &f, 4);
+    ptr[Normal_Auto_Charger_Check_Delay_Cycle_offset] = _Normal_Auto_Charger_Check_Delay_Cycle_;
+    ptr[Faster_Auto_Charger_Check_Delay_Cycle_offset] = _Faster_Auto_Charger_Check_Delay_Cycle_;
+    ptr[FA_CHG_Current_CAL_OFFSET_ADC_offset] = _FA_CHG_Current_CAL_OFFSET_ADC_;
+    ptr[FA_DSG_Current_CAL_OFFSET_ADC_offset] = _FA_DSG_Current_CAL_OFFSET_ADC_;
+    f = _FA_CHG_Current_mA_To_ADC_Factor_;  memcpy(ptr + FA_CHG_Current_mA_To_ADC_Factor_offset, &f, 4);
+    f = _FA_DSG_Current_mA_To_ADC_Factor_;  memcpy(ptr + FA_DSG_Current_mA_To_ADC_Factor_offset, &f, 4);
+}
+
+static void Sim_Load_Flash(void){
+    FILE *fp;
+
+    Sim_Load_Default_Flash();
+    Sim_Flash_File = getenv("FA_SIM_FLASH");
+    if(Sim_Flash_File == NULL){
+        return;
+    }
+    fp = fopen(Sim_Flash_File, "rb");
+    if(fp != NULL){
+        if(fread((unsigned char *)Config_Segment, 1, Flash_segment_Size, fp) != Flash_segment_Size){
+            Sim_Load_Default_Flash();
+        }else{
+            //segment D, B, A are optional, older images only have segment C
+            if(fread((unsigned char *)Flash_segment_D, 1, Flash_segment_Size, fp) == Flash_segment_Size){
+                if(fread((unsigned char *)Flash_segment_B, 1, Flash_segment_Size * 2, fp) != Flash_segment_Size * 2){
+                    memset((unsigned char *)Flash_segment_B, 0xff, Flash_segment_Size * 2);
+                }
+            }else{
+                memset((unsigned char *)Flash_segment_D, 0xff, Flash_segment_Size);
+            }
+        }
+        fclose(fp);
+    }
+}
+
+static void Sim_Save_Flash(void){
+    FILE *fp;
+    if(Sim_Flash_File == NULL){
+        return;
+    }
+    fp = fopen(Sim_Flash_File, "wb");
+    if(fp != NULL){
+        fwrite((unsigned char *)Config_Segment, 1, Flash_segment_Size, fp);
+        fwrite((unsigned char *)Flash_segment_D, 1, Flash_segment_Size, fp);
+        fwrite((unsigned char *)Flash_segment_B, 1, Flash_segment_Size * 2, fp);
+        fclose(fp);
+    }
+}
+
+static void Sim_Load_Script(void){
+    const char *name;
+    FILE *fp;
+    char line[1024];
+    char *tok;
+    unsigned long ch, t_ms, code, module;
+    Sim_UART_Module *peer;
+
+    for(ch = 0; ch < Sim_Modbus_Registers; ch++){
+        Sim_Modbus_Holding[ch] = 0x1000 + ch;
+    }
+    name = getenv("FA_SIM_SCRIPT");
+    if(name == NULL){
+        return;
+    }
+    fp = fopen(name, "r");
+    if(fp == NULL){
+        fprintf(stderr, "fa_sim: can not open script %s\n", name);
+        return;
+    }
+    while(fgets(line, sizeof(line), fp) != NULL){
+        tok = strtok(line, " \t\r\n");
+        if((tok == NULL) || (tok[0] == '#')){
+            continue;
+        }
+        if(strcmp(tok, "adc") == 0){
+            if(Sim_ADC_Point_Num >= Sim_Max_ADC_Points){
+                continue;
+            }
+            ch = strtoul(strtok(NULL, " \t\r\n"), NULL, 0);
+            t_ms = strtoul(strtok(NULL, " \t\r\n"), NULL, 0);
+            code = strtoul(strtok(NULL, " \t\r\n"), NULL, 0);
+            Sim_ADC_Points[Sim_ADC_Point_Num].channel = ch & 0x07;
+            Sim_ADC_Points[Sim_ADC_Point_Num].time_ms = t_ms;
+            Sim_ADC_Points[Sim_ADC_Point_Num].code = code & 0x3ff;
+            Sim_ADC_Point_Num++;
+        }else if(strcmp(tok, "noise") == 0){
+            Sim_ADC_Noise = strtoul(strtok(NULL, " \t\r\n"), NULL, 0);
+        }else if(strcmp(tok, "uart") == 0){
+            module = strtoul(strtok(NULL, " \t\r\n"), NULL, 0);
+            if((module < 1) || (module > 2)){
+                continue;
+            }
+            peer = &Sim_UART[module - 1];
+            tok = strtok(NULL, " \t\r\n");
+            if((tok != NULL) && (strcmp(tok, "echo") == 0)){
+                peer->mode = Sim_Peer_Echo;
+            }else if((tok != NULL) && (strcmp(tok, "reply") == 0)){
+                peer->mode = Sim_Peer_Reply;
+                peer->reply_delay_ms = strtoul(strtok(NULL, " \t\r\n"), NULL, 0);
+                peer->reply_length = 0;
+                while(((tok = strtok(NULL, " \t\r\n")) != NULL) && (peer->reply_length < Sim_Max_Peer_Reply_Length)){
+                    peer->reply[peer->reply_length++] = (t_uint8)strtoul(tok, NULL, 16);
+                }
+            }else if((tok != NULL) && (strcmp(tok, "modbus") == 0)){
+                peer->mode = Sim_Peer_Modbus;
+                peer->modbus_slave = strtoul(strtok(NULL, " \t\r\n"), NULL, 0);
+                peer->reply_delay_ms = strtoul(strtok(NULL, " \t\r\n"), NULL, 0);
+                tok = strtok(NULL, " \t\r\n");
+                peer->modbus_bad_crc = (tok != NULL) ? strtoul(tok, NULL, 0) : 0;
+            }
+        }
+    }
+    fclose(fp);
+}
+
+//USB interrupt of SendBreak request, select() of LPM0 is interrupted without SA_RESTART
+static void Sim_CDC_Send_Break_Handler(int sig){
+    Sim_CDC_Break_Event = 1;
+    Sim_CDC_Break_Wakeup = 1;
+}
+
+static void Sim_Open_CDC_Port(void){
+    int slave_fd;
+    struct termios tio;
+    struct sigaction sa;
+
+    Sim_CDC_Fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if((Sim_CDC_Fd < 0) || (grantpt(Sim_CDC_Fd) != 0) || (unlockpt(Sim_CDC_Fd) != 0)){
+        perror("fa_sim: posix_openpt");
+        exit(1);
+    }
+    //keep one slave handle open, so reading master does not fail before the host opens it
+    slave_fd = open(ptsname(Sim_CDC_Fd), O_RDWR | O_NOCTTY);
+    if(slave_fd >= 0){
+        tcgetattr(slave_fd, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(slave_fd, TCSANOW, &tio);
+    }
+    fcntl(Sim_CDC_Fd, F_SETFL, fcntl(Sim_CDC_Fd, F_GETFL) | O_NONBLOCK);
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = Sim_CDC_Send_Break_Handler;
+    sigaction(SIGUSR1, &sa, NULL);
+    fprintf(stderr, "fa_sim: virtual CDC port %s\n", ptsname(Sim_CDC_Fd));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ADC waveform
+////////////////////////////////////////////////////////////////////////////////
+static t_uint16 Sim_ADC_Sample(t_uint8 channel){
+    t_uint8 i;
+    unsigned long now_ms;
+    unsigned long best_ms;
+    t_int32 code;
+    t_int32 noise;
+
+    now_ms = (unsigned long)(Sim_Cycle_Count / Sim_Cycles_Per_MS);
+    code = 512;
+    best_ms = 0;
+    for(i = 0; i < Sim_ADC_Point_Num; i++){
+        if((Sim_ADC_Points[i].channel == channel) && (Sim_ADC_Points[i].time_ms <= now_ms) && (Sim_ADC_Points[i].time_ms >= best_ms)){
+            best_ms = Sim_ADC_Points[i].time_ms;
+            code = Sim_ADC_Points[i].code;
+        }
+    }
+    if(Sim_ADC_Noise){
+        Sim_ADC_Noise_Seed = Sim_ADC_Noise_Seed * 1103515245UL + 12345UL;
+        noise = (t_int32)((Sim_ADC_Noise_Seed >> 16) % (2 * Sim_ADC_Noise + 1)) - Sim_ADC_Noise;
+        code += noise;
+    }
+    if(code < 0){
+        code = 0;
+    }
+    if(code > 0x3ff){
+        code = 0x3ff;
+    }
+    return (t_uint16)code;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// UART peers
+////////////////////////////////////////////////////////////////////////////////
+static unsigned long long Sim_UART_Byte_Cycles(Sim_UART_Module *m){
+    //start + 8 data + stop
+    return ((unsigned long long)REQUIRE_FREQ_MCLK * 10) / (m->baud_rate ? m->baud_rate : 9600);
+}
+
+static void Sim_UART_Queue_To_Device(Sim_UART_Module *m, unsigned long long due, t_uint8 value){
+    t_uint16 next;
+    next = (m->rx_head + 1) % Sim_UART_RX_Queue_Size;
+    if(next == m->rx_tail){
+        return;     //peer overrun, byte lost on the wire
+    }
+    m->rx_due[m->rx_head] = due;
+    m->rx_byte[m->rx_head] = value;
+    m->rx_head = next;
+}
+
+/**
+  * @brief  Modbus RTU slave of function 03, 04, 06 and 16, no reply for other slaves or bad CRC
+  */
+static void Sim_Modbus_Slave_Reply(Sim_UART_Module *m){
+    t_uint8 *req = m->request;
+    t_uint16 address;
+    t_uint16 quantity;
+    t_uint16 crc;
+    t_uint16 i;
+
+    m->reply_length = 0;
+    if((m->request_length < 8) || (req[0] != m->modbus_slave) || (usMBCRC16(req, m->request_length) != 0)){
+        return;
+    }
+    address = (req[2] << 8) | req[3];
+    quantity = (req[4] << 8) | req[5];
+    m->reply[0] = req[0];
+    m->reply[1] = req[1];
+    if((req[1] == 0x03) || (req[1] == 0x04)){
+        if((address + quantity) > Sim_Modbus_Registers){
+            m->reply[1] |= 0x80;
+            m->reply[2] = 0x02;
+            m->reply_length = 3;
+        }else{
+            m->reply[2] = quantity * 2;
+            m->reply_length = 3;
+            for(i = address; i < (address + quantity); i++){
+                crc = (req[1] == 0x03) ? Sim_Modbus_Holding[i] : (0x4000 + i);
+                m->reply[m->reply_length++] = crc >> 8;
+                m->reply[m->reply_length++] = crc & 0xff;
+            }
+        }
+    }else if((req[1] == 0x06) || (req[1] == 0x10)){
+        if((req[1] == 0x06) ? (address >= Sim_Modbus_Registers) : ((address + quantity) > Sim_Modbus_Registers)){
+            m->reply[1] |= 0x80;
+            m->reply[2] = 0x02;
+            m->reply_length = 3;
+        }else{
+            if(req[1] == 0x06){
+                Sim_Modbus_Holding[address] = quantity;
+            }else{
+                for(i = 0; i < quantity; i++){
+                    Sim_Modbus_Holding[address + i] = (req[7 + (i * 2)] << 8) | req[8 + (i * 2)];
+                }
+            }
+            memcpy(m->reply, req, 6);
+            m->reply_length = 6;
+        }
+    }else{
+        m->reply[1] |= 0x80;
+        m->reply[2] = 0x01;
+        m->reply_length = 3;
+    }
+    crc = usMBCRC16(m->reply, m->reply_length);
+    if(m->modbus_bad_crc){
+        m->modbus_bad_crc--;
+        crc ^= 0x0001;
+    }
+    m->reply[m->reply_length++] = crc & 0xff;
+    m->reply[m->reply_length++] = crc >> 8;
+}
+
+static t_uint8 Sim_UART_Send_Bytes(Sim_UART_Module *m, unsigned char *sendByte, unsigned int length){
+    unsigned int i;
+
+    if(length > (Uart_Module_1_TX_Ring_Size - (t_uint16)(m->tx_head - m->tx_tail))){
+        return Func_Failure;
+    }
+    for(i = 0; i < length; i++){
+        m->tx_ring[m->tx_head % Uart_Module_1_TX_Ring_Size] = sendByte[i];
+        m->tx_head++;
+    }
+    if((m->tx_active == 0) && (length > 0)){
+        //first byte is written to TXBUF at once if the wire is idle
+        m->tx_active = 1;
+        if(m->tx_next < Sim_Cycle_Count){
+            m->tx_next = Sim_Cycle_Count;
+        }
+    }
+    return Func_Success;
+}
+
+/**
+  * @brief  USCI_Ax_ISR TXIFG : next byte to the wire, done function when the ring is empty
+  */
+static void Sim_UART_TX_ISR(Sim_UART_Module *m){
+    unsigned long long byte_cycles;
+    unsigned long long due;
+    t_uint16 i;
+    t_uint8 value;
+
+    byte_cycles = Sim_UART_Byte_Cycles(m);
+    value = m->tx_ring[m->tx_tail % Uart_Module_1_TX_Ring_Size];
+    m->tx_tail++;
+    m->tx_next = Sim_Cycle_Count + byte_cycles;
+    if(m->mode == Sim_Peer_Echo){
+        Sim_UART_Queue_To_Device(m, m->tx_next, value);
+    }
+    if(m->request_length < Sim_Max_Peer_Reply_Length){
+        m->request[m->request_length++] = value;
+    }
+    if(m->tx_tail != m->tx_head){
+        return;
+    }
+    m->tx_active = 0;
+    if(m->mode == Sim_Peer_Modbus){
+        Sim_Modbus_Slave_Reply(m);
+    }
+    m->request_length = 0;
+    if((m->mode == Sim_Peer_Reply) || (m->mode == Sim_Peer_Modbus)){
+        due = m->tx_next + (unsigned long long)m->reply_delay_ms * Sim_Cycles_Per_MS;
+        for(i = 0; i < m->reply_length; i++){
+            due += byte_cycles;
+            Sim_UART_Queue_To_Device(m, due, m->reply[i]);
+        }
+    }
+    if(m->enabled){
+        m->tx_done_fun();
+    }
+    Sim_Wakeup = 1;     //__bic_SR_register_on_exit(LPM0_bits)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ISR
+////////////////////////////////////////////////////////////////////////////////
+static void Sim_TIMER1_A0_ISR(void){
+    t_uint8 i;
+    for(i = 0; i < Max_TimerA_INTERRUPT_Function_Calling; i++){
+        (*Interrupt_TimerA_ptr_fuc[i])();
+    }
+    Sim_Wakeup = 1;     //__bic_SR_register_on_exit(LPM3_bits)
+}
+
+static void Sim_TIMERB0_ISR(void){
+    t_uint8 i;
+    t_uint8 empty_Count;
+
+    empty_Count = 0;
+    for(i = 0; i < Max_TimerB_INTERRUPT_Function_Calling; i++){
+        if(Interrupt_TimerB_ptr_fuc[i] == empty_fun){
+            empty_Count++;
+        }else{
+            if(Interrupt_Calling_TimingDelay_counter_TimerB[i] >= Setting_Interrupt_Calling_TimingDelay_TimerB[i]){
+                (*Interrupt_TimerB_ptr_fuc[i])();
+                Interrupt_TimerB_ptr_fuc[i] = empty_fun;
+                Interrupt_Calling_TimingDelay_counter_TimerB[i] = 0;
+                Sim_Wakeup = 1; //__bic_SR_register_on_exit(LPM0_bits)
+            }else{
+                Interrupt_Calling_TimingDelay_counter_TimerB[i]++;
+            }
+        }
+    }
+    if(empty_Count >= Max_TimerB_INTERRUPT_Function_Calling){
+        _Device_Disable_Timer_B();
+    }
+}
+
+static void Sim_DMA1_Stream_ISR(void){
+    t_uint8 done_index;
+    t_uint8 channel;
+    t_uint16 i;
+    t_uint32 sample_number;
+
+    done_index = (t_uint8)ADC_Stream_Block_Counter & 0x01;
+    sample_number = ADC_Stream_Block_Counter * ADC_Stream_Block_Samples;
+    for(i = 0; i < ADC_Stream_Block_Samples; i++){
+        channel = Sim_ADC_Stream_Channel;
+        if(Sim_ADC_Stream_Sequence){
+            channel -= (sample_number + i) % (Sim_ADC_Stream_Channel + 1);
+        }
+        ADC_Stream_Buffer[done_index][i] = Sim_ADC_Sample(channel);
+    }
+    if(ADC_Stream_Ready_Flag & (1 << (done_index ^ 0x01))){
+        ADC_Stream_Ready_Flag &= ~(1 << (done_index ^ 0x01));
+        ADC_Stream_Dropped_Block_Counter++;
+    }
+    ADC_Stream_Ready_Flag |= (1 << done_index);
+    ADC_Stream_Block_Counter++;
+    Sim_Wakeup = 1;     //__bic_SR_register_on_exit(LPM0_bits)
+}
+
+//one conversion of watch mode, same as the window comparator and ADC_Watch_Crossing() of ADC_Ctrl.c
+static void Sim_ADC10_Watch_Sample(void){
+    t_uint16 adc;
+    t_uint8 state;
+    ADC_Watch_Event *event;
+
+    adc = Sim_ADC_Sample(Sim_ADC_Watch_Channel);
+    Sim_ADC_Watch_Sample_Counter++;
+    if(adc > ADC_Watch_High_Threshold){
+        state = ADC_Watch_Above;
+    }else if(adc < ADC_Watch_Low_Threshold){
+        state = ADC_Watch_Below;
+    }else{
+        state = ADC_Watch_Inside;
+    }
+    if(state == ADC_Watch_Current_State){
+        return;
+    }
+    ADC_Watch_Current_State = state;
+    if(((ADC_Watch_Event_Head + 1) % ADC_Watch_Event_Queue_Size) == ADC_Watch_Event_Tail){
+        ADC_Watch_Lost_Event_Counter++;
+        return;
+    }
+    event = &ADC_Watch_Events[ADC_Watch_Event_Head];
+    event->Sample_Number = Sim_ADC_Watch_Sample_Counter - 1;
+    event->Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+    event->ADC = adc;
+    event->State = state;
+    ADC_Watch_Event_Head = (ADC_Watch_Event_Head + 1) % ADC_Watch_Event_Queue_Size;
+    Sim_Wakeup = 1;     //__bic_SR_register_on_exit(LPM0_bits)
+}
+
+/**
+  * @brief  run every interrupt which is due until the target cycle
+  */
+static void Sim_Run_Until(unsigned long long target){
+    unsigned long long next;
+    t_uint8 source;
+    t_uint8 i;
+    Sim_UART_Module *m;
+
+    while(1){
+        next = target;
+        source = 0;
+        if(Sim_Interrupt_Enabled){
+            if(Sim_TimerA_Enabled && (Sim_TimerA_Next <= next)){
+                next = Sim_TimerA_Next;
+                source = 1;
+            }
+            if(Sim_TimerB_Enabled && (Sim_TimerB_Next <= next)){
+                next = Sim_TimerB_Next;
+                source = 2;
+            }
+            for(i = 0; i < 2; i++){
+                m = &Sim_UART[i];
+                if((m->rx_tail != m->rx_head) && (m->rx_due[m->rx_tail] <= next)){
+                    next = m->rx_due[m->rx_tail];
+                    source = 3 + i;
+                }
+                if(m->tx_active && (m->tx_next <= next)){
+                    next = m->tx_next;
+                    source = 8 + i;
+                }
+            }
+            if(Sim_ADC_Stream_Mode && (Sim_ADC_Stream_Next <= next)){
+                next = Sim_ADC_Stream_Next;
+                source = 5;
+            }
+            if(Sim_ADC_Watch_Mode && (Sim_ADC_Watch_Next <= next)){
+                next = Sim_ADC_Watch_Next;
+                source = 6;
+            }
+            if(Sim_ADC_Continuous_Running && (Sim_ADC_Continuous_Next <= next)){
+                next = Sim_ADC_Continuous_Next;
+                source = 7;
+            }
+        }
+        if(source == 0){
+            Sim_Cycle_Count = target;
+            return;
+        }
+        if(next > Sim_Cycle_Count){
+            Sim_Cycle_Count = next;
+        }
+        switch(source){
+            case 1:
+                Sim_TimerA_Next += Sim_TimerA_Period_Cycles;
+                Sim_TIMER1_A0_ISR();
+                break;
+            case 2:
+                Sim_TimerB_Next += Sim_TimerB_Period_Cycles;
+                Sim_TIMERB0_ISR();
+                break;
+            case 5:
+                Sim_ADC_Stream_Next += Sim_ADC_Stream_Block_Cycles;
+                Sim_DMA1_Stream_ISR();
+                break;
+            case 6:
+                Sim_ADC_Watch_Next += Sim_ADC_Watch_Sample_Cycles;
+                Sim_ADC10_Watch_Sample();
+                break;
+            case 7:
+                Sim_ADC_Continuous_Next += (unsigned long long)Sim_ADC_Block_Cycles * Sim_ADC_Oversample_Blocks;
+                Sim_DMA1_Continuous_ISR();
+                break;
+            case 8:
+            case 9:
+                Sim_UART_TX_ISR(&Sim_UART[source - 8]);
+                break;
+            default:
+                m = &Sim_UART[source - 3];
+                if(m->enabled && (m->rx_fun(m->rx_byte[m->rx_tail]) == Uart_Receive_Exit_LPM)){
+                    Sim_Wakeup = 1;     //__bic_SR_register_on_exit(LPM0_bits)
+                }
+                m->rx_tail = (m->rx_tail + 1) % Sim_UART_RX_Queue_Size;
+                break;
+        }
+    }
+}
+
+static unsigned long long Sim_Wall_Cycles(void){
+    struct timeval now;
+    unsigned long long us;
+    gettimeofday(&now, NULL);
+    us = (unsigned long long)(now.tv_sec - Sim_Wall_Start.tv_sec) * 1000000ULL + now.tv_usec - Sim_Wall_Start.tv_usec;
+    return us * (REQUIRE_FREQ_MCLK / 1000000);
+}
+
+//==============================================================================
+// Public functions
+//==============================================================================
+unsigned long long Host_Sim_Get_Cycle_Count(void){
+    return Sim_Cycle_Count;
+}
+
+void Host_Sim_Advance_Cycles(unsigned long cycles){
+    Sim_Run_Until(Sim_Cycle_Count + cycles);
+}
+
+void Host_Sim_Enable_Interrupt(void){
+    if(Sim_Interrupt_Enabled == 0){
+        gettimeofday(&Sim_Wall_Start, NULL);
+    }
+    Sim_Interrupt_Enabled = 1;
+}
+
+void Host_Sim_Set_GPIO(t_uint8 port, t_uint16 pins, t_uint8 level){
+    if(port > 2){
+        return;
+    }
+    if(level == 2){
+        Sim_GPIO_Out[port] ^= pins;
+    }else if(level){
+        Sim_GPIO_Out[port] |= pins;
+    }else{
+        Sim_GPIO_Out[port] &= ~pins;
+    }
+}
+
+/**
+  * @brief  USB interrupt : data from host raises bCDCDataReceived_event and wakes up CPU
+  */
+static t_uint8 Sim_CDC_Check_Data_Event(struct timeval *timeout){
+    fd_set fds;
+
+    if(Sim_CDC_Data_Event){
+        return 1;
+    }
+    FD_ZERO(&fds);
+    FD_SET(Sim_CDC_Fd, &fds);
+    if(select(Sim_CDC_Fd + 1, &fds, NULL, NULL, timeout) > 0){
+        Sim_CDC_Data_Event = 1;
+        Sim_CDC_Arrival_Cycle = Sim_Cycle_Count;
+        Sim_Wakeup = 1;
+        return 1;
+    }
+    if(Sim_CDC_Break_Wakeup){
+        //USBCDC_handleSendBreak() returns TRUE, no data is received
+        Sim_CDC_Break_Wakeup = 0;
+        Sim_Wakeup = 1;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+  * @brief  LPM0 : sleep until an interrupt clears the LPM bits on exit
+  */
+void Host_Sim_Enter_Low_Power_Mode(t_uint16 bits){
+    unsigned long long next;
+    unsigned long long wall;
+    struct timeval tv;
+    t_uint8 i;
+
+    Sim_Wakeup = 0;
+    while(Sim_Wakeup == 0){
+        next = Sim_TimerA_Enabled ? Sim_TimerA_Next : Sim_Cycle_Count + Sim_TimerA_Period_Cycles;
+        if(Sim_TimerB_Enabled && (Sim_TimerB_Next < next)){
+            next = Sim_TimerB_Next;
+        }
+        for(i = 0; i < 2; i++){
+            if((Sim_UART[i].rx_tail != Sim_UART[i].rx_head) && (Sim_UART[i].rx_due[Sim_UART[i].rx_tail] < next)){
+                next = Sim_UART[i].rx_due[Sim_UART[i].rx_tail];
+            }
+            if(Sim_UART[i].tx_active && (Sim_UART[i].tx_next < next)){
+                next = Sim_UART[i].tx_next;
+            }
+        }
+        if(Sim_ADC_Stream_Mode && (Sim_ADC_Stream_Next <= next)){
+            next = Sim_ADC_Stream_Next;
+        }
+        if(Sim_ADC_Watch_Mode && (Sim_ADC_Watch_Next <= next)){
+            next = Sim_ADC_Watch_Next;
+        }
+        if(Sim_ADC_Continuous_Running && (Sim_ADC_Continuous_Next <= next)){
+            next = Sim_ADC_Continuous_Next;
+        }
+        tv.tv_sec = 0;
+        tv.tv_usec = 0;
+        if(Sim_Realtime){
+            //keep simulated time behind the wall clock
+            wall = Sim_Wall_Cycles();
+            if(next > wall){
+                tv.tv_sec = (next - wall) / REQUIRE_FREQ_MCLK;
+                tv.tv_usec = ((next - wall) % REQUIRE_FREQ_MCLK) / (REQUIRE_FREQ_MCLK / 1000000);
+            }
+            if(Sim_CDC_Check_Data_Event(&tv)){
+                wall = Sim_Wall_Cycles();
+                Sim_Run_Until((wall < next) ? wall : next);
+                Sim_CDC_Arrival_Cycle = Sim_Cycle_Count;
+                return;
+            }
+        }else{
+            //nothing is running on the wire, the fixture waits for the host
+            if((Sim_TimerB_Enabled == 0) && (Sim_ADC_Stream_Mode == 0) && (Sim_ADC_Watch_Mode == 0) && (Sim_ADC_Continuous_Running == 0) &&
+               (Sim_UART[0].rx_tail == Sim_UART[0].rx_head) && (Sim_UART[1].rx_tail == Sim_UART[1].rx_head) &&
+               (Sim_UART[0].tx_active == 0) && (Sim_UART[1].tx_active == 0)){
+                Sim_CDC_Check_Data_Event(NULL);
+                if(Sim_TimerA_Enabled){
+                    Sim_TimerA_Next = Sim_Cycle_Count + Sim_TimerA_Period_Cycles;
+                }
+                return;
+            }
+            if(Sim_CDC_Check_Data_Event(&tv)){
+                return;
+            }
+        }
+        Sim_Run_Until(next);
+    }
+}
+
+/*
+ * ======== Power_Management_Module / Clock / Ports ========
+ */
+void _Device_Set_Power_Management_Module(void){}
+void _Device_Clock_Source_Set_Out_To_Pin(void){}
+void _Device_Init_Clock_Module(void){
+    const char *env;
+
+    Sim_Load_Flash();
+    Sim_Load_Script();
+    env = getenv("FA_SIM_REALTIME");
+    if((env != NULL) && (env[0] == '0')){
+        Sim_Realtime = 0;
+    }
+    env = getenv("FA_SIM_TRACE");
+    if((env != NULL) && (env[0] >= '1') && (env[0] <= '2')){
+        Sim_Trace = env[0] - '0';
+    }
+}
+t_uint32 _Device_Get_Clock_Source_SMCLK(){ return REQUIRE_FREQ_SMCLK; }
+t_uint32 _Device_Get_Clock_Source_MCLK(){ return REQUIRE_FREQ_MCLK; }
+t_uint32 _Device_Get_Clock_Source_ACLK(){ return REQUIRE_FREQ_ACLK; }
+void _Device_Init_Ports_To_Output_Low (void){
+    memset(Sim_GPIO_Out, 0, sizeof(Sim_GPIO_Out));
+}
+void Port2_Pin5_6_Init(){}
+
+/*
+ * ======== Timer A Config ========
+ */
+void _Device_Init_Timer_A (void){
+    t_uint8 i;
+    for(i = 0; i < Max_TimerA_INTERRUPT_Function_Calling; i++){
+        Interrupt_TimerA_ptr_fuc[i] = empty_fun;
+    }
+}
+void _Device_Enable_Timer_A(void){
+    Sim_TimerA_Enabled = 1;
+    Sim_TimerA_Next = Sim_Cycle_Count + Sim_TimerA_Period_Cycles;
+}
+void _Device_Disable_Timer_A(void){
+    Sim_TimerA_Enabled = 0;
+}
+void _Device_Set_TimerA_Interrupt_Timer_Calling_Function(t_uint8 fun_index, void (*calling_fun)()){
+    if(fun_index >= Max_TimerA_INTERRUPT_Function_Calling){
+        return;
+    }
+    Interrupt_TimerA_ptr_fuc[fun_index] = calling_fun;
+}
+void _Device_Remove_TimerA_Interrupt_Timer_Calling_Function(t_uint8 fun_index){
+    if(fun_index >= Max_TimerA_INTERRUPT_Function_Calling){
+        return;
+    }
+    Interrupt_TimerA_ptr_fuc[fun_index] = empty_fun;
+}
+t_uint32 _Device_Get_TimerA_Time_Stamp(void){
+    return (t_uint32)(Sim_Cycle_Count / (Sim_Cycles_Per_MS / Timer_A_Counts_Per_MS));
+}
+
+/*
+ * ======== Timer B Config ========
+ */
+void _Device_Init_Timer_B (void){
+    t_uint8 i;
+    for(i = 0; i < Max_TimerB_INTERRUPT_Function_Calling; i++){
+        Interrupt_TimerB_ptr_fuc[i] = empty_fun;
+        Setting_Interrupt_Calling_TimingDelay_TimerB[i] = 0;
+        Interrupt_Calling_TimingDelay_counter_TimerB[i] = 0;
+    }
+}
+void _Device_Enable_Timer_B(void){
+    if(Sim_TimerB_Enabled == 0){
+        Sim_TimerB_Next = Sim_Cycle_Count + Sim_TimerB_Period_Cycles;
+    }
+    Sim_TimerB_Enabled = 1;
+}
+void _Device_Disable_Timer_B(void){
+    Sim_TimerB_Enabled = 0;
+}
+void _Device_Set_TimerB_Interrupt_Timer_Calling_Function_With_Delay_And_Exec(t_uint8 fun_index, void (*calling_fun)(), __IO t_uint16 ms_Dealy ){
+    if(fun_index >= Max_TimerB_INTERRUPT_Function_Calling){
+        return;
+    }
+    if(ms_Dealy <= 1){
+        ms_Dealy = 1;
+    }
+    Interrupt_TimerB_ptr_fuc[fun_index] = calling_fun;
+    Setting_Interrupt_Calling_TimingDelay_TimerB[fun_index] = ms_Dealy - 1;
+    Interrupt_Calling_TimingDelay_counter_TimerB[fun_index] = 0;
+    _Device_Enable_Timer_B();
+}
+void _Device_Remove_TimerB_Interrupt_Timer_Calling_Function(t_uint8 fun_index){
+    t_uint8 i;
+    if(fun_index >= Max_TimerB_INTERRUPT_Function_Calling){
+        return;
+    }
+    Interrupt_TimerB_ptr_fuc[fun_index] = empty_fun;
+    Setting_Interrupt_Calling_TimingDelay_TimerB[fun_index] = 0;
+    Interrupt_Calling_TimingDelay_counter_TimerB[fun_index] = 0;
+    for(i = 0; i < Max_TimerB_INTERRUPT_Function_Calling; i++){
+        if(Interrupt_TimerB_ptr_fuc[i] != empty_fun){
+            return;
+        }
+    }
+    _Device_Disable_Timer_B();
+}
+
+/*
+ * ======== Commun Mux_Control ========
+ */
+void  _Device_Commun_MUX_Init(void){}
+void _Device_Set_Commun_Mux_Channel(Communication_Mux_Channels channel){}
+
+/*
+ * ======== UART Module 1 / 2 Config ========
+ */
+static t_uint8 Sim_UART_Enable(Sim_UART_Module *m, t_uint32 baud_rate){
+    m->enabled = 1;
+    m->baud_rate = baud_rate;
+    m->rx_fun = empty_uart_fun;
+    m->tx_done_fun = empty_uart_tx_done_fun;
+    m->tx_tail = m->tx_head;
+    m->tx_active = 0;
+    return Func_Success;
+}
+static void Sim_UART_Disable(Sim_UART_Module *m){
+    m->enabled = 0;
+    m->rx_fun = empty_uart_fun;
+    m->tx_done_fun = empty_uart_tx_done_fun;
+    m->tx_tail = m->tx_head;
+    m->tx_active = 0;
+}
+t_uint8 _Device_Uart_Module_1_Enable(t_uint32 baud_rate){
+    return Sim_UART_Enable(&Sim_UART[0], baud_rate);
+}
+void _Device_Uart_Module_1_Disable(void){
+    Sim_UART_Disable(&Sim_UART[0]);
+}
+void _Device_Uart_Module_1_Set_Calling_Function_By_Uart_Receive_Interrupt(t_uint8 (*calling_fun)(__IO t_uint8 receivedByte)){
+    Sim_UART[0].rx_fun = calling_fun;
+}
+t_uint8 _Device_Uart_Module_1_Send_Bytes(unsigned char *sendByte, unsigned int length){
+    return Sim_UART_Send_Bytes(&Sim_UART[0], sendByte, length);
+}
+void _Device_Uart_Module_1_Set_Calling_Function_By_Uart_Transmit_Done(void (*calling_fun)(void)){
+    Sim_UART[0].tx_done_fun = calling_fun;
+}
+t_uint8 _Device_Uart_Module_1_Is_Transmitting(void){
+    return Sim_UART[0].tx_active;
+}
+t_uint16 _Device_Uart_Module_1_Get_Transmit_Free_Size(void){
+    return Uart_Module_1_TX_Ring_Size - (t_uint16)(Sim_UART[0].tx_head - Sim_UART[0].tx_tail);
+}
+t_uint8 _Device_Uart_Module_2_Enable(t_uint32 baud_rate){
+    return Sim_UART_Enable(&Sim_UART[1], baud_rate);
+}
+void _Device_Uart_Module_2_Disable(void){
+    Sim_UART_Disable(&Sim_UART[1]);
+}
+void _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Receive_Interrupt(t_uint8 (*calling_fun)(__IO t_uint8 receivedByte)){
+    Sim_UART[1].rx_fun = calling_fun;
+}
+t_uint8 _Device_Uart_Module_2_Send_Bytes(unsigned char *sendByte, unsigned int length){
+    return Sim_UART_Send_Bytes(&Sim_UART[1], sendByte, length);
+}
+void _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Transmit_Done(void (*calling_fun)(void)){
+    Sim_UART[1].tx_done_fun = calling_fun;
+}
+t_uint8 _Device_Uart_Module_2_Is_Transmitting(void){
+    return Sim_UART[1].tx_active;
+}
+t_uint16 _Device_Uart_Module_2_Get_Transmit_Free_Size(void){
+    return Uart_Module_1_TX_Ring_Size - (t_uint16)(Sim_UART[1].tx_head - Sim_UART[1].tx_tail);
+}
+
+/*
+ * ======== I2C UCB0 Master Config ========
+ */
+void _Device_Init_I2C_IO_Port_As_Input(void){}
+unsigned char _Device_get_SDA_Pin_Status(void){ return IO_INPUT_HIGH; }
+unsigned char _Device_get_SCL_Pin_Status(void){ return IO_INPUT_HIGH; }
+
+/*
+ * ======== CRC Module ========
+ */
+//bit model of CRCDIRB_L writes, CRC-CCITT MSB first
+t_uint16 _Device_CRC16_CCITT(t_uint16 seed, t_uint8 *data, t_uint16 length){
+    t_uint8 bit;
+
+    while(length--){
+        seed ^= (t_uint16)(*(data++)) << 8;
+        for(bit = 0; bit < 8; bit++){
+            seed = (seed & 0x8000) ? ((seed << 1) ^ 0x1021) : (seed << 1);
+        }
+    }
+    return seed;
+}
+
+/*
+ * ======== USB Config ========
+ */
+void _Device_Init_USB_Config (void){
+    Sim_Open_CDC_Port();
+    USB_CDC_ReceiveData_ptr_fuc = empty_usb_fun;
+}
+void _Device_Set_USB_Receive_From_PC_Calling_Function(void (*calling_fun)(t_uint8* receivedBytesBuffer, t_uint16 receivingSize)){
+    USB_CDC_ReceiveData_ptr_fuc = calling_fun;
+}
+t_uint8 _Device_USB_Send_Bytes_To_PC(unsigned char *sendByte, unsigned int length){
+    if(Sim_Trace){
+        fprintf(stderr, "fa_sim: cdc tx %u bytes cmd 0x%02X, %llu cycles after rx\n", length,
+            (length > 2) ? sendByte[2] : 0, Sim_Cycle_Count - Sim_CDC_Arrival_Cycle);
+    }
+    if(write(Sim_CDC_Fd, sendByte, length) != (ssize_t)length){
+        return Func_Failure;
+    }
+    return Func_Success;
+}
+t_uint8 _Device_Polling_For_USB_Connection_Status(){
+    return USB_Status_ENUM_ACTIVE;
+}
+//pseudo terminal takes the bytes at once
+t_uint8 _Device_Is_USB_Sending(){
+    return 0;
+}
+t_uint8 _Device_Is_USB_Break_Received(){
+    return Sim_CDC_Break_Event ? 1 : 0;
+}
+void _Device_Clear_USB_Break_Received(){
+    Sim_CDC_Break_Event = 0;
+}
+t_uint8 _Device_Is_USB_Data_Received(){
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    return Sim_CDC_Check_Data_Event(&tv);
+}
+t_uint16 _Device_USB_Receive_From_PC(){
+    ssize_t count;
+    ssize_t i;
+
+    if(!_Device_Is_USB_Data_Received()){
+        return 0;
+    }
+    Sim_CDC_Data_Event = 0;
+    count = read(Sim_CDC_Fd, usb_ReceiveDataBuffer, Sim_USB_Receive_Size);
+    if(count <= 0){
+        return 0;
+    }
+    if(Sim_Trace >= 2){
+        //recorded traffic, replayed by Host_Simulation_CDC_Parse_Test.c
+        fprintf(stderr, "fa_sim: cdc rx %d bytes", (int)count);
+        for(i = 0; i < count; i++){
+            fprintf(stderr, " %02X", usb_ReceiveDataBuffer[i]);
+        }
+        fprintf(stderr, "\n");
+    }
+    //cdcReceiveDataInBuffer() copying time
+    Host_Sim_Advance_Cycles(count * 8);
+    USB_CDC_ReceiveData_ptr_fuc(usb_ReceiveDataBuffer, (t_uint16)count);
+    return (t_uint16)count;
+}
+
+/*
+ * ======== Charger Function_Control ========
+ */
+void _Device_Charger_Func_Init(void){}
+CHG_ID_Sense_Status _Device_Get_Chg_ID_Sense_Status(){ return USE_CHG_ID; }
+void _Device_Set_Chg_ID_Level(CHG_ID_Levels level){}
+void _Device_Chger_Mux_Channel_Enable(Device_Status ds){}
+void _Device_Set_Chger_Mux_Channel(Chger_Mux_Channels channel){}
+void _Device_Set_Chger_Input_Voltage_Channel(Chger_InputVol_Ch channel){}
+
+/*
+ * ======== ADC Function_Control ========
+ */
+void _Device_Measured_Sequence_ADC_Init(void){
+    Interrupt_ADC_Conversion_Done_ptr_fuc = empty_fun;
+    Sim_ADC_Sequence_Mode = 1;
+}
+void _Device_Measured_Sequence_ADC_Conversion_Start(void){
+    t_uint8 i;
+    Sim_ADC_Continuous = 0;
+    Sim_ADC_Continuous_Running = 0;
+    //sequence A7 ~ A0, same order as DMA of ADC_Ctrl.c
+    ADC_Start_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+    Host_Sim_Advance_Cycles((unsigned long)Sim_ADC_Block_Cycles);
+    ADC_Done_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+    ADC_Result[0] = Sim_ADC_Sample(0);
+    for(i = 1; i < Sim_ADC_Block_Samples; i++){
+        ADC_Result[i] = Sim_ADC_Sample(Sim_ADC_Block_Samples - i);
+    }
+    (*Interrupt_ADC_Conversion_Done_ptr_fuc)();
+}
+t_uint16 _Device_Get_Sequence_ADC_Result(t_uint8 ADCchannel){
+    if(ADCchannel == ADC_Channel0){
+        return ADC_Result[0];
+    }
+    if(ADCchannel < Sim_ADC_Block_Samples){
+        return ADC_Result[Sim_ADC_Block_Samples - ADCchannel];
+    }
+    return 0;
+}
+
+void  _Device_Measured_RepeatedSingle_ADC_Init(){
+    Interrupt_ADC_Conversion_Done_ptr_fuc = empty_fun;
+    Sim_ADC_Continuous = 0;
+    Sim_ADC_Continuous_Running = 0;
+    Sim_ADC_Sequence_Mode = 0;
+    Sim_ADC_Channel = ADC_Channel0;
+}
+void  _Device_Set_Measured_RepeatedSingle_ADC_Chasnnel(MeasuredSingleADCChannels adc_channel){
+    Sim_ADC_Channel = adc_channel & 0x07;
+}
+t_uint8 _Device_Set_RepeatedSingle_ADC_Oversampling(t_uint16 samples, ADC_Oversample_Reducer reducer){
+    if((samples < ADC_Oversample_Min_Samples) || (samples > ADC_Oversample_Max_Samples) ||
+       (samples % ADC_Oversample_Block_Samples) || (reducer > ADC_Reducer_Decimate)){
+        return Func_Failure;
+    }
+    Sim_ADC_Oversample_Blocks = samples / ADC_Oversample_Block_Samples;
+    Sim_ADC_Oversample_Reducer = reducer;
+    return Func_Success;
+}
+//same reducers as ADC_Oversample_Block_Done() of ADC_Ctrl.c
+static t_uint16 Sim_ADC_Reduce_Block(void){
+    t_uint16 block[Sim_ADC_Block_Samples];
+    t_uint16 sample;
+    t_uint16 sum;
+    t_uint8 i;
+    t_uint8 j;
+
+    memcpy(block, ADC_Result, sizeof(block));
+    sum = 0;
+    if(Sim_ADC_Oversample_Reducer == ADC_Reducer_Median){
+        for(i = 1; i < Sim_ADC_Block_Samples; i++){
+            sample = block[i];
+            for(j = i; (j > 0) && (block[j - 1] > sample); j--){
+                block[j] = block[j - 1];
+            }
+            block[j] = sample;
+        }
+        return block[(Sim_ADC_Block_Samples >> 1) - 1] + block[Sim_ADC_Block_Samples >> 1];
+    }
+    i = 0;
+    j = 0;
+    for(sample = 0; sample < Sim_ADC_Block_Samples; sample++){
+        sum += block[sample];
+        if(block[sample] < block[i]){
+            i = (t_uint8)sample;
+        }
+        if(block[sample] > block[j]){
+            j = (t_uint8)sample;
+        }
+    }
+    if(Sim_ADC_Oversample_Reducer == ADC_Reducer_Trimmed_Mean){
+        sum -= block[i] + block[j];
+    }
+    return sum;
+}
+static void Sim_ADC_Latch_Result(t_uint32 accumulator){
+    t_uint16 divisor;
+
+    if(Sim_ADC_Oversample_Reducer == ADC_Reducer_Median){
+        divisor = Sim_ADC_Oversample_Blocks * 2;
+    }else if(Sim_ADC_Oversample_Reducer == ADC_Reducer_Trimmed_Mean){
+        divisor = Sim_ADC_Oversample_Blocks * (Sim_ADC_Block_Samples - 2);
+    }else{
+        divisor = Sim_ADC_Oversample_Blocks * Sim_ADC_Block_Samples;
+    }
+    Sim_ADC_Oversample_Result_x4 = (t_uint16)(((accumulator << 2) + (divisor >> 1)) / divisor);
+}
+//last block of a continuous result, samples are taken at once at the end of the result
+static void Sim_DMA1_Continuous_ISR(void){
+    t_uint8 i;
+    t_uint16 block;
+    t_uint32 accumulator;
+
+    accumulator = 0;
+    for(block = 0; block < Sim_ADC_Oversample_Blocks; block++){
+        for(i = 0; i < Sim_ADC_Block_Samples; i++){
+            ADC_Result[i] = Sim_ADC_Sample(Sim_ADC_Channel);
+        }
+        accumulator += Sim_ADC_Reduce_Block();
+    }
+    if(Sim_ADC_Result_Ready){
+        //last result is not taken yet, same as ADC_Ctrl.c
+        Sim_ADC_Overrun_Counter++;
+        Sim_ADC_Next_Start_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+        return;
+    }
+    Sim_ADC_Latch_Result(accumulator);
+    ADC_Start_Time_Stamp = Sim_ADC_Next_Start_Time_Stamp;
+    ADC_Done_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+    Sim_ADC_Next_Start_Time_Stamp = ADC_Done_Time_Stamp;
+    Sim_ADC_Result_Ready = 1;
+    (*Interrupt_ADC_Conversion_Done_ptr_fuc)();
+    Sim_Wakeup = 1;     //__bic_SR_register_on_exit(LPM0_bits)
+}
+void _Device_Set_RepeatedSingle_ADC_Continuous(t_uint8 enable){
+    if(enable){
+        Sim_ADC_Overrun_Counter = 0;
+    }else{
+        Sim_ADC_Continuous_Running = 0;
+    }
+    Sim_ADC_Continuous = enable;
+    Sim_ADC_Result_Ready = 0;
+}
+t_uint16 _Device_Get_RepeatedSingle_ADC_Overrun_Count(){
+    return Sim_ADC_Overrun_Counter;
+}
+void _Device_Get_ADC_Time_Stamps(t_uint32 *start_time_stamp, t_uint32 *done_time_stamp){
+    *start_time_stamp = ADC_Start_Time_Stamp;
+    *done_time_stamp = ADC_Done_Time_Stamp;
+}
+void _Device_Measured_RepeatedSingle_ADC_Conversion_Start(void){
+    t_uint8 i;
+    t_uint16 block;
+    t_uint32 accumulator;
+
+    Sim_ADC_Result_Ready = 0;
+    if(Sim_ADC_Continuous){
+        //results are made by Sim_DMA1_Continuous_ISR() until continuous mode is off
+        if(Sim_ADC_Continuous_Running == 0){
+            Sim_ADC_Next_Start_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+            Sim_ADC_Continuous_Next = Sim_Cycle_Count + (unsigned long long)Sim_ADC_Block_Cycles * Sim_ADC_Oversample_Blocks;
+            Sim_ADC_Continuous_Running = 1;
+        }
+        return;
+    }
+    ADC_Start_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+    accumulator = 0;
+    for(block = 0; block < Sim_ADC_Oversample_Blocks; block++){
+        for(i = 0; i < Sim_ADC_Block_Samples; i++){
+            Host_Sim_Advance_Cycles((unsigned long)(Sim_ADC_Block_Cycles / Sim_ADC_Block_Samples));
+            ADC_Result[i] = Sim_ADC_Sample(Sim_ADC_Channel);
+        }
+        accumulator += Sim_ADC_Reduce_Block();
+    }
+    Sim_ADC_Latch_Result(accumulator);
+    //DMA1_ISR
+    ADC_Done_Time_Stamp = _Device_Get_TimerA_Time_Stamp();
+    (*Interrupt_ADC_Conversion_Done_ptr_fuc)();
+}
+t_uint16 _Device_Get_RepeatedSingle_ADC_Result(){
+    return (Sim_ADC_Oversample_Result_x4 + 2) >> 2;
+}
+t_uint16 _Device_Get_RepeatedSingle_ADC_Reduced_Result(){
+    if(Sim_ADC_Oversample_Reducer == ADC_Reducer_Decimate){
+        return Sim_ADC_Oversample_Result_x4;
+    }
+    return _Device_Get_RepeatedSingle_ADC_Result();
+}
+void _Device_Set_Interrupt_For_ADC_Conversion_Done_Calling_Function(void (*calling_fun)()){
+    Interrupt_ADC_Conversion_Done_ptr_fuc = calling_fun;
+}
+void _Device_Remove_ADC_Conversion_Done_Timer_Calling_Function(void){
+    Interrupt_ADC_Conversion_Done_ptr_fuc = empty_fun;
+}
+t_uint8 _Device_ADC_Stream_Start(t_uint8 ADCchannel, t_uint8 sequence, t_uint16 sample_rate){
+    t_uint16 period;
+
+    if((ADCchannel > ADC_Channel7) || (sample_rate < ADC_Stream_Min_Sample_Rate) || (sample_rate > ADC_Stream_Max_Sample_Rate)){
+        return Func_Failure;
+    }
+    //TA0 period in SMCLK, same rounding as ADC_Ctrl.c
+    period = (t_uint16)(REQUIRE_FREQ_SMCLK / sample_rate);
+    Sim_ADC_Stream_Channel = ADCchannel;
+    Sim_ADC_Stream_Sequence = sequence;
+    Sim_ADC_Stream_Block_Cycles = (unsigned long long)period * (REQUIRE_FREQ_MCLK / REQUIRE_FREQ_SMCLK) * ADC_Stream_Block_Samples;
+    Sim_ADC_Stream_Next = Sim_Cycle_Count + Sim_ADC_Stream_Block_Cycles;
+    ADC_Stream_Ready_Flag = 0;
+    ADC_Stream_Block_Counter = 0;
+    ADC_Stream_Dropped_Block_Counter = 0;
+    Sim_ADC_Stream_Mode = 1;
+    Sim_ADC_Continuous = 0;
+    Sim_ADC_Continuous_Running = 0;
+    return Func_Success;
+}
+void _Device_ADC_Stream_Stop(void){
+    Sim_ADC_Stream_Mode = 0;
+    ADC_Stream_Ready_Flag = 0;
+}
+t_uint8 _Device_ADC_Stream_Is_Block_Ready(void){
+    return (ADC_Stream_Ready_Flag != 0);
+}
+t_uint16* _Device_ADC_Stream_Get_Ready_Block(t_uint32 *block_number){
+    *block_number = ADC_Stream_Block_Counter - 1;
+    if(ADC_Stream_Ready_Flag & (1 << (*block_number & 0x01))){
+        return &ADC_Stream_Buffer[*block_number & 0x01][0];
+    }
+    return 0;
+}
+t_uint8 _Device_ADC_Stream_Release_Block(t_uint32 block_number){
+    if((ADC_Stream_Block_Counter == (block_number + 1)) && (ADC_Stream_Ready_Flag & (1 << (block_number & 0x01)))){
+        ADC_Stream_Ready_Flag &= ~(1 << (block_number & 0x01));
+        return Func_Success;
+    }
+    return Func_Failure;
+}
+t_uint16 _Device_ADC_Stream_Get_Dropped_Blocks(void){
+    return ADC_Stream_Dropped_Block_Counter;
+}
+t_uint8 _Device_ADC_Watch_Start(t_uint8 ADCchannel, t_uint16 sample_rate, t_uint16 low_threshold, t_uint16 high_threshold){
+    t_uint32 period;
+
+    if((ADCchannel > ADC_Channel7) || (sample_rate < ADC_Watch_Min_Sample_Rate) || (sample_rate > ADC_Watch_Max_Sample_Rate) ||
+       (low_threshold > high_threshold) || (high_threshold > ADC_Watch_Max_Threshold)){
+        return Func_Failure;
+    }
+    //TA0 period in SMCLK, same rounding and divider as ADC_Ctrl.c
+    if(sample_rate < 100){
+        period = (t_uint16)((REQUIRE_FREQ_SMCLK / 64) / sample_rate) * 64UL;
+    }else{
+        period = (t_uint16)(REQUIRE_FREQ_SMCLK / sample_rate);
+    }
+    Sim_ADC_Stream_Mode = 0;
+    Sim_ADC_Watch_Channel = ADCchannel;
+    Sim_ADC_Watch_Sample_Cycles = (unsigned long long)period * (REQUIRE_FREQ_MCLK / REQUIRE_FREQ_SMCLK);
+    Sim_ADC_Watch_Next = Sim_Cycle_Count + Sim_ADC_Watch_Sample_Cycles;
+    Sim_ADC_Watch_Sample_Counter = 0;
+    ADC_Watch_Low_Threshold = low_threshold;
+    ADC_Watch_High_Threshold = high_threshold;
+    ADC_Watch_Current_State = ADC_Watch_Unknown;
+    ADC_Watch_Event_Head = 0;
+    ADC_Watch_Event_Tail = 0;
+    ADC_Watch_Lost_Event_Counter = 0;
+    Sim_ADC_Watch_Mode = 1;
+    Sim_ADC_Continuous = 0;
+    Sim_ADC_Continuous_Running = 0;
+    return Func_Success;
+}
+void _Device_ADC_Watch_Stop(void){
+    Sim_ADC_Watch_Mode = 0;
+}
+t_uint8 _Device_ADC_Watch_Is_Event_Ready(void){
+    return (ADC_Watch_Event_Head != ADC_Watch_Event_Tail);
+}
+t_uint8 _Device_ADC_Watch_Get_Event(ADC_Watch_Event *event){
+    if(ADC_Watch_Event_Head == ADC_Watch_Event_Tail){
+        return Func_Failure;
+    }
+    *event = ADC_Watch_Events[ADC_Watch_Event_Tail];
+    ADC_Watch_Event_Tail = (ADC_Watch_Event_Tail + 1) % ADC_Watch_Event_Queue_Size;
+    return Func_Success;
+}
+t_uint16 _Device_ADC_Watch_Get_Lost_Events(void){
+    return ADC_Watch_Lost_Event_Counter;
+}
+
+/************************************************************\
+| InformationFlashAccess.c                                   |
+\************************************************************/
+void WriteInitialDataToFlash(unsigned int Offset_Address, unsigned char *value, unsigned char dataLength ){
+    WriteDataToFlash(Offset_Address, value, dataLength);
+}
+void WriteDataToFlash(unsigned int Offset_Address, unsigned char *value, unsigned char dataLength ){
+    WriteDataToInfoSegment(Config_Segment, Offset_Address, value, dataLength);
+}
+void WriteDataToInfoSegment(unsigned long Segment_Address, unsigned int Offset_Address, unsigned char *value, unsigned char dataLength ){
+    unsigned int i;
+    for(i = 0; i < dataLength; i++){
+        if(Offset_Address + i >= Flash_segment_Size){
+            break;
+        }
+        ((unsigned char *)Segment_Address)[Offset_Address + i] = *value++;
+    }
+    //segment erase and write time
+    Host_Sim_Advance_Cycles(Sim_Cycles_Per_MS * 25);
+    Sim_Save_Flash();
+}
+void ReadInitialDataFromFlash(unsigned int Offset_Address, unsigned char *value, unsigned char dataLength ){
+    unsigned int i;
+    for(i = 0; i < dataLength; i++){
+        if(Offset_Address + i >= Flash_segment_Size){
+            break;
+        }
+        *value++ = ((unsigned char *)Config_Segment)[Offset_Address + i];
+    }
+}
+
+/*
+ * ======== System Function control setting ========
+ */
+void _Device_System_Func_Ctrl_Init(void){}
+void _Device_Set_VPD_GATE(Device_Status status){}
+void _Device_Set_VPC_GATE(Device_Status status){}
+void _Device_Set_LOADING_GATE(Device_Status status){}
+void _Device_Set_CHGING_VIA_PACK_D_GATE(Device_Status status){}
+
+#endif //_Config_HOST_SIMULATION_
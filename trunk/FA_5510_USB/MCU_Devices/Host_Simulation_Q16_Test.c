@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file    Host_Simulation_Q16_Test.c
+  * @author  Dynapack ADT, Hsinmo
+  * @version V1.0.0
+  * @date    17-October-2026
+  * @brief   Host test of the Q16.16 real value conversion against the float path
+  ******************************************************************************
+  * @attention
+  *
+  * Only used when _Config_HOST_SIMULATION_ is defined. It replaces main.c of the
+  * simulator build, e.g.
+  *
+  *   gcc -D_Config_HOST_SIMULATION_ -I. -o q16_test MCU_Devices/Host_Simulation_Q16_Test.c
+  *       DUI_For_USB_CDC.c DUI_For_UART.c DUI_For_Peripheral_Control.c Utilities/CheckSum16.c
+  *       Utilities/CRC16_CCITT.c Utilities/ModBus_CRC16.c MCU_Devices/Host_Simulation_Devices.c -lm
+  *   ./q16_test
+  *
+  * For all 1024 ADC codes of each MeasuredFunctions, _DUI_Get_RealMeasuredDate_By_ADC()
+  * is compared with (Adc / factor) + 0.5f of the float path it replaced, for the default
+  * factors of FA_MainSystemConfigDefineVarsForFlash.h and a log sweep of factors.
+  * Results above 0xFFFF are expected to saturate. It fails if any result is off by more
+  * than 1 LSB, 1 LSB is allowed where the quotient is close to .5.
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 Dynapack</center></h2>
+  ******************************************************************************
+  */
+#if defined(_Config_HOST_SIMULATION_)
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "MCU_Devices.h"
+#include "InformationFlash_Memory_Define.h"
+#include "../FA_MainSystemConfigDefineVarsForFlash.h"
+#include "../SystemConfigDefineForFlash.h"
+#include "../Global_Vars_Define.h"
+#include "../DUI_For_Peripheral_Control.h"
+
+//==============================================================================
+// Private define
+//==============================================================================
+#define Q16_Test_ADC_Codes          1024
+#define Q16_Test_Sweep_Factors      2000
+#define Q16_Test_Sweep_Min_Factor   0.001f
+#define Q16_Test_Sweep_Max_Factor   100.0f
+
+//==============================================================================
+// Global variables
+//==============================================================================
+t_uint16 G_Var_Array[Global_VarArray_Int_Size];     //main.c is not linked
+
+//==============================================================================
+// Private variables
+//==============================================================================
+static const t_uint8 Q16_Test_Factor_Offset[] = {
+    0,                                          //Measured_Empty
+    FA_24V_mV_To_ADC_Factor_offset,             //Measured_24V_Chger
+    FA_36V_mV_To_ADC_Factor_offset,             //Measured_36V_Chger
+    FA_48V_mV_To_ADC_Factor_offset,             //Measured_48V_Chger
+    FA_Pack_DSG_mV_To_ADC_Factor_offset,        //Measured_Pack_DSG_Vol
+    FA_Pack_CHG_mV_To_ADC_Factor_offset,        //Measured_Pack_CHG_Vol
+    FA_CHG_Current_mA_To_ADC_Factor_offset,     //Measured_Charging_Current
+    FA_DSG_Current_mA_To_ADC_Factor_offset      //Measured_Discharging_Current
+};
+static const float Q16_Test_Default_Factor[] = {
+    0.0f,
+    _FA_24V_mV_To_ADC_Factor_,
+    _FA_36V_mV_To_ADC_Factor_,
+    _FA_48V_mV_To_ADC_Factor_,
+    _FA_Pack_DSG_mV_To_ADC_Factor_,
+    _FA_Pack_CHG_mV_To_ADC_Factor_,
+    _FA_CHG_Current_mA_To_ADC_Factor_,
+    _FA_DSG_Current_mA_To_ADC_Factor_
+};
+static unsigned long Q16_Test_Compared;
+static unsigned long Q16_Test_Off_By_One;
+static unsigned long Q16_Test_Failed;
+
+//==============================================================================
+// Private functions
+//==============================================================================
+static void Q16_Test_Set_Factor(MeasuredFunctions mf, float factor){
+    memcpy((unsigned char *)Config_Segment + Q16_Test_Factor_Offset[mf], &factor, 4);
+}
+// float path of _DUI_Get_RealMeasuredDate_By_ADC() before the Q16.16 multipliers
+static unsigned long Q16_Test_Float_Path(t_uint16 Adc, float factor){
+    float temp_float;
+
+    temp_float = (Adc / factor) + 0.5f; //round off
+    if(temp_float >= 65535.0f){
+        return 0xFFFF;
+    }
+    return (unsigned long)temp_float;
+}
+static void Q16_Test_Compare(MeasuredFunctions mf, float factor){
+    t_uint16 adc;
+    unsigned long expected;
+    unsigned long value;
+    unsigned long diff;
+
+    for(adc = 0; adc < Q16_Test_ADC_Codes; adc++){
+        expected = Q16_Test_Float_Path(adc, factor);
+        value = _DUI_Get_RealMeasuredDate_By_ADC(mf, adc);
+        diff = (value > expected) ? (value - expected) : (expected - value);
+        Q16_Test_Compared++;
+        if(diff == 1){
+            Q16_Test_Off_By_One++;
+        }else if(diff > 1){
+            if(Q16_Test_Failed < 10){
+                printf("FAIL mf %d factor %.9g adc %u : float %lu, Q16 %lu\n", mf, factor, adc, expected, value);
+            }
+            Q16_Test_Failed++;
+        }
+    }
+}
+
+//==============================================================================
+// Public functions
+//==============================================================================
+int main(void){
+    t_uint8 mf;
+    unsigned int i;
+    float factor;
+
+    //erased flash, no calibration table is used
+    memset(Host_Sim_Info_Flash, 0xff, Flash_segment_Size * 4);
+    for(mf = Measured_24V_Chger; mf <= Measured_Discharging_Current; mf++){
+        Q16_Test_Set_Factor((MeasuredFunctions)mf, Q16_Test_Default_Factor[mf]);
+    }
+    _DUI_Update_Real_Value_Multipliers();
+    for(mf = Measured_24V_Chger; mf <= Measured_Discharging_Current; mf++){
+        Q16_Test_Compare((MeasuredFunctions)mf, Q16_Test_Default_Factor[mf]);
+    }
+    printf("default factors : %lu compared, %lu off by 1 LSB, %lu failed\n",
+           Q16_Test_Compared, Q16_Test_Off_By_One, Q16_Test_Failed);
+
+    for(i = 0; i < Q16_Test_Sweep_Factors; i++){
+        factor = Q16_Test_Sweep_Min_Factor *
+                 powf(Q16_Test_Sweep_Max_Factor / Q16_Test_Sweep_Min_Factor, (float)i / (Q16_Test_Sweep_Factors - 1));
+        Q16_Test_Set_Factor(Measured_24V_Chger, factor);
+        _DUI_Update_Real_Value_Multipliers();
+        Q16_Test_Compare(Measured_24V_Chger, factor);
+    }
+    printf("with factor sweep : %lu compared, %lu off by 1 LSB, %lu failed\n",
+           Q16_Test_Compared, Q16_Test_Off_By_One, Q16_Test_Failed);
+    return (Q16_Test_Failed == 0) ? 0 : 1;
+}
+
+#endif //_Config_HOST_SIMULATION_
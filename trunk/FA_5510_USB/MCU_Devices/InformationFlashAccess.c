@@ -68,10 +68,18 @@ void WriteInitialDataToFlash(unsigned int Offset_Address, unsigned char *value,
 }
 
 void WriteDataToFlash(unsigned int Offset_Address, unsigned char *value, unsigned char dataLength ){
+
+  WriteDataToInfoSegment(Config_Segment, Offset_Address, value, dataLength );
+
+}
+
+//write data into one of information segment D ~ A, other bytes of the segment are kept
+void WriteDataToInfoSegment(unsigned long Segment_Address, unsigned int Offset_Address, unsigned char *value, unsigned char dataLength ){
   unsigned int i;
+  unsigned char segment_A_Locked;
 
   unsigned char *Initial_Sgement_ptr;
-  Initial_Sgement_ptr = (unsigned  char *)Config_Segment; // Initialize Flash pointer;
+  Initial_Sgement_ptr = (unsigned  char *)Segment_Address; // Initialize Flash pointer;
 
   //read data from information falsh segment to array
   for(i = 0; i < Flash_segment_Size; i++){
@@ -92,6 +100,11 @@ void WriteDataToFlash(unsigned int Offset_Address, unsigned char *value, unsigne
                                             // interrupt while erasing. Re-Enable
                                             // GIE if needed
   FCTL3 = FWKEY;                            // Clear Lock bit
+  segment_A_Locked = 0;
+  if((Segment_Address == Flash_segment_A) && (FCTL3 & LOCKA)){
+    segment_A_Locked = 1;
+    FCTL3 = FWKEY+LOCKA;                    // writing 1 toggles LOCKA of FCTL3, unlock segment A
+  }
   FCTL1 = FWKEY+ERASE;                      // Set Erase bit
   *Initial_Sgement_ptr = 0;                 // Dummy write to erase Flash seg
   FCTL1 = FWKEY+WRT;                        // Set WRT bit for write operation
@@ -104,7 +117,11 @@ void WriteDataToFlash(unsigned int Offset_Address, unsigned char *value, unsigne
 
   while(FCTL3 & BUSY);
 
-  FCTL3 = FWKEY+LOCK;                       // Set LOCK bit
+  if(segment_A_Locked){
+    FCTL3 = FWKEY+LOCK+LOCKA;               // Set LOCK bit, lock segment A again
+  }else{
+    FCTL3 = FWKEY+LOCK;                     // Set LOCK bit
+  }
 
   _EINT();
 
@@ -5,11 +5,25 @@
 // define Flash Segment Address (one segment = 128 bytes)
 ///////////////////////////////////////////////////////////
 #define Flash_segment_Size 128  // bytes
-#define Flash_segment_A   0x1980  //can not be written
+#if defined(_Config_HOST_SIMULATION_)
+//RAM image of segment D ~ A, see Host_Simulation_Devices.c
+extern unsigned char Host_Sim_Info_Flash[];
+#define Flash_segment_A   ((unsigned long)Host_Sim_Info_Flash + 0x180)
+#define Flash_segment_B   ((unsigned long)Host_Sim_Info_Flash + 0x100)
+#define Flash_segment_C   ((unsigned long)Host_Sim_Info_Flash + 0x080)
+#define Flash_segment_D   ((unsigned long)Host_Sim_Info_Flash)
+#else
+#define Flash_segment_A   0x1980  //locked by LOCKA, unlock before writing
 #define Flash_segment_B   0x1900
 #define Flash_segment_C   0x1880
 #define Flash_segment_D   0x1800
+#endif
 
 #define Config_Segment   Flash_segment_C  //importment define
 
+//calibration tables, 3 tables in each segment (A is unlocked while writing)
+#define Cal_Table_Segment_1st   Flash_segment_D
+#define Cal_Table_Segment_2nd   Flash_segment_B
+#define Cal_Table_Segment_3rd   Flash_segment_A
+
 
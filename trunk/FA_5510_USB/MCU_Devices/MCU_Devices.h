@@ -62,8 +62,10 @@ void Polling_For_USB_Connection_Status(void);
 
 #if defined (_Config_TIMER_A_PERIOD_100MS_)
     #define Timer_A_Polling_Base_MS     100
+    #define Timer_A_Counts_Per_MS       250     //SMCLK / 8
 #elif defined (_Config_TIMER_A_PERIOD_10MS_)
     #define Timer_A_Polling_Base_MS     10
+    #define Timer_A_Counts_Per_MS       2000    //SMCLK
 #else
     #error "please define Timer A Period"
 #endif
@@ -74,6 +76,7 @@ void _Device_Enable_Timer_A(void);
 void _Device_Disable_Timer_A(void);
 void _Device_Set_TimerA_Interrupt_Timer_Calling_Function(t_uint8 fun_index, void (*calling_fun)());
 void _Device_Remove_TimerA_Interrupt_Timer_Calling_Function(t_uint8 fun_index);
+t_uint32 _Device_Get_TimerA_Time_Stamp(void);
 
 /*
  * ======== Timer B Config ========
@@ -110,9 +113,12 @@ void _Device_Set_Commun_Mux_Channel(Communication_Mux_Channels channel);
 /*
  * ======== UART Module 1 Config ========
  */
+//return value of calling function by Uart receive interrupt
+#define Uart_Receive_Keep_LPM                   0
+#define Uart_Receive_Exit_LPM                   1       //a received frame is ended, wake up main()
 #define UART_Module_1_USCI_A_BASEADDRESS        USCI_A1_BASE
 //#define Module_1_BAUD_RATE                      9600
-#define Uart_Module_1_SendingTimeOutCycle       2000
+#define Uart_Module_1_TX_Ring_Size              64      //bytes, power of 2
 
 
 #define USART_Module_1_TX_PORT                  GPIO_PORT_P4
@@ -122,15 +128,18 @@ void _Device_Set_Commun_Mux_Channel(Communication_Mux_Channels channel);
 
 t_uint8 _Device_Uart_Module_1_Enable(t_uint32 baud_rate);
 void _Device_Uart_Module_1_Disable(void);
-void _Device_Uart_Module_1_Set_Calling_Function_By_Uart_Receive_Interrupt(void (*calling_fun)(__IO t_uint8 receivedByte));
+void _Device_Uart_Module_1_Set_Calling_Function_By_Uart_Receive_Interrupt(t_uint8 (*calling_fun)(__IO t_uint8 receivedByte));
 t_uint8 _Device_Uart_Module_1_Send_Bytes(unsigned char *sendByte, unsigned int length);
+void _Device_Uart_Module_1_Set_Calling_Function_By_Uart_Transmit_Done(void (*calling_fun)(void));
+t_uint8 _Device_Uart_Module_1_Is_Transmitting(void);
+t_uint16 _Device_Uart_Module_1_Get_Transmit_Free_Size(void);
 
 /*
  * ======== UART Module 2 Config ========
  */
 #define UART_Module_2_USCI_A_BASEADDRESS        USCI_A0_BASE
 //#define Module_2_BAUD_RATE                      9600
-#define Uart_Module_2_SendingTimeOutCycle       2000
+#define Uart_Module_2_TX_Ring_Size              64      //bytes, power of 2
 
 
 #define USART_Module_2_TX_PORT                  GPIO_PORT_P3
@@ -140,8 +149,11 @@ t_uint8 _Device_Uart_Module_1_Send_Bytes(unsigned char *sendByte, unsigned int l
 
 t_uint8 _Device_Uart_Module_2_Enable(t_uint32 baud_rate);
 void _Device_Uart_Module_2_Disable(void);
-void _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Receive_Interrupt(void (*calling_fun)(__IO t_uint8 receivedByte));
+void _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Receive_Interrupt(t_uint8 (*calling_fun)(__IO t_uint8 receivedByte));
 t_uint8 _Device_Uart_Module_2_Send_Bytes(unsigned char *sendByte, unsigned int length);
+void _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Transmit_Done(void (*calling_fun)(void));
+t_uint8 _Device_Uart_Module_2_Is_Transmitting(void);
+t_uint16 _Device_Uart_Module_2_Get_Transmit_Free_Size(void);
 
 /*
  * ======== I2C UCB0 Master Config ========
@@ -207,6 +219,11 @@ unsigned char _Device_get_SCL_Pin_Status(void);
 //void ResetRXBuffer();
 //void ResetTXBuffer();
 
+/*
+ * ======== CRC Module ========
+ */
+t_uint16 _Device_CRC16_CCITT(t_uint16 seed, t_uint8 *data, t_uint16 length);
+
 /*
  * ======== USB Config ========
  */
@@ -214,6 +231,12 @@ void _Device_Init_USB_Config (void);
 void _Device_Set_USB_Receive_From_PC_Calling_Function(void (*calling_fun)(t_uint8* receivedBytesBuffer, t_uint16 receivingSize));
 t_uint8 _Device_USB_Send_Bytes_To_PC(unsigned char *sendByte, unsigned int length);
 t_uint8 _Device_Polling_For_USB_Connection_Status();
+t_uint8 _Device_Is_USB_Data_Received();
+t_uint16 _Device_USB_Receive_From_PC();
+t_uint8 _Device_Is_USB_Sending();
+t_uint8 _Device_Is_USB_Break_Received();
+void _Device_Clear_USB_Break_Received();
+#define USB_Receive_Max_Bytes_Per_Packet    64
 
 /*
  * ======== Charger Function_Control ========
@@ -305,6 +328,54 @@ void  _Device_Set_Measured_RepeatedSingle_ADC_Chasnnel(MeasuredSingleADCChannels
 void _Device_Measured_RepeatedSingle_ADC_Conversion_Start(void);
 t_uint16 _Device_Get_RepeatedSingle_ADC_Result();
 
+//oversampling of repeated single channel, samples = N x ADC_Oversample_Block_Samples
+#define ADC_Oversample_Block_Samples    8       //samples of one DMA block
+#define ADC_Oversample_Min_Samples      8
+#define ADC_Oversample_Max_Samples      1024
+typedef enum{
+    ADC_Reducer_Mean = 0,       //mean of all samples
+    ADC_Reducer_Median,         //median of each block, mean of the medians
+    ADC_Reducer_Trimmed_Mean,   //min and max of each block are dropped
+    ADC_Reducer_Decimate        //oversample and decimate, 12 bits result
+}ADC_Oversample_Reducer;
+t_uint8 _Device_Set_RepeatedSingle_ADC_Oversampling(t_uint16 samples, ADC_Oversample_Reducer reducer);
+t_uint16 _Device_Get_RepeatedSingle_ADC_Reduced_Result();
+void _Device_Set_RepeatedSingle_ADC_Continuous(t_uint8 enable);
+t_uint16 _Device_Get_RepeatedSingle_ADC_Overrun_Count();
+void _Device_Get_ADC_Time_Stamps(t_uint32 *start_time_stamp, t_uint32 *done_time_stamp);
+
+#define ADC_Stream_Block_Samples        64      //samples of one ping-pong buffer
+#define ADC_Stream_Min_Sample_Rate      1000    //S/s
+#define ADC_Stream_Max_Sample_Rate      50000   //S/s
+t_uint8 _Device_ADC_Stream_Start(t_uint8 ADCchannel, t_uint8 sequence, t_uint16 sample_rate);
+void _Device_ADC_Stream_Stop(void);
+t_uint8 _Device_ADC_Stream_Is_Block_Ready(void);
+t_uint16* _Device_ADC_Stream_Get_Ready_Block(t_uint32 *block_number);
+t_uint8 _Device_ADC_Stream_Release_Block(t_uint32 block_number);
+t_uint16 _Device_ADC_Stream_Get_Dropped_Blocks(void);
+
+#define ADC_Watch_Min_Sample_Rate       1       //S/s
+#define ADC_Watch_Max_Sample_Rate       10000   //S/s
+#define ADC_Watch_Max_Threshold         1023    //10 bits
+#define ADC_Watch_Event_Queue_Size      8       //power of 2
+typedef enum{
+    ADC_Watch_Unknown = 0,      //before the first conversion
+    ADC_Watch_Below,            //ADC < low threshold
+    ADC_Watch_Inside,           //low threshold <= ADC <= high threshold
+    ADC_Watch_Above             //ADC > high threshold
+}ADC_Watch_State;
+typedef struct{
+    t_uint32 Sample_Number;     //0 is the first conversion after starting
+    t_uint32 Time_Stamp;        //_Device_Get_TimerA_Time_Stamp()
+    t_uint16 ADC;
+    t_uint8 State;              //ADC_Watch_State
+}ADC_Watch_Event;
+t_uint8 _Device_ADC_Watch_Start(t_uint8 ADCchannel, t_uint16 sample_rate, t_uint16 low_threshold, t_uint16 high_threshold);
+void _Device_ADC_Watch_Stop(void);
+t_uint8 _Device_ADC_Watch_Is_Event_Ready(void);
+t_uint8 _Device_ADC_Watch_Get_Event(ADC_Watch_Event *event);
+t_uint16 _Device_ADC_Watch_Get_Lost_Events(void);
+
 void _Device_Set_Interrupt_For_ADC_Conversion_Done_Calling_Function(void (*calling_fun)());
 void _Device_Remove_ADC_Conversion_Done_Timer_Calling_Function(void);
 
@@ -314,6 +385,7 @@ void _Device_Remove_ADC_Conversion_Done_Timer_Calling_Function(void);
 \************************************************************/
 void WriteInitialDataToFlash(unsigned int Offset_Address, unsigned char *value, unsigned char dataLength );
 void WriteDataToFlash(unsigned int Offset_Address, unsigned char *value, unsigned char dataLength );
+void WriteDataToInfoSegment(unsigned long Segment_Address, unsigned int Offset_Address, unsigned char *value, unsigned char dataLength );
 void ReadInitialDataFromFlash(unsigned int Offset_Address, unsigned char *value, unsigned char dataLength );
 
 /*
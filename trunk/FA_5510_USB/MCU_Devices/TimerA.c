@@ -73,6 +73,7 @@
 //__IO UINT16 Interrupt_Calling_TimingDelay_counter_TimerA;
 void (*Interrupt_TimerA_ptr_fuc[Max_TimerA_INTERRUPT_Function_Calling])(void);
 void empty_timerA_fun(void){}
+__IO t_uint32 TimerA_Period_Counter;    //counted by TIMER1_A0_ISR, for time stamp
 
 
 //==============================================================================
@@ -94,6 +95,7 @@ void _Device_Init_Timer_A (void)
     for(i = 0; i < Max_TimerA_INTERRUPT_Function_Calling; i++){
         Interrupt_TimerA_ptr_fuc[i] = empty_timerA_fun;
     }
+    TimerA_Period_Counter = 0;
 
 
 //    //Set P1.0 to output direction
@@ -170,6 +172,19 @@ void _Device_Remove_TimerA_Interrupt_Timer_Calling_Function(t_uint8 fun_index){
     }
     Interrupt_TimerA_ptr_fuc[fun_index] = empty_timerA_fun;
 }
+// free running time stamp, Timer_A_Counts_Per_MS counts per ms, wraps around 32 bits
+// also called by ISR, the period is counted if TIMER1_A0_ISR is pending after wrapping
+t_uint32 _Device_Get_TimerA_Time_Stamp(void){
+    t_uint32 periods;
+    t_uint16 counts;
+    t_uint8 wrapped;
+    do{
+        periods = TimerA_Period_Counter;
+        counts = TIMER_A_getCounterValue(TIMER_A1_BASE);
+        wrapped = ((TA1CCTL0 & CCIFG) && (counts < ((TIMER_A_COUNT + 1) >> 1)));
+    }while(periods != TimerA_Period_Counter);
+    return ((periods + wrapped) * (TIMER_A_COUNT + 1)) + counts;
+}
 //******************************************************************************
 //
 //This is the TIMER1_A3 interrupt vector service routine.
@@ -183,6 +198,7 @@ __interrupt void TIMER1_A0_ISR (void)
 //        GPIO_PORT_P1,
 //        GPIO_PIN0
 //        );
+    TimerA_Period_Counter++;
     for( t_uint8 i = 0; i < Max_TimerA_INTERRUPT_Function_Calling; i++){
         (*Interrupt_TimerA_ptr_fuc[i])();
     }
@@ -222,7 +222,7 @@ __interrupt void TIMERB0_ISR (void)
 
 	t_uint16 i;
     t_uint8 empty_Count;
-    t_uint8 setting_Count;
+    t_uint16 setting_Count;
 
 
 
@@ -236,6 +236,8 @@ __interrupt void TIMERB0_ISR (void)
                 (*Interrupt_TimerB_ptr_fuc[i])();
                 Interrupt_TimerB_ptr_fuc[i] = empty_timerB_fun;
                 Interrupt_Calling_TimingDelay_counter_TimerB[i] = 0;
+                //main() may wait for this calling function in LPM0
+                __bic_SR_register_on_exit(LPM0_bits);
             }else{
                 Interrupt_Calling_TimingDelay_counter_TimerB[i]++;
             }
@@ -18,12 +18,32 @@
 //typedef signed int*     PINT16;
 //typedef signed long*    PINT32;
 
+#if defined(_Config_HOST_SIMULATION_)
+//keep MSP430 widths on the workstation compiler (int 32 bits, long 64 bits)
+typedef signed char     t_int8;
+typedef unsigned char   t_uint8;
+typedef signed short    t_int16;
+typedef unsigned short  t_uint16;
+typedef signed int      t_int32;
+typedef unsigned int    t_uint32;
+typedef signed long long    t_int64;
+typedef unsigned long long  t_uint64;
+
+typedef unsigned char*  t_puint8;
+typedef unsigned short* t_puint16;
+typedef unsigned int*   t_puint32;
+typedef signed char*    t_pint8t;
+typedef signed short*   t_pint16;
+typedef signed int*     t_pint32;
+#else
 typedef signed char     t_int8;
 typedef unsigned char   t_uint8;
 typedef signed int      t_int16;
 typedef unsigned int    t_uint16;
 typedef signed long     t_int32;
 typedef unsigned long   t_uint32;
+typedef signed long long    t_int64;
+typedef unsigned long long  t_uint64;
 
 typedef unsigned char*  t_puint8;
 typedef unsigned int*   t_puint16;
@@ -31,6 +51,7 @@ typedef unsigned long*  t_puint32;
 typedef signed char*    t_pint8t;
 typedef signed int*     t_pint16;
 typedef signed long*    t_pint32;
+#endif
 #define __IO            volatile
 
 
@@ -35,6 +35,7 @@
 //==============================================================================
 // Private define
 //==============================================================================
+#define UART_TX_Ring_Mask           (Uart_Module_2_TX_Ring_Size - 1)
 
 
 //==============================================================================
@@ -46,7 +47,11 @@
 //==============================================================================
 // Private variables
 //==============================================================================
-static unsigned int SendingWhileTimeOutCount;
+//TX ring, indexes are free running and masked, head is moved by Send_Bytes and tail by the ISR
+static t_uint8 UART_TX_Ring[Uart_Module_2_TX_Ring_Size];
+static __IO t_uint16 UART_TX_Ring_Head;
+static __IO t_uint16 UART_TX_Ring_Tail;
+static __IO t_uint8 UART_TX_Active;                 //TX interrupt is enabled
 
 //#define Receiving_Max_Length    10
 //__IO unsigned int UART_Receiving_Data_Index;
@@ -55,8 +60,10 @@ static unsigned int SendingWhileTimeOutCount;
 //==============================================================================
 // Private function prototypes
 //==============================================================================
-static void (*Interrupt_UART_ReceiveData_ptr_fuc)(__IO t_uint8 receivedByte);
-static void Empty_UART_fun(__IO t_uint8 receivedByte){}
+static t_uint8 (*Interrupt_UART_ReceiveData_ptr_fuc)(__IO t_uint8 receivedByte);
+static t_uint8 Empty_UART_fun(__IO t_uint8 receivedByte){return Uart_Receive_Keep_LPM;}
+static void (*Interrupt_UART_TransmitDone_ptr_fuc)(void);
+static void Empty_UART_TX_Done_fun(void){}
 
 
 //==============================================================================
@@ -142,7 +149,10 @@ t_uint8 _Device_Uart_Module_2_Enable(t_uint32 baud_rate){
     //__bis_SR_register(LPM3_bits + GIE);
     __no_operation();
     Interrupt_UART_ReceiveData_ptr_fuc = Empty_UART_fun;
-    SendingWhileTimeOutCount = 0;
+    Interrupt_UART_TransmitDone_ptr_fuc = Empty_UART_TX_Done_fun;
+    UART_TX_Ring_Head = 0;
+    UART_TX_Ring_Tail = 0;
+    UART_TX_Active = 0;
 
     return Func_Success;
 }
@@ -154,41 +164,66 @@ void _Device_Uart_Module_2_Disable(void){
     //Disable Receive Interrupt
 	USCI_A_UART_clearInterruptFlag(UART_Module_2_USCI_A_BASEADDRESS, USCI_A_UART_RECEIVE_INTERRUPT);
     USCI_A_UART_disableInterrupt(UART_Module_2_USCI_A_BASEADDRESS, USCI_A_UART_RECEIVE_INTERRUPT);
+    //queued bytes are dropped
+    USCI_A_UART_disableInterrupt(UART_Module_2_USCI_A_BASEADDRESS, USCI_A_UART_TRANSMIT_INTERRUPT);
+    UART_TX_Ring_Tail = UART_TX_Ring_Head;
+    UART_TX_Active = 0;
     __no_operation();
     Interrupt_UART_ReceiveData_ptr_fuc = Empty_UART_fun;
+    Interrupt_UART_TransmitDone_ptr_fuc = Empty_UART_TX_Done_fun;
 
 }
 
-void _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Receive_Interrupt(void (*calling_fun)(__IO t_uint8 receivedByte)){
+void _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Receive_Interrupt(t_uint8 (*calling_fun)(__IO t_uint8 receivedByte)){
     Interrupt_UART_ReceiveData_ptr_fuc = calling_fun;
 }
 
+// bytes are queued into the TX ring and sent by USCI_A0_ISR, it does not wait for the wire
+// return Func_Failure if the ring has no room for all bytes, nothing is queued then
 t_uint8 _Device_Uart_Module_2_Send_Bytes(unsigned char *sendByte, unsigned int length){
 	unsigned int i;
+    t_uint16 head;
 
-//    if(Usart_Peripheral_Enable_Flag == DeviceOff){
-//        return Func_Fail;
-//    }
-
+    if(length > (Uart_Module_2_TX_Ring_Size - (t_uint16)(UART_TX_Ring_Head - UART_TX_Ring_Tail))){
+        return Func_Failure;
+    }
+    if(length == 0){
+        return Func_Success;
+    }
+    head = UART_TX_Ring_Head;
 	for(i = 0; i < length; i++){
-		SendingWhileTimeOutCount = 0;
-        //confirm TX buffer is ready first, USCI_A1 TX buffer ready?
-        while (!USCI_A_UART_getInterruptStatus(UART_Module_2_USCI_A_BASEADDRESS, USCI_A_UART_TRANSMIT_INTERRUPT_FLAG)){
-            __no_operation();
-			if(SendingWhileTimeOutCount >= UART_Module_2_USCI_A_BASEADDRESS){
-				break;
-			}
-			SendingWhileTimeOutCount++;
-        }
-
-        //Transmit data
-        USCI_A_UART_transmitData(UART_Module_2_USCI_A_BASEADDRESS, (*(sendByte + i)));
+        UART_TX_Ring[head & UART_TX_Ring_Mask] = sendByte[i];
+        head++;
     }
-    __no_operation();
+    __disable_interrupt();
+    UART_TX_Ring_Head = head;
+    if(UART_TX_Active == 0){
+        //TXIFG is cleared by reading UCA0IV at the end of last sending,
+        //so the first byte is written here and TXIFG of the next one calls the ISR
+        UART_TX_Active = 1;
+        USCI_A_UART_transmitData(UART_Module_2_USCI_A_BASEADDRESS, UART_TX_Ring[UART_TX_Ring_Tail & UART_TX_Ring_Mask]);
+        UART_TX_Ring_Tail++;
+        USCI_A_UART_enableInterrupt(UART_Module_2_USCI_A_BASEADDRESS, USCI_A_UART_TRANSMIT_INTERRUPT);
+    }
+    __enable_interrupt();
 
     return Func_Success;
 }
 
+// calling_fun is called by USCI_A0_ISR when the TX ring is empty, the last byte is still shifting out
+void _Device_Uart_Module_2_Set_Calling_Function_By_Uart_Transmit_Done(void (*calling_fun)(void)){
+    Interrupt_UART_TransmitDone_ptr_fuc = calling_fun;
+}
+
+t_uint8 _Device_Uart_Module_2_Is_Transmitting(void){
+    return UART_TX_Active;
+}
+
+// bytes can be queued by _Device_Uart_Module_2_Send_Bytes() now
+t_uint16 _Device_Uart_Module_2_Get_Transmit_Free_Size(void){
+    return Uart_Module_2_TX_Ring_Size - (t_uint16)(UART_TX_Ring_Head - UART_TX_Ring_Tail);
+}
+
 
 //******************************************************************************
 //
@@ -203,9 +238,23 @@ __interrupt void USCI_A0_ISR (void)
         case 0:break;                             // Vector 0 - no interrupt
         case 2:                                   // Vector 2 - RXIFG
             //Receive data
-            Interrupt_UART_ReceiveData_ptr_fuc(USCI_A_UART_receiveData(UART_Module_2_USCI_A_BASEADDRESS));
+            if(Interrupt_UART_ReceiveData_ptr_fuc(USCI_A_UART_receiveData(UART_Module_2_USCI_A_BASEADDRESS)) == Uart_Receive_Exit_LPM){
+                __bic_SR_register_on_exit(LPM0_bits);
+            }
+        break;
+        case 4:                                   // Vector 4 - TXIFG
+            if(UART_TX_Ring_Tail != UART_TX_Ring_Head){
+                USCI_A_UART_transmitData(UART_Module_2_USCI_A_BASEADDRESS, UART_TX_Ring[UART_TX_Ring_Tail & UART_TX_Ring_Mask]);
+                UART_TX_Ring_Tail++;
+                break;
+            }
+            //ring is empty, the last byte is in the shift register
+            USCI_A_UART_disableInterrupt(UART_Module_2_USCI_A_BASEADDRESS, USCI_A_UART_TRANSMIT_INTERRUPT);
+            UART_TX_Active = 0;
+            Interrupt_UART_TransmitDone_ptr_fuc();
+            //exit LPM0 for the user of the done function
+            __bic_SR_register_on_exit(LPM0_bits);
         break;
-        case 4:break;                             // Vector 4 - TXIFG
         default: break;
     }
 }
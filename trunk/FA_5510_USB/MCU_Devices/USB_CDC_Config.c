@@ -45,7 +45,7 @@
 //==============================================================================
 // Private define
 //==============================================================================
-#define usb_RECEIVE_MAX_BUFFER_SIZE     64
+#define usb_RECEIVE_MAX_BUFFER_SIZE     USB_Receive_Max_Bytes_Per_Packet
 
 //==============================================================================
 // Private macro
@@ -61,6 +61,7 @@ unsigned char usb_ReceiveDataBuffer[usb_RECEIVE_MAX_BUFFER_SIZE] = "";
 
 //Global flags set by events
 volatile BYTE bCDCDataReceived_event = FALSE;   //Indicates data has been received without an open rcv operation
+volatile BYTE bCDCBreakReceived_event = FALSE;  //Indicates SendBreak request has been received
 
 //#define MAX_STR_LENGTH 64
 //char wholeString[MAX_STR_LENGTH] = "";          //The entire input string from the last 'return'
@@ -86,7 +87,7 @@ void _Device_Init_USB_Config (void)
     //Enable various USB event handling routines
     USB_setEnabledEvents(
         kUSB_VbusOnEvent + kUSB_VbusOffEvent + kUSB_receiveCompletedEvent
-        + kUSB_dataReceivedEvent + kUSB_UsbSuspendEvent + kUSB_UsbResumeEvent +
+        + kUSB_dataReceivedEvent + kUSB_sendCompletedEvent + kUSB_UsbSuspendEvent + kUSB_UsbResumeEvent +
         kUSB_UsbResetEvent);
 
     //See if we're already attached physically to USB, and if so, connect to it
@@ -112,7 +113,6 @@ t_uint8 _Device_USB_Send_Bytes_To_PC(unsigned char *sendByte, unsigned int lengt
 t_uint8 _Device_Polling_For_USB_Connection_Status(){
 
         BYTE ReceiveError = 0, SendError = 0;
-        WORD count;
 
         t_uint8 status;
 
@@ -136,21 +136,8 @@ t_uint8 _Device_Polling_For_USB_Connection_Status(){
 
                                                                                 //Exit LPM because of a data-receive event, and
                                                                                 //fetch the received data
-                if (bCDCDataReceived_event){
-
-                    bCDCDataReceived_event = FALSE;                             //Clear flag early -- just in case execution breaks
-                                                                                //below because of an error
-
-                    //Count has the number of bytes received into
-                    count = cdcReceiveDataInBuffer((BYTE*)usb_ReceiveDataBuffer, usb_RECEIVE_MAX_BUFFER_SIZE, CDC0_INTFNUM);
-                    USB_CDC_ReceiveData_ptr_fuc(usb_ReceiveDataBuffer, count);
-
-                                                                                //dataBuffer
-//                    if (cdcSendDataInBackground((BYTE*)dataBuffer,count,CDC0_INTFNUM,1)){  	//Echo is back to the host
-//                        SendError = 0x01;                                       			//Something went wrong -- exit
-//                        break;
-//                    }
-                }
+                //receiving is done by _Device_USB_Receive_From_PC() in main loop,
+                //USBCDC_handleDataReceived() wakes up CPU from LPM0
                 status = USB_Status_ENUM_ACTIVE;
                 break;
 
@@ -184,3 +171,49 @@ t_uint8 _Device_Polling_For_USB_Connection_Status(){
 
 }//void Polling_For_USB_Connection_Status(){
 
+/*
+ * ======== USB Receiving (main loop) ========
+ */
+t_uint8 _Device_Is_USB_Data_Received(){
+    return bCDCDataReceived_event ? 1 : 0;
+}
+
+//sendByte of the last _Device_USB_Send_Bytes_To_PC() is still in use
+t_uint8 _Device_Is_USB_Sending(){
+    WORD bytesSent, bytesReceived;
+
+    if (USBCDC_intfStatus(CDC0_INTFNUM,&bytesSent,&bytesReceived) & kUSBCDC_waitingForSend){
+        return 1;
+    }
+    return 0;
+}
+
+//SendBreak request of the host, kept until _Device_Clear_USB_Break_Received()
+t_uint8 _Device_Is_USB_Break_Received(){
+    return bCDCBreakReceived_event ? 1 : 0;
+}
+
+void _Device_Clear_USB_Break_Received(){
+    bCDCBreakReceived_event = FALSE;
+}
+
+t_uint16 _Device_USB_Receive_From_PC(){
+    WORD count;
+
+    if (!bCDCDataReceived_event){
+        return 0;
+    }
+    bCDCDataReceived_event = FALSE;                             //Clear flag early -- just in case execution breaks
+                                                                //below because of an error
+    //Count has the number of bytes received into
+    count = cdcReceiveDataInBuffer((BYTE*)usb_ReceiveDataBuffer, usb_RECEIVE_MAX_BUFFER_SIZE, CDC0_INTFNUM);
+    if(count >= usb_RECEIVE_MAX_BUFFER_SIZE){
+        //buffer full, more bytes may be left in USB buffer
+        bCDCDataReceived_event = TRUE;
+    }
+    if(count){
+        USB_CDC_ReceiveData_ptr_fuc(usb_ReceiveDataBuffer, count);
+    }
+    return count;
+}
+
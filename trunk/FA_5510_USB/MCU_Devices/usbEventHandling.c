@@ -60,6 +60,7 @@
 
 //These variables are only example, they are not needed for stack
 extern volatile BYTE bCDCDataReceived_event;    //data received event
+extern volatile BYTE bCDCBreakReceived_event;   //SendBreak request with duration received event
 
 /*
  * If this function gets executed, it's a sign that the output of the USB PLL has failed.
@@ -170,10 +171,9 @@ BYTE USBCDC_handleDataReceived (BYTE intfNum)
  */
 BYTE USBCDC_handleSendCompleted (BYTE intfNum)
 {
-    //TO DO: You can place your code here
+    //UART bridge sends the next chunk of received bytes
 
-    return (FALSE);                             //return FALSE to go asleep after interrupt (in the case the CPU slept before
-                                                //interrupt)
+    return (TRUE);                              //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
 }
 
 /*
@@ -206,6 +206,20 @@ BYTE USBCDC_handleSetControlLineState (BYTE intfNum, BYTE lineState)
 	return FALSE;
 }
 
+/*
+ * This event indicates that a SendBreak request has been received from the host
+ * only the start of a break is an event, duration 0 stops it
+ */
+BYTE USBCDC_handleSendBreak (BYTE intfNum, WORD duration)
+{
+    if (duration == 0){
+        return (FALSE);
+    }
+    bCDCBreakReceived_event = TRUE;
+
+    return (TRUE);                              //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
+}
+
 #endif //_CDC_
 
 #ifdef _HID_
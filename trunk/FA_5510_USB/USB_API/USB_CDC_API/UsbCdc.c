@@ -860,6 +860,19 @@ BYTE usbSetControlLineState (VOID)
 
 //----------------------------------------------------------------------------
 
+BYTE usbSendBreak (VOID)
+{
+    BYTE bWakeUp;
+
+    bWakeUp = USBCDC_handleSendBreak((BYTE)tSetupPacket.wIndex,
+            tSetupPacket.wValue);
+    usbSendZeroLengthPacketOnIEP0();                                        //Send ZLP for status stage
+
+    return (bWakeUp);
+}
+
+//----------------------------------------------------------------------------
+
 BYTE Handler_SetLineCoding (VOID)
 {
     BYTE bWakeUp;
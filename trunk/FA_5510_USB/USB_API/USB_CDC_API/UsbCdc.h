@@ -159,6 +159,13 @@ BYTE USBCDC_handleSetLineCoding (BYTE intfNum, ULONG lBaudrate);
  */
 BYTE USBCDC_handleSetControlLineState (BYTE intfNum, BYTE lineState);
 
+/*
+ * This event indicates that a SendBreak request was received from the host.
+ * duration is wValue of the request in ms, 0xFFFF until the next SendBreak with 0, 0 stops the break.
+ * returns TRUE to keep CPU awake
+ */
+BYTE USBCDC_handleSendBreak (BYTE intfNum, WORD duration);
+
 /*----------------------------------------------------------------------------
  * These functions is to be used ONLY by USB stack, and not by application
  +----------------------------------------------------------------------------*/
@@ -178,6 +185,11 @@ BYTE usbSetLineCoding(VOID);
  */
 BYTE usbSetControlLineState(VOID);
 
+/**
+ * Function for the SendBreak request
+ */
+BYTE usbSendBreak(VOID);
+
 /**
  * Readout the settings (send from usb host) for the second uart
  */
@@ -82,6 +82,7 @@ extern "C"
 #define USB_CDC_GET_LINE_CODING         0x21
 #define USB_CDC_SET_LINE_CODING         0x20
 #define USB_CDC_SET_CONTROL_LINE_STATE  0x22
+#define USB_CDC_SEND_BREAK              0x23
 
 //HID CLASS Requests
 #define USB_HID_REQ                     0x81
@@ -116,7 +116,7 @@ const struct abromConfigurationDescriptorGroup abromConfigurationDescriptorGroup
             0x04,	                            // bFunctionLength 
             0x24,	                            // bDescriptorType: CS_INTERFACE
             0x02,	                            // bDescriptorSubtype: Abstract Control Management desc
-            0x02,	                            // bmCapabilities
+            0x06,	                            // bmCapabilities: D1 line coding and state, D2 Send_Break
 
             // Union Functional Descriptor
             0x05,                               // Size, in bytes
@@ -263,6 +263,14 @@ const tDEVICE_REQUEST_COMPARE tUsbRequestList[] =
     0x00,0x00,                                 // No further data
     0xcf,&usbSetControlLineState,
 
+    // SEND BREAK
+    USB_REQ_TYPE_OUTPUT | USB_REQ_TYPE_CLASS | USB_REQ_TYPE_INTERFACE,
+    USB_CDC_SEND_BREAK,
+    0xff,0xff,                                 // Duration of the break in ms
+    CDC0_COMM_INTERFACE,0x00,                 // CDC interface is 0
+    0x00,0x00,                                 // No further data
+    0xcf,&usbSendBreak,
+
     //---- USB Standard Requests -----//
     // clear device feature
     USB_REQ_TYPE_OUTPUT | USB_REQ_TYPE_STANDARD | USB_REQ_TYPE_DEVICE,
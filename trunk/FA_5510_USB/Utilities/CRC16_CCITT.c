@@ -0,0 +1,32 @@
+
+
+#include "Utilities.h"
+
+#if defined(_Config_CRC16_CCITT_BY_CRC_MODULE_)
+#include "../MCU_Devices/MCU_Devices.h"
+
+unsigned int usCRC16CCITT( unsigned char * pucFrame, unsigned int usLen )
+{
+    return _Device_CRC16_CCITT( 0xFFFF, pucFrame, usLen );
+}
+
+#else
+
+/* CRC-CCITT, polynomial 0x1021, MSB first, seed 0xFFFF, no final xor */
+unsigned int usCRC16CCITT( unsigned char * pucFrame, unsigned int usLen )
+{
+    unsigned int            usCRC = 0xFFFF;
+    unsigned char           ucBit;
+
+    while( usLen-- )
+    {
+        usCRC ^= ( unsigned int )( *( pucFrame++ ) ) << 8;
+        for( ucBit = 0; ucBit < 8; ucBit++ )
+        {
+            usCRC = ( usCRC & 0x8000 ) ? ( ( usCRC << 1 ) ^ 0x1021 ) : ( usCRC << 1 );
+        }
+    }
+    return usCRC & 0xFFFF;
+}
+
+#endif
@@ -1,7 +1,11 @@
 
 
 
+//build time selection of the usCRC16CCITT kernel, the software loop if it is not defined
+#define _Config_CRC16_CCITT_BY_CRC_MODULE_      //CRC16 module of the MCU
+
 unsigned int usMBCRC16( unsigned char * pucFrame, unsigned int usLen );
 unsigned int usCheckSum16( unsigned char * pucFrame, unsigned int usLen );
+unsigned int usCRC16CCITT( unsigned char * pucFrame, unsigned int usLen );
 
 
@@ -32,34 +32,36 @@
 /////////////////////////////////////////////////////////////////////////////////
 /* G_Module_Function_Status Control Bits */
 /* For G_Module_Function_Status ; unsigned int */
+/* measurements are queued jobs of _DUI_Measurement_Job_Enqueue(), xxx_Measured_Processing bits are not used */
 //Low byte
 #define ADC_Start_Conversion            (0x0001)    //
 #define ADC_Done_Conversion             (0x0002)    //
 #define ADC_First_Conversion            (0x0004)    //Start CHG Over current counting for releasing OC. if finish, will set COC_COUNTING_FINISH flag
 //#define COC_COUNTING_FINISH             (0x0008)    //COC Over current counting Finish.
-#define DirMeasuredProcessingViaADC_Ch  (0x0010)    //direct set porcess for measured, without for setting Peripheral
-#define Charger_ID_Level_1_Check        (0x0020)    //
-#define Charger_ID_Level_2_Check        (0x0040)    //
+//#define DirMeasuredProcessingViaADC_Ch  (0x0010)    //direct set porcess for measured, without for setting Peripheral
+//#define Charger_ID_Level_1_Check        (0x0020)    //
+//#define Charger_ID_Level_2_Check        (0x0040)    //
 //#define Charger_ID_Level_3_Check        (0x0080)    //
 //Hight byte
-#define Set_Charger_24V_Measured_Processing     (0x0100)    //
-#define Set_Charger_36V_Measured_Processing     (0x0200)    //
-#define Set_Charger_48V_Measured_Processing     (0x0400)    //
-#define Process_Set_Channel                     (0x0800)    //
-#define Process_Charger_Measured_Done           (0x1000)    //
-#define Set_Pack_DSG_Vol_Measured_Processing    (0x2000)    //
-#define Set_Pack_CHG_Vol_Measured_Processing    (0x4000)    //
-#define Set_Channels_ADC_Measured_Processing    (0x8000)    //
+//#define Set_Charger_24V_Measured_Processing     (0x0100)    //
+//#define Set_Charger_36V_Measured_Processing     (0x0200)    //
+//#define Set_Charger_48V_Measured_Processing     (0x0400)    //
+//#define Process_Set_Channel                     (0x0800)    //
+//#define Process_Charger_Measured_Done           (0x1000)    //
+//#define Set_Pack_DSG_Vol_Measured_Processing    (0x2000)    //
+//#define Set_Pack_CHG_Vol_Measured_Processing    (0x4000)    //
+//#define Set_Channels_ADC_Measured_Processing    (0x8000)    //
 
 
 /////////////////////////////////////////////////////////////////////////////////
 /* G_1st_Module_Function_Status Control Bits */
 /* For G_1st_Module_Function_Status ; unsigned int */
 //Low byte
-#define Set_Chg_Current_Measured_Processing     (0x0001)    //
-#define Set_Dsg_Current_Measured_Processing     (0x0002)    //
-//#define ADC_First_Conversion            (0x0004)    //Start CHG Over current counting for releasing OC. if finish, will set COC_COUNTING_FINISH flag
-//#define COC_COUNTING_FINISH             (0x0008)    //COC Over current counting Finish.
+//#define Set_Chg_Current_Measured_Processing     (0x0001)    //
+//#define Set_Dsg_Current_Measured_Processing     (0x0002)    //
+//#define Set_All_Sequence_Measured_Processing    (0x0004)    //all channels in one Sequence of Channels conversion
+#define ADC_Stream_Processing                   (0x0008)    //timer triggered ADC streaming, blocks are sent by main()
+#define ADC_Watch_Processing                    (0x0010)    //ADC window watch, crossing events are sent by main()
 //#define DirMeasuredProcessingViaADC_Ch  (0x0010)    //direct set porcess for measured, without for setting Peripheral
 //#define Charger_ID_Level_1_Check        (0x0020)    //
 //#define Charger_ID_Level_2_Check        (0x0040)    //
@@ -20,13 +20,18 @@
 //==============================================================================
 // Includes
 //==============================================================================
+#if !defined(_Config_HOST_SIMULATION_)
 #include <intrinsics.h>
+#endif
 #include <string.h>
 
 #include "Global_Vars_Define.h"
 #include "Vars_Bit_Define.h"
 #include "SystemConfigDefineForFlash.h"
 
+#if defined(_Config_HOST_SIMULATION_)
+#include "MCU_Devices/Host_Simulation.h"
+#else
 #include "USB_config/descriptors.h"
 
 #include "USB_API/USB_Common/device.h"
@@ -40,6 +45,7 @@
 //#include "usbConstructs.h"
 
 #include "gpio.h"
+#endif
 
 #include "MCU_Devices/TypeDefine.h"
 #include "DUI_For_USB_CDC.h"
@@ -68,17 +74,15 @@
 //==============================================================================
 // Private variables
 //==============================================================================
-unsigned int G_Var_Array[Global_VarArray_Int_Size];
+t_uint16 G_Var_Array[Global_VarArray_Int_Size];
 
 //t_uint16 g_ADC_Result_data16[3];
 
 //t_uint16 g_Auto_Check_Charger_result[Auto_Check_Charger_result_Size];
-extern t_uint8 gCdcTempUint8;
 //==============================================================================
 // Private function prototypes
 //==============================================================================
-void Processing_Charger_Check(MeasuredFunctions Measured_Voltage_Chger, Switch_Channnel Switch_To_Voltage_Ch);
-void Clear_Temp_Array_Buffer(unsigned int* ptr_StartArray, unsigned char num);
+void Clear_Temp_Array_Buffer(t_uint16* ptr_StartArray, unsigned char num);
 void DelayCycles(unsigned int cycles){unsigned int i; for(i=0;i<cycles;i++) __delay_cycles(5000);/*634us at 8MHz*/}
 
 //==============================================================================
@@ -191,6 +195,7 @@ void main (void)
     _DUI_System_Function_Ctrl_Init();
     //_DUI_ADC_Function_Init();
     _DUI_ADC_Function_Init_for_RepeatedSingleCh();
+    _DUI_Update_Real_Value_Multipliers();
 
     _DUI_Init_Polling_Timer();
 
@@ -300,6 +305,17 @@ void main (void)
             //G_Module_Function_Status |= Set_Charger_24V_Measured_Processing;
 
 
+            /////////////////////////////////////////////////////////////////////
+            // ADC streaming, one block is sent on each loop, cmds are still parsed below
+            if(G_1st_Module_Function_Status & ADC_Stream_Processing){
+                _DUI_CDC_Transmitting_ADC_Stream_Block();
+            }
+            /////////////////////////////////////////////////////////////////////
+            // ADC window watch, one crossing event is sent on each loop
+            if(G_1st_Module_Function_Status & ADC_Watch_Processing){
+                _DUI_CDC_Transmitting_ADC_Watch_Event();
+            }
+
             /////////////////////////////////////////////////////////////////////
             // First Measured Processing For delete empty result
             if(!(G_Module_Function_Status & ADC_First_Conversion)){
@@ -311,316 +327,33 @@ void main (void)
                     G_Module_Function_Status &= ~ADC_Start_Conversion;
                     G_Module_Function_Status |= ADC_First_Conversion;
                 }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing For 24V Charger
-            }else if((G_Module_Function_Status & Set_Charger_24V_Measured_Processing)&&((G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)==0)){
-                if(G_Module_Function_Status & Process_Charger_Measured_Done){
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_24V_Voltage_Auto,(t_uint8 *)(&G_Temp_ADC_L0), 12);
-                    //Process_Charger_Check_Done
-                    G_Module_Function_Status &= ~Process_Charger_Measured_Done;
-                    G_Module_Function_Status &= ~Set_Charger_24V_Measured_Processing;
-                    //GPIO_setOutputLowOnPin( GPIO_PORT_P2, GPIO_PIN5 );
-                }else{
-                    // process start
-                    //GPIO_setOutputHighOnPin( GPIO_PORT_P2, GPIO_PIN5 );
-                    Processing_Charger_Check(Measured_24V_Chger, Switch_To_24V_Ch);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing For 36V Charger
-            }else if((G_Module_Function_Status & Set_Charger_36V_Measured_Processing)&&((G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)==0)){
-                if(G_Module_Function_Status & Process_Charger_Measured_Done){
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_36V_Voltage_Auto,(t_uint8 *)(&G_Temp_ADC_L0), 12);
-                    //Process_Charger_Check_Done
-                    G_Module_Function_Status &= ~Process_Charger_Measured_Done;
-                    G_Module_Function_Status &= ~Set_Charger_36V_Measured_Processing;
-                }else{
-                    // process start
-                    Processing_Charger_Check(Measured_36V_Chger, Switch_To_36V_Ch);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing For 48V Charger
-            }else if((G_Module_Function_Status & Set_Charger_48V_Measured_Processing)&&((G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)==0)){
-                if(G_Module_Function_Status & Process_Charger_Measured_Done){
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Charger_48V_Voltage_Auto,(t_uint8 *)(&G_Temp_ADC_L0), 12);
-                    //Process_Charger_Check_Done
-                    G_Module_Function_Status &= ~Process_Charger_Measured_Done;
-                    G_Module_Function_Status &= ~Set_Charger_48V_Measured_Processing;
-                }else{
-                    // process start
-                    Processing_Charger_Check(Measured_48V_Chger, Switch_To_48V_Ch);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing For Pack Voltage Via DSG Port
-            }else if((G_Module_Function_Status & Set_Pack_DSG_Vol_Measured_Processing)&&((G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)==0)){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    _DUI_SetPackDSGInputPortForMeasurement(Turn_On);
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_Pack_Dsg_ch);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Pack_DSG_Vol);
-                    G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Pack_DSG_Vol, G_Temp_ADC_L0);
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~Set_Pack_DSG_Vol_Measured_Processing;
-                    _DUI_SetPackDSGInputPortForMeasurement(Turn_Off);
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_PACK_DSG_Voltage_Auto,(t_uint8 *)(&G_Temp_ADC_L0), 4);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing For Pack Voltage Via CHG Port
-            }else if((G_Module_Function_Status & Set_Pack_CHG_Vol_Measured_Processing)&&((G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)==0)){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    _DUI_SetPackCHGInputPortForMeasurement(Turn_On);
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_Pack_Chg_ch);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Pack_CHG_Vol);
-                    G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Pack_CHG_Vol, G_Temp_ADC_L0);
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~Set_Pack_CHG_Vol_Measured_Processing;
-                    _DUI_SetPackCHGInputPortForMeasurement(Turn_Off);
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_PACK_CHG_Voltage_Auto,(t_uint8 *)(&G_Temp_ADC_L0), 4);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing For Directly ADC channel
-            }else if(G_Module_Function_Status & Set_Channels_ADC_Measured_Processing){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh((MeasuredADCChannels)gCdcTempUint8);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Raw_ADC_SingleChannle_Result();
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~Set_Channels_ADC_Measured_Processing;
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Channel_Raw_ADC,(t_uint8 *)(&G_Temp_ADC_L0), 2);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing without setting devices For Pack Voltage Via DSG Port
-            }else if((G_Module_Function_Status & Set_Pack_DSG_Vol_Measured_Processing)&&(G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_Pack_Dsg_ch);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Pack_DSG_Vol);
-                    G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Pack_DSG_Vol, G_Temp_ADC_L0);
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status &= ~Set_Pack_DSG_Vol_Measured_Processing;
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_PackDSG_Voltage,(t_uint8 *)(&G_Temp_ADC_L0), 4);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing without setting devices For Pack Voltage Via CHG Port
-            }else if((G_Module_Function_Status & Set_Pack_CHG_Vol_Measured_Processing)&&(G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_Pack_Chg_ch);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Pack_CHG_Vol);
-                    G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Pack_CHG_Vol, G_Temp_ADC_L0);
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status &= ~Set_Pack_CHG_Vol_Measured_Processing;
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_PackCHG_Voltage,(t_uint8 *)(&G_Temp_ADC_L0), 4);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing without setting devices For Charger_24V_Measured_Processing
-            }else if((G_Module_Function_Status & Set_Charger_24V_Measured_Processing)&&(G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_Chger_Vol_ch);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_24V_Chger);
-                    G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_24V_Chger, G_Temp_ADC_L0);
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status &= ~Set_Charger_24V_Measured_Processing;
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_Chger_24Voltage,(t_uint8 *)(&G_Temp_ADC_L0), 4);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing without setting devices For Charger_36V_Measured_Processing
-            }else if((G_Module_Function_Status & Set_Charger_36V_Measured_Processing)&&(G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_Chger_Vol_ch);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_36V_Chger);
-                    G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_36V_Chger, G_Temp_ADC_L0);
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status &= ~Set_Charger_36V_Measured_Processing;
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_Chger_36Voltage,(t_uint8 *)(&G_Temp_ADC_L0), 4);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing without setting devices For Charger_48V_Measured_Processing
-            }else if((G_Module_Function_Status & Set_Charger_48V_Measured_Processing)&&(G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_Chger_Vol_ch);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_48V_Chger);
-                    G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_48V_Chger, G_Temp_ADC_L0);
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_Module_Function_Status &= ~Set_Charger_48V_Measured_Processing;
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_Chger_48Voltage,(t_uint8 *)(&G_Temp_ADC_L0), 4);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing without setting devices For Charging Current_Measured_Processing
-            }else if((G_1st_Module_Function_Status & Set_Chg_Current_Measured_Processing)&&(G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_CHG_ch);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Charging_Current);
-                    G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Charging_Current, G_Temp_ADC_L0);
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_1st_Module_Function_Status &= ~Set_Chg_Current_Measured_Processing;
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_CHG_Current,(t_uint8 *)(&G_Temp_ADC_L0), 4);
-                }
-            /////////////////////////////////////////////////////////////////////
-            // start Measured Processing without setting devices For Discharging Current_Measured_Processing
-            }else if((G_1st_Module_Function_Status & Set_Dsg_Current_Measured_Processing)&&(G_Module_Function_Status & DirMeasuredProcessingViaADC_Ch)){
-                if(!(G_Module_Function_Status & Process_Set_Channel)){
-                    //exec once
-                    G_Module_Function_Status |= Process_Set_Channel;
-                    Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-                    _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_DSG_ch);
-                }
-                if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-                    _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-                }else if(G_Module_Function_Status & ADC_Done_Conversion){
-                    //calculate and save results
-                    G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Discharging_Current);
-                    G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Discharging_Current, G_Temp_ADC_L0);
-                    //clear ADC Flags
-                    G_Module_Function_Status &= ~ADC_Done_Conversion;
-                    G_Module_Function_Status &= ~ADC_Start_Conversion;
-                    //Process_Vol_Measured_Done
-                    G_Module_Function_Status &= ~Process_Set_Channel;
-                    G_Module_Function_Status &= ~DirMeasuredProcessingViaADC_Ch;
-                    G_1st_Module_Function_Status &= ~Set_Dsg_Current_Measured_Processing;
-                    //send data out via usb
-                    _DUI_CDC_Transmitting_Data_With_USB_Protocol_Packet(Cmd_Get_Direct_DSG_Current,(t_uint8 *)(&G_Temp_ADC_L0), 4);
-                }
-
-
-
             }else{
+                /////////////////////////////////////////////////////////////////////
+                // queued measurement jobs, one step on each loop
+                _DUI_Measurement_Job_Process();
+                /////////////////////////////////////////////////////////////////////
+                // test sequence, ops until the next wait or measurement
+                _DUI_Test_Sequence_Process();
+                /////////////////////////////////////////////////////////////////////
+                // UART transaction, reply or timeout
+                _DUI_Comm_Transaction_Process();
 
-
-                //reset flag
 #if !defined(_Debug_Disable_USB_Function_)
-            __bis_SR_register(LPM0_bits);
-            _DUI_USB_Main_Polling_Function_For_Parsing_Receiving_Packet();
+                //next frame is already received, no sleeping
+                //LPM0 and GIE are set at once, so USB event between checking and sleeping wakes up CPU
+                //ADC done and settle time up also wake up CPU for the next step of the job, UART frame end for sending it out
+                __disable_interrupt();
+                if((_DUI_USB_CDC_Is_Receiving_Data_Pending() == 0) && (_DUI_ADC_Stream_Is_Block_Ready() == 0) && (_DUI_ADC_Watch_Is_Event_Ready() == 0) && (_DUI_Measurement_Job_Is_Ready() == 0) && (_DUI_Test_Sequence_Is_Ready() == 0) &&
+                   (_DUI_Is_Comm_Module_Receiving_Data_Pending() == 0) && (_DUI_Comm_Transaction_Is_Ready() == 0)){
+                    __bis_SR_register(LPM0_bits + GIE);
+                }else{
+                    __enable_interrupt();
+                }
+                _DUI_USB_Main_Polling_Function_For_Parsing_Receiving_Packet();
 #endif
-                //G_Module_Function_Status &= ~(Charger_ID_Level_1_Check + Charger_ID_Level_2_Check + Charger_ID_Level_3_Check);
-                //G_Module_Function_Status &= ~(Charger_24V_Check + Charger_36V_Check + Charger_48V_Check);
-                //G_Module_Function_Status &= ~Charger_Check_Actived;
             }
 
 
-
-
 #if 0
     //float t_float;
     if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
@@ -663,7 +396,7 @@ void main (void)
 
 
 }                               //main()
-void Clear_Temp_Array_Buffer(unsigned int* ptr_StartArray, unsigned char num){
+void Clear_Temp_Array_Buffer(t_uint16* ptr_StartArray, unsigned char num){
     unsigned char index;
 
     for(index = 0; index < num; index++){
@@ -671,95 +404,6 @@ void Clear_Temp_Array_Buffer(unsigned int* ptr_StartArray, unsigned char num){
     }
 }
 
-void Processing_Charger_Check(MeasuredFunctions Measured_Voltage_Chger, Switch_Channnel Switch_To_Voltage_Ch){
-
-    if(!(G_Module_Function_Status & Process_Set_Channel)){
-        //exec once
-        G_Module_Function_Status |= Process_Set_Channel;
-        Clear_Temp_Array_Buffer(&G_Temp_ADC_L0, 8);
-        _DUI_Set_ADC_Conversion_Channel_for_RepeatedSingleCh(ADC_Chger_Vol_ch);
-        _DUI_SwitchChargerInputAndIDStep(Switch_To_Voltage_Ch, Chger_ID_OFF);
-    }
-    //process charger ID Off
-    if((G_Module_Function_Status & (Charger_ID_Level_1_Check + Charger_ID_Level_2_Check)) == 0){
-        if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-            _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-        }else if(G_Module_Function_Status & ADC_Done_Conversion){
-            //switch to next step, Level 1
-            _DUI_SwitchChargerInputAndIDStep(Switch_To_Voltage_Ch, Chger_ID_1st_Step);
-            DelayCycles(G_Temp_1_DelayCycles);
-            G_Module_Function_Status |= Charger_ID_Level_1_Check;
-            //calculate and save results
-            G_Temp_ADC_L0 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Voltage_Chger);
-            G_Temp_RealValue_From_ADC_L0 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Voltage_Chger, G_Temp_ADC_L0);
-//            G_Temp_ADC_L0 = 0x1000 + Measured_Voltage_Chger;
-//            G_Temp_RealValue_From_ADC_L0 = 0x1100 + Measured_Voltage_Chger;
-            //clear ADC Flags
-            G_Module_Function_Status &= ~ADC_Done_Conversion;
-            G_Module_Function_Status &= ~ADC_Start_Conversion;
-        }
-    }
-    //process charger ID Level 1
-    if(G_Module_Function_Status & Charger_ID_Level_1_Check){
-        if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-            _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-        }else if(G_Module_Function_Status & ADC_Done_Conversion){
-            //switch to next step, Level 2
-            _DUI_SwitchChargerInputAndIDStep(Switch_To_Voltage_Ch, Chger_ID_2nd_Step);
-            DelayCycles(G_Temp_1_DelayCycles);
-            G_Module_Function_Status &= ~(Charger_ID_Level_1_Check + Charger_ID_Level_2_Check);
-            G_Module_Function_Status |= Charger_ID_Level_2_Check;
-            //calculate and save results
-            G_Temp_ADC_L1 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Voltage_Chger);
-            G_Temp_RealValue_From_ADC_L1 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Voltage_Chger, G_Temp_ADC_L1);
-//            G_Temp_ADC_L1 = 0x2000 + Measured_Voltage_Chger;
-//            G_Temp_RealValue_From_ADC_L1 = 0x2200 + Measured_Voltage_Chger;
-            //clear ADC Flags
-            G_Module_Function_Status &= ~ADC_Done_Conversion;
-            G_Module_Function_Status &= ~ADC_Start_Conversion;
-        }
-    }
-//    //process charger ID Level 2
-//    if(G_Module_Function_Status & Charger_ID_Level_2_Check){
-//        if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-//            _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-//        }else if(G_Module_Function_Status & ADC_Done_Conversion){
-//            //switch to next step, Level 3
-//            _DUI_SwitchChargerInputAndIDStep(Switch_To_Voltage_Ch, Chger_ID_3rd_Step);
-//            G_Module_Function_Status &= ~(Charger_ID_Level_1_Check + Charger_ID_Level_2_Check + Charger_ID_Level_3_Check);
-//            G_Module_Function_Status |= Charger_ID_Level_3_Check;
-//            //calculate and save results
-//            G_Temp_ADC_L2 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Voltage_Chger);
-//            G_Temp_RealValue_From_ADC_L2 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Voltage_Chger, G_Temp_ADC_L2);
-////            G_Temp_ADC_L2 = 0x3000 + Measured_Voltage_Chger;
-////            G_Temp_RealValue_From_ADC_L2 = 0x3300 + Measured_Voltage_Chger;
-//            //clear ADC Flags
-//            G_Module_Function_Status &= ~ADC_Done_Conversion;
-//            G_Module_Function_Status &= ~ADC_Start_Conversion;
-//        }
-//    }
-    //process charger ID Level 2
-    if(G_Module_Function_Status & Charger_ID_Level_2_Check){
-        if(((G_Module_Function_Status & ADC_Start_Conversion)==0) && ((G_Module_Function_Status & ADC_Done_Conversion)==0)){
-            _DUI_Start_ADC_Conversion_for_RepeatedSingleCh();
-        }else if(G_Module_Function_Status & ADC_Done_Conversion){
-            //Final step, set id off, clear flag
-            _DUI_SwitchChargerInputAndIDStep(Switch_To_Empty_Ch, Chger_ID_OFF);
-            G_Module_Function_Status &= ~(Charger_ID_Level_1_Check + Charger_ID_Level_2_Check);
-            G_Module_Function_Status &= ~Process_Set_Channel;
-            G_Module_Function_Status |= Process_Charger_Measured_Done;
-            //calculate and save results
-            G_Temp_ADC_L2 = _DUI_Get_Calibrated_ADC_SingleChannle_Result(Measured_Voltage_Chger);
-            G_Temp_RealValue_From_ADC_L2 = _DUI_Get_RealMeasuredDate_By_ADC(Measured_Voltage_Chger, G_Temp_ADC_L2);
-//            G_Temp_ADC_L3 = 0x4000 + Measured_Voltage_Chger;
-//            G_Temp_RealValue_From_ADC_L3 = 0x4400 + Measured_Voltage_Chger;
-            //clear ADC Flags
-            G_Module_Function_Status &= ~ADC_Done_Conversion;
-            G_Module_Function_Status &= ~ADC_Start_Conversion;
-        }
-    }
-
-}//void Processing_Charger_Check(MeasuredFunctions Measured_Voltage_Chger, Switch_Channnel Switch_To_Voltage_Ch){
 
 
 
@@ -806,6 +450,7 @@ void Processing_Charger_Check(MeasuredFunctions Measured_Voltage_Chger, Switch_C
 /*
  * ======== UNMI_ISR ========
  */
+#if !defined(_Config_HOST_SIMULATION_)
 #pragma vector = UNMI_VECTOR
 __interrupt VOID UNMI_ISR (VOID)
 {
@@ -829,4 +474,5 @@ __interrupt VOID UNMI_ISR (VOID)
             USB_disable();                                      //Disable
     }
 }
+#endif
 